@@ -0,0 +1,238 @@
+#include "frequency_sketch.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+FrequencySketch::FrequencySketch(size_t top_k, size_t width, size_t depth)
+    : top_k_(top_k == 0 ? 1 : top_k), used_(0), index_mask_(0), width_mask_(0),
+      depth_(depth == 0 ? 1 : (depth > MAX_DEPTH ? MAX_DEPTH : depth)), total_(0), skipped_(0) {
+    counters_.resize(top_k_);
+    terms_.resize(top_k_ * MAX_TERM_LENGTH);
+    heap_.resize(top_k_);
+    for (size_t i = 0; i < top_k_; ++i) {
+        counters_[i].count = 0;
+        counters_[i].error = 0;
+        counters_[i].heap_pos = static_cast<uint32_t>(i);
+        counters_[i].length = 0;
+        counters_[i].hash = 0;
+        heap_[i] = static_cast<uint32_t>(i);
+    }
+    
+    // Коэффициент заполнения индекса не выше 1/2
+    size_t index_size = 1;
+    while (index_size < top_k_ * 2) {
+        index_size *= 2;
+    }
+    index_.resize(index_size);
+    for (size_t i = 0; i < index_size; ++i) {
+        index_[i] = 0;
+    }
+    index_mask_ = index_size - 1;
+    
+    size_t sketch_width = 1;
+    while (sketch_width < width) {
+        sketch_width *= 2;
+    }
+    width_mask_ = sketch_width - 1;
+    sketch_.resize(depth_ * sketch_width);
+    for (size_t i = 0; i < sketch_.size(); ++i) {
+        sketch_[i] = 0;
+    }
+}
+
+uint64_t FrequencySketch::hash_term(std::string_view term) {
+    // FNV-1a (64 бита) с финальным перемешиванием
+    uint64_t h = 14695981039346656037ull;
+    for (size_t i = 0; i < term.length(); ++i) {
+        h ^= static_cast<unsigned char>(term[i]);
+        h *= 1099511628211ull;
+    }
+    h ^= h >> 33;
+    h *= 0xff51afd7ed558ccdull;
+    h ^= h >> 33;
+    return h;
+}
+
+uint64_t FrequencySketch::sketch_update(uint64_t hash) {
+    // Строки Count-Min: h1 + i * h2 (двойное хеширование)
+    uint64_t h1 = hash;
+    uint64_t h2 = (hash >> 32) | 1;
+    size_t width = width_mask_ + 1;
+    
+    uint64_t* cells[MAX_DEPTH];
+    size_t rows = depth_;
+    uint64_t minimum = UINT64_MAX;
+    for (size_t i = 0; i < rows; ++i) {
+        cells[i] = &sketch_[i * width + ((h1 + i * h2) & width_mask_)];
+        minimum = std::min(minimum, *cells[i]);
+    }
+    
+    // Консервативное обновление: увеличиваются только минимальные счетчики
+    uint64_t estimate = minimum + 1;
+    for (size_t i = 0; i < rows; ++i) {
+        if (*cells[i] < estimate) {
+            *cells[i] = estimate;
+        }
+    }
+    return estimate;
+}
+
+uint32_t FrequencySketch::index_find(uint64_t hash, std::string_view term) const {
+    size_t pos = hash & index_mask_;
+    while (index_[pos] != 0) {
+        uint32_t slot = index_[pos] - 1;
+        const Counter& counter = counters_[slot];
+        if (counter.hash == hash && counter.length == term.length() &&
+            std::memcmp(term_data(slot), term.data(), term.length()) == 0) {
+            return slot;
+        }
+        pos = (pos + 1) & index_mask_;
+    }
+    return UINT32_MAX;
+}
+
+void FrequencySketch::index_insert(uint64_t hash, uint32_t slot) {
+    size_t pos = hash & index_mask_;
+    while (index_[pos] != 0) {
+        pos = (pos + 1) & index_mask_;
+    }
+    index_[pos] = slot + 1;
+}
+
+void FrequencySketch::index_erase(uint64_t hash, uint32_t slot) {
+    size_t pos = hash & index_mask_;
+    while (index_[pos] != slot + 1) {
+        pos = (pos + 1) & index_mask_;
+    }
+    
+    // Удаление со сдвигом назад (без надгробий)
+    size_t next = (pos + 1) & index_mask_;
+    while (index_[next] != 0) {
+        size_t home = counters_[index_[next] - 1].hash & index_mask_;
+        // Элемент можно перенести в pos, если pos лежит на пути от home до next
+        if (((next - home) & index_mask_) >= ((next - pos) & index_mask_)) {
+            index_[pos] = index_[next];
+            pos = next;
+        }
+        next = (next + 1) & index_mask_;
+    }
+    index_[pos] = 0;
+}
+
+void FrequencySketch::heap_swap(uint32_t a, uint32_t b) {
+    std::swap(heap_[a], heap_[b]);
+    counters_[heap_[a]].heap_pos = a;
+    counters_[heap_[b]].heap_pos = b;
+}
+
+void FrequencySketch::sift_down(uint32_t pos) {
+    size_t n = heap_.size();
+    while (true) {
+        size_t smallest = pos;
+        size_t left = 2 * static_cast<size_t>(pos) + 1;
+        size_t right = left + 1;
+        if (left < n && counters_[heap_[left]].count < counters_[heap_[smallest]].count) {
+            smallest = left;
+        }
+        if (right < n && counters_[heap_[right]].count < counters_[heap_[smallest]].count) {
+            smallest = right;
+        }
+        if (smallest == pos) {
+            return;
+        }
+        heap_swap(pos, static_cast<uint32_t>(smallest));
+        pos = static_cast<uint32_t>(smallest);
+    }
+}
+
+void FrequencySketch::add(std::string_view term) {
+    ++total_;
+    uint64_t hash = hash_term(term);
+    sketch_update(hash);
+    
+    if (term.length() > MAX_TERM_LENGTH || term.empty()) {
+        ++skipped_;
+        return;
+    }
+    
+    uint32_t slot = index_find(hash, term);
+    if (slot != UINT32_MAX) {
+        // Счетчик увеличился - в min-куче он может только опуститься
+        ++counters_[slot].count;
+        sift_down(counters_[slot].heap_pos);
+        return;
+    }
+    
+    // Новый терм: свободный счетчик или вытеснение минимального.
+    // Свободные счетчики (count 0) всегда в корне кучи.
+    slot = heap_[0];
+    Counter& counter = counters_[slot];
+    if (counter.length != 0) {
+        index_erase(counter.hash, slot);
+    } else {
+        ++used_;
+    }
+    
+    counter.error = counter.count;
+    counter.count += 1;
+    counter.hash = hash;
+    counter.length = static_cast<uint32_t>(term.length());
+    std::memcpy(&terms_[slot * MAX_TERM_LENGTH], term.data(), term.length());
+    index_insert(hash, slot);
+    sift_down(0);
+}
+
+Vector<FrequencySketch::Estimate> FrequencySketch::top() const {
+    Vector<Estimate> result;
+    result.reserve(used_);
+    
+    size_t width = width_mask_ + 1;
+    for (uint32_t slot = 0; slot < counters_.size(); ++slot) {
+        const Counter& counter = counters_[slot];
+        if (counter.length == 0) {
+            continue;
+        }
+        
+        // Верхняя оценка Count-Min (без обновления)
+        uint64_t h1 = counter.hash;
+        uint64_t h2 = (counter.hash >> 32) | 1;
+        uint64_t sketch_estimate = UINT64_MAX;
+        for (size_t i = 0; i < depth_; ++i) {
+            sketch_estimate = std::min(sketch_estimate, sketch_[i * width + ((h1 + i * h2) & width_mask_)]);
+        }
+        
+        Estimate estimate;
+        estimate.term = term_of(slot);
+        estimate.upper = std::min(counter.count, sketch_estimate);
+        estimate.lower = counter.count - counter.error;
+        result.push_back(estimate);
+    }
+    
+    std::sort(result.begin(), result.end(), [](const Estimate& a, const Estimate& b) {
+        if (a.upper != b.upper) {
+            return a.upper > b.upper;
+        }
+        if (a.lower != b.lower) {
+            return a.lower > b.lower;
+        }
+        return a.term < b.term;
+    });
+    
+    return result;
+}
+
+double FrequencySketch::error_bound() const {
+    return std::exp(1.0) / static_cast<double>(width_mask_ + 1) * static_cast<double>(total_);
+}
+
+double FrequencySketch::failure_probability() const {
+    return std::exp(-static_cast<double>(depth_));
+}
+
+size_t FrequencySketch::memory_bytes() const {
+    return counters_.capacity() * sizeof(Counter) +
+           terms_.capacity() +
+           heap_.capacity() * sizeof(uint32_t) +
+           index_.capacity() * sizeof(uint32_t) +
+           sketch_.capacity() * sizeof(uint64_t);
+}
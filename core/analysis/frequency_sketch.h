@@ -0,0 +1,115 @@
+#ifndef FREQUENCY_SKETCH_H
+#define FREQUENCY_SKETCH_H
+
+#include <cstdint>
+#include <string_view>
+#include "../utils/vector.h"
+
+/**
+ * Приближенный подсчет частот в фиксированном объеме памяти
+ *
+ * Space-Saving (k счетчиков) хранит кандидатов в самые частые термы,
+ * Count-Min (depth x width счетчиков, консервативное обновление)
+ * дает независимую верхнюю оценку для каждого из них.
+ *
+ * Гарантии для терма из top() при N обработанных токенах:
+ *   lower <= истинная частота <= upper
+ *   upper <= истинная частота + e/width * N с вероятностью 1 - e^-depth
+ *   любой терм с частотой > N/k присутствует в top()
+ *
+ * Память не зависит от размера словаря: термы длиннее MAX_TERM_LENGTH
+ * учитываются в N и Count-Min, но не попадают в top().
+ */
+class FrequencySketch {
+public:
+    static const size_t MAX_TERM_LENGTH = 64;
+    static const size_t MAX_DEPTH = 16;
+
+    struct Estimate {
+        std::string_view term;  // валидна, пока существует FrequencySketch
+        uint64_t lower;
+        uint64_t upper;
+    };
+
+    /**
+     * @param top_k число отслеживаемых термов (Space-Saving)
+     * @param width ширина Count-Min (округляется вверх до степени двойки)
+     * @param depth число строк Count-Min (не больше MAX_DEPTH)
+     */
+    FrequencySketch(size_t top_k, size_t width, size_t depth);
+
+    FrequencySketch(const FrequencySketch&) = delete;
+    FrequencySketch& operator=(const FrequencySketch&) = delete;
+
+    void add(std::string_view term);
+
+    /**
+     * Отслеживаемые термы по убыванию верхней оценки
+     */
+    Vector<Estimate> top() const;
+
+    /**
+     * Количество обработанных токенов
+     */
+    uint64_t total() const { return total_; }
+
+    /**
+     * Термы, не попавшие в Space-Saving из-за длины
+     */
+    uint64_t skipped() const { return skipped_; }
+
+    /**
+     * Аддитивная погрешность Count-Min (e/width * N) и вероятность ее превышения
+     */
+    double error_bound() const;
+    double failure_probability() const;
+
+    /**
+     * Объем памяти (фиксирован при создании), в байтах
+     */
+    size_t memory_bytes() const;
+
+private:
+    struct Counter {
+        uint64_t count;
+        uint64_t error;     // переоценка, унаследованная при вытеснении
+        uint32_t heap_pos;  // позиция в куче
+        uint32_t length;    // 0 - счетчик свободен
+        uint64_t hash;
+    };
+
+    static uint64_t hash_term(std::string_view term);
+
+    uint64_t sketch_update(uint64_t hash);
+
+    const char* term_data(uint32_t slot) const { return &terms_[slot * MAX_TERM_LENGTH]; }
+    std::string_view term_of(uint32_t slot) const {
+        return std::string_view(term_data(slot), counters_[slot].length);
+    }
+
+    // Индекс терм -> счетчик (линейное пробирование)
+    uint32_t index_find(uint64_t hash, std::string_view term) const;
+    void index_insert(uint64_t hash, uint32_t slot);
+    void index_erase(uint64_t hash, uint32_t slot);
+
+    // Min-куча счетчиков по count
+    void sift_down(uint32_t pos);
+    void heap_swap(uint32_t a, uint32_t b);
+
+    size_t top_k_;
+    size_t used_;
+    Vector<Counter> counters_;
+    Vector<char> terms_;       // top_k * MAX_TERM_LENGTH
+    Vector<uint32_t> heap_;    // номера счетчиков
+    Vector<uint32_t> index_;   // (номер счетчика + 1) или 0
+    size_t index_mask_;
+
+    size_t width_mask_;
+    size_t depth_;
+    Vector<uint64_t> sketch_;  // depth * width
+
+    uint64_t total_;
+    uint64_t skipped_;
+};
+
+#endif // FREQUENCY_SKETCH_H
@@ -1,99 +1,378 @@
 #include "zipf_analyzer.h"
+#include "frequency_sketch.h"
+#include "../index/boolean_index.h"
 #include "../tokenizer/tokenizer.h"
 #include "../stemmer/stemmer.h"
+#include "../stemmer/stem_cache.h"
 #include "../utils/file_utils.h"
+#include "../utils/corpus_pack.h"
 #include "../utils/sort.h"
 #include <algorithm> // для std::sort
+#include <atomic>
 #include <fstream>
 #include <iostream>
+#include <memory>
+#include <thread>
 
-struct WordFreqPair {
-    std::string word;
-    int frequency;
+namespace {
+
+// Подсчет частоты токена (со стеммингом)
+struct CountToken {
+    TermDictionary& dictionary;
+    Vector<int>& counts;
+    StemCache& stem_cache;
+    
+    void operator()(std::string_view token) const {
+        std::string_view stemmed = token.substr(0, stem_cache.stem_length(token));
+        if (!stemmed.empty()) {
+            uint32_t term_id = dictionary.intern(stemmed);
+            while (counts.size() <= term_id) {
+                counts.push_back(0);
+            }
+            ++counts[term_id];
+        }
+    }
+};
+
+// Частоты, накопленные одним потоком
+struct PartialCounts {
+    TermDictionary dictionary;
+    Vector<int> counts;
+    
+    // Позиция первого появления терма: (номер документа << 32) | номер токена.
+    // Задает тот же порядок, что и term id при последовательном анализе.
+    Vector<uint64_t> first_seen;
+};
+
+// Подсчет с запоминанием первого появления (параллельный режим)
+struct CountTokenOrdered {
+    PartialCounts& partial;
+    StemCache& stem_cache;
+    uint64_t position;
     
-    WordFreqPair() : word(""), frequency(0) {}  // Добавляем конструктор по умолчанию
-    WordFreqPair(const std::string& w, int f) : word(w), frequency(f) {}
+    void operator()(std::string_view token) {
+        std::string_view stemmed = token.substr(0, stem_cache.stem_length(token));
+        if (!stemmed.empty()) {
+            uint32_t term_id = partial.dictionary.intern(stemmed);
+            if (term_id == partial.counts.size()) {
+                partial.counts.push_back(0);
+                partial.first_seen.push_back(position);
+            }
+            ++partial.counts[term_id];
+            ++position;
+        }
+    }
 };
 
-static bool compare_by_frequency_desc(const WordFreqPair& a, const WordFreqPair& b) {
-    return a.frequency > b.frequency;
+// Слияние частот source в target
+void merge_partial(PartialCounts& target, const PartialCounts& source) {
+    for (uint32_t id = 0; id < source.dictionary.size(); ++id) {
+        uint32_t target_id = target.dictionary.intern(source.dictionary.term(id));
+        if (target_id == target.counts.size()) {
+            target.counts.push_back(source.counts[id]);
+            target.first_seen.push_back(source.first_seen[id]);
+        } else {
+            target.counts[target_id] += source.counts[id];
+            target.first_seen[target_id] = std::min(target.first_seen[target_id], source.first_seen[id]);
+        }
+    }
 }
 
-std::vector<ZipfAnalyzer::WordFrequency> ZipfAnalyzer::analyze_corpus(const std::string& corpus_dir) {
-    Map<std::string, int> total_frequencies;
+// Документов, забираемых потоком за раз
+const size_t DOCUMENTS_PER_TASK = 8;
+
+// Сортировка термов по убыванию частоты и преобразование в WordFrequency.
+// При равной частоте - по first_seen (если задан) или по term id.
+std::vector<ZipfAnalyzer::WordFrequency> sorted_frequencies(const TermDictionary& dictionary,
+                                                            const Vector<int>& counts,
+                                                            const Vector<uint64_t>* first_seen,
+                                                            size_t threads) {
+    Vector<uint32_t> order;
+    order.resize(counts.size());
+    for (size_t i = 0; i < order.size(); ++i) {
+        order[i] = static_cast<uint32_t>(i);
+    }
+    
+    Sort<uint32_t>::parallel_sort(order,
+        [&counts, first_seen](uint32_t a, uint32_t b) {
+            if (counts[a] != counts[b]) {
+                return counts[a] > counts[b];
+            }
+            if (first_seen != nullptr) {
+                return (*first_seen)[a] < (*first_seen)[b];
+            }
+            return a < b;
+        }, threads);
+    
+    // Преобразование в WordFrequency (строки копируются частями в потоках)
+    std::vector<ZipfAnalyzer::WordFrequency> frequencies;
+    frequencies.resize(order.size());
+    
+    auto fill = [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i) {
+            frequencies[i].word = std::string(dictionary.term(order[i]));
+            frequencies[i].frequency = counts[order[i]];
+            frequencies[i].frequency_lower = frequencies[i].frequency;
+            frequencies[i].frequency_upper = frequencies[i].frequency;
+            frequencies[i].rank = static_cast<int>(i + 1);
+            frequencies[i].zipf_value = static_cast<double>(frequencies[i].frequency) * 
+                                        static_cast<double>(frequencies[i].rank);
+        }
+    };
     
-    Vector<std::string> files = FileUtils::list_files(corpus_dir);
+    if (threads <= 1) {
+        fill(0, order.size());
+    } else {
+        Vector<std::thread> workers;
+        for (size_t t = 0; t < threads; ++t) {
+            workers.push_back(std::thread(fill, order.size() * t / threads, order.size() * (t + 1) / threads));
+        }
+        for (size_t t = 0; t < workers.size(); ++t) {
+            workers[t].join();
+        }
+    }
     
-    std::cout << "Анализ корпуса: " << files.size() << " файлов" << std::endl;
+    return frequencies;
+}
+
+// Последовательный обход документов корпуса: содержимое передается в on_content,
+// файлы больше порога упреждающего чтения - в on_file (потоковая обработка)
+template<typename ContentFn, typename FileFn>
+void for_each_document_serial(bool packed, const CorpusPack& pack, const Vector<std::string>& files,
+                              const ReadAheadReader::Options& read_ahead,
+                              ContentFn on_content, FileFn on_file) {
+    if (packed) {
+        // Упакованный корпус: документы читаются из отображенного файла
+        for (size_t i = 0; i < pack.size(); ++i) {
+            if (i % CorpusPack::PREFETCH_DOCUMENTS == 0) {
+                pack.prefetch(i + CorpusPack::PREFETCH_DOCUMENTS, CorpusPack::PREFETCH_DOCUMENTS);
+            }
+            if ((i + 1) % 100 == 0) {
+                std::cout << "Обработано файлов: " << (i + 1) << std::endl;
+            }
+            on_content(pack.document(i).content);
+        }
+        return;
+    }
     
-    // Анализ каждого документа
-    for (size_t i = 0; i < files.size(); ++i) {
-        if ((i + 1) % 100 == 0) {
-            std::cout << "Обработано файлов: " << (i + 1) << std::endl;
+    // Анализ каждого документа (чтение следующих файлов идет в фоне)
+    ReadAheadReader reader(files, read_ahead);
+    while (const ReadAheadReader::Item* item = reader.next()) {
+        if ((item->index + 1) % 100 == 0) {
+            std::cout << "Обработано файлов: " << (item->index + 1) << std::endl;
         }
         
-        Map<std::string, int> doc_freq = analyze_document(files[i]);
-        merge_frequencies(total_frequencies, doc_freq);
+        if (item->status == ReadAheadReader::READ_OK) {
+            on_content(item->data);
+        } else if (item->status == ReadAheadReader::READ_TOO_LARGE) {
+            on_file(*item->path);
+        }
+    }
+}
+
+}
+
+std::vector<ZipfAnalyzer::WordFrequency> ZipfAnalyzer::analyze_corpus(const std::string& corpus_dir,
+                                                                     const Options& options) {
+    size_t threads = options.threads;
+    if (threads == 0) {
+        threads = std::max(1u, std::thread::hardware_concurrency());
     }
     
-    // Преобразование в вектор
-    std::vector<WordFreqPair> pairs;
-    Vector<std::string> keys;
-    total_frequencies.get_keys(keys);
+    // Источник документов: пакет или директория
+    CorpusPack pack;
+    Vector<std::string> files;
+    bool packed = CorpusPack::is_pack(corpus_dir);
+    if (packed) {
+        if (!pack.open(corpus_dir)) {
+            std::cerr << "Ошибка открытия пакета корпуса: " << corpus_dir << std::endl;
+            return std::vector<WordFrequency>();
+        }
+        std::cout << "Анализ корпуса: " << pack.size() << " документов (пакет)" << std::endl;
+    } else {
+        files = FileUtils::list_files(corpus_dir);
+        std::cout << "Анализ корпуса: " << files.size() << " файлов" << std::endl;
+    }
     
-    for (size_t i = 0; i < keys.size(); ++i) {
-        int freq = 0;
-        total_frequencies.find(keys[i], freq);
-        pairs.push_back(WordFreqPair(keys[i], freq));
+    if (options.approximate) {
+        return analyze_approximate(packed, pack, files, options);
     }
     
-    // Сортировка по убыванию частоты
-    std::sort(pairs.begin(), pairs.end(), 
-              [](const WordFreqPair& a, const WordFreqPair& b) { 
-                  return a.frequency > b.frequency; 
-              });
+    if (threads <= 1) {
+        TermDictionary dictionary;
+        Vector<int> total_frequencies;
+        
+        for_each_document_serial(packed, pack, files, options.read_ahead,
+            [&](std::string_view content) {
+                analyze_content(content, dictionary, total_frequencies);
+            },
+            [&](const std::string& path) {
+                analyze_document(path, dictionary, total_frequencies);
+            });
+        
+        // Term id совпадает с порядком первого появления
+        return sorted_frequencies(dictionary, total_frequencies, nullptr, 1);
+    }
     
-    // Преобразование в WordFrequency
-    std::vector<WordFrequency> frequencies;
-    frequencies.resize(pairs.size());
+    // Map: потоки забирают документы блоками по возрастанию номера,
+    // поэтому первое появление терма в потоке - минимальное для этого потока
+    size_t document_count = packed ? pack.size() : files.size();
+    std::vector<std::unique_ptr<PartialCounts>> partials;
+    for (size_t t = 0; t < threads; ++t) {
+        partials.push_back(std::unique_ptr<PartialCounts>(new PartialCounts()));
+    }
     
-    for (size_t i = 0; i < pairs.size(); ++i) {
-        frequencies[i].word = pairs[i].word;
-        frequencies[i].frequency = pairs[i].frequency;
-        frequencies[i].rank = static_cast<int>(i + 1);
-        frequencies[i].zipf_value = static_cast<double>(frequencies[i].frequency) * 
-                                    static_cast<double>(frequencies[i].rank);
+    std::atomic<size_t> next_document(0);
+    std::atomic<size_t> processed(0);
+    
+    auto map_worker = [&](size_t t) {
+        PartialCounts& partial = *partials[t];
+        StemCache& stem_cache = StemCache::local();
+        
+        while (true) {
+            size_t first = next_document.fetch_add(DOCUMENTS_PER_TASK);
+            if (first >= document_count) {
+                break;
+            }
+            size_t last = std::min(first + DOCUMENTS_PER_TASK, document_count);
+            if (packed) {
+                pack.prefetch(first, last - first);
+            }
+            
+            for (size_t i = first; i < last; ++i) {
+                CountTokenOrdered counter{partial, stem_cache, static_cast<uint64_t>(i) << 32};
+                if (packed) {
+                    std::string_view content = pack.document(i).content;
+                    Tokenizer::for_each_token(content.data(), content.length(), counter);
+                } else {
+                    Tokenizer::tokenize_file(files[i], counter);
+                }
+            }
+            
+            size_t done = processed.fetch_add(last - first) + (last - first);
+            if (done / 100 != (done - (last - first)) / 100) {
+                std::cout << "Обработано файлов: " << (done / 100 * 100) << std::endl;
+            }
+        }
+    };
+    
+    Vector<std::thread> workers;
+    for (size_t t = 0; t < threads; ++t) {
+        workers.push_back(std::thread(map_worker, t));
+    }
+    for (size_t t = 0; t < workers.size(); ++t) {
+        workers[t].join();
     }
     
-    return frequencies;
+    // Reduce: попарное слияние деревом, пары сливаются параллельно
+    for (size_t step = 1; step < threads; step *= 2) {
+        Vector<std::thread> round;
+        for (size_t t = 0; t + step < threads; t += 2 * step) {
+            round.push_back(std::thread([&partials, t, step] {
+                merge_partial(*partials[t], *partials[t + step]);
+                partials[t + step].reset();
+            }));
+        }
+        for (size_t t = 0; t < round.size(); ++t) {
+            round[t].join();
+        }
+    }
+    
+    const PartialCounts& total = *partials[0];
+    return sorted_frequencies(total.dictionary, total.counts, &total.first_seen, threads);
 }
 
-Map<std::string, int> ZipfAnalyzer::analyze_document(const std::string& filepath) {
-    Map<std::string, int> frequencies;
+std::vector<ZipfAnalyzer::WordFrequency> ZipfAnalyzer::analyze_index(const std::string& index_path,
+                                                                    size_t threads) {
+    if (threads == 0) {
+        threads = std::max(1u, std::thread::hardware_concurrency());
+    }
+    
+    BooleanIndex index;
+    index.load(index_path);
     
-    std::string content = FileUtils::read_file(filepath);
-    if (content.empty()) {
-        return frequencies;
+    if (!index.has_collection_frequencies()) {
+        std::cerr << "В индексе нет частот в коллекции (перестройте его build_index): "
+                  << index_path << std::endl;
+        return std::vector<WordFrequency>();
     }
     
-    // Токенизация
-    std::vector<std::string> tokens = Tokenizer::tokenize(content);
+    std::cout << "Анализ по индексу: " << index.get_dictionary().size() << " термов" << std::endl;
     
-    // Подсчет частот (со стеммингом)
-    for (size_t i = 0; i < tokens.size(); ++i) {
-        std::string stemmed = Stemmer::stem(tokens[i]);
+    // Term id индекса - порядок первого появления при построении;
+    // термы полей заголовка (title:, url:) - повтор слов текста, не учитываются,
+    // ранги и значения Ципфа пересчитываются без них (как при проходе по корпусу)
+    std::vector<WordFrequency> frequencies =
+        sorted_frequencies(index.get_dictionary(), index.get_collection_frequencies(), nullptr, threads);
+    frequencies.erase(std::remove_if(frequencies.begin(), frequencies.end(),
+                                     [](const WordFrequency& word) { return BooleanIndex::is_field_term(word.word); }),
+                      frequencies.end());
+    assign_ranks(frequencies);
+    calculate_zipf_values(frequencies);
+    return frequencies;
+}
+
+std::vector<ZipfAnalyzer::WordFrequency> ZipfAnalyzer::analyze_approximate(bool packed,
+                                                                          const CorpusPack& pack,
+                                                                          const Vector<std::string>& files,
+                                                                          const Options& options) {
+    FrequencySketch sketch(options.top_k, options.sketch_width, options.sketch_depth);
+    StemCache& stem_cache = StemCache::local();
+    
+    auto add_token = [&sketch, &stem_cache](std::string_view token) {
+        std::string_view stemmed = token.substr(0, stem_cache.stem_length(token));
         if (!stemmed.empty()) {
-            int count = 0;
-            frequencies.find(stemmed, count);
-            frequencies.insert(stemmed, count + 1);
+            sketch.add(stemmed);
         }
+    };
+    
+    for_each_document_serial(packed, pack, files, options.read_ahead,
+        [&](std::string_view content) {
+            Tokenizer::for_each_token(content.data(), content.length(), add_token);
+        },
+        [&](const std::string& path) {
+            Tokenizer::tokenize_file(path, add_token);
+        });
+    
+    std::cout << "Приближенный подсчет: токенов " << sketch.total()
+              << ", память " << sketch.memory_bytes() << " байт"
+              << ", погрешность Count-Min <= " << sketch.error_bound()
+              << " с вероятностью " << (1.0 - sketch.failure_probability()) << std::endl;
+    
+    Vector<FrequencySketch::Estimate> top = sketch.top();
+    
+    std::vector<WordFrequency> frequencies;
+    frequencies.resize(top.size());
+    for (size_t i = 0; i < top.size(); ++i) {
+        frequencies[i].word = std::string(top[i].term);
+        frequencies[i].frequency = static_cast<int>(top[i].upper);
+        frequencies[i].frequency_lower = static_cast<int>(top[i].lower);
+        frequencies[i].frequency_upper = static_cast<int>(top[i].upper);
+        frequencies[i].rank = static_cast<int>(i + 1);
+        frequencies[i].zipf_value = static_cast<double>(frequencies[i].frequency) * 
+                                    static_cast<double>(frequencies[i].rank);
     }
     
     return frequencies;
 }
 
+void ZipfAnalyzer::analyze_document(const std::string& filepath,
+                                    TermDictionary& dictionary,
+                                    Vector<int>& counts) {
+    // Токенизация (потоковая для больших файлов) и подсчет частот
+    Tokenizer::tokenize_file(filepath, CountToken{dictionary, counts, StemCache::local()});
+}
+
+void ZipfAnalyzer::analyze_content(std::string_view content,
+                                   TermDictionary& dictionary,
+                                   Vector<int>& counts) {
+    Tokenizer::for_each_token(content.data(), content.length(),
+                              CountToken{dictionary, counts, StemCache::local()});
+}
+
 void ZipfAnalyzer::save_to_csv(const std::vector<WordFrequency>& frequencies, 
-                               const std::string& output_path) {
+                               const std::string& output_path,
+                               bool error_bounds) {
     std::ofstream out(output_path);
     if (!out.is_open()) {
         std::cerr << "Ошибка открытия файла: " << output_path << std::endl;
@@ -101,13 +380,21 @@ void ZipfAnalyzer::save_to_csv(const std::vector<WordFrequency>& frequencies,
     }
     
     // Заголовок
-    out << "rank,frequency,word,zipf_value\n";
+    out << "rank,frequency,word,zipf_value";
+    if (error_bounds) {
+        out << ",frequency_lower,frequency_upper";
+    }
+    out << "\n";
     
     // Данные
     for (size_t i = 0; i < frequencies.size(); ++i) {
         const WordFrequency& wf = frequencies[i];
         out << wf.rank << "," << wf.frequency << ",\"" << wf.word << "\"," 
-            << wf.zipf_value << "\n";
+            << wf.zipf_value;
+        if (error_bounds) {
+            out << "," << wf.frequency_lower << "," << wf.frequency_upper;
+        }
+        out << "\n";
     }
     
     out.close();
@@ -125,17 +412,3 @@ void ZipfAnalyzer::calculate_zipf_values(std::vector<WordFrequency>& frequencies
                                    static_cast<double>(frequencies[i].rank);
     }
 }
-
-void ZipfAnalyzer::merge_frequencies(Map<std::string, int>& total, 
-                                     const Map<std::string, int>& doc_freq) {
-    Vector<std::string> keys;
-    doc_freq.get_keys(keys);
-    
-    for (size_t i = 0; i < keys.size(); ++i) {
-        int freq = 0;
-        doc_freq.find(keys[i], freq);
-        int total_freq = 0;
-        total.find(keys[i], total_freq);
-        total.insert(keys[i], total_freq + freq);
-    }
-}
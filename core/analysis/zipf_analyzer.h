@@ -3,10 +3,11 @@
 
 #include <string>
 #include "../utils/vector.h"
-#include "../utils/map.h"
+#include <vector>
+#include "../utils/term_dictionary.h"
+#include "../utils/read_ahead.h"
 
-// TODO: Использовать собственную структуру данных вместо std::map
-// Для соответствия требованиям "без STL"
+class CorpusPack;
 
 /**
  * Лабораторная работа 5: Закон Ципфа
@@ -22,32 +23,87 @@ public:
         int frequency;
         int rank;
         double zipf_value;  // frequency * rank (должно быть примерно константой)
+        int frequency_lower;  // границы истинной частоты (в точном режиме равны frequency)
+        int frequency_upper;
+    };
+    
+    /**
+     * Параметры анализа корпуса
+     */
+    struct Options {
+        size_t threads;                       // потоков анализа (1 - последовательно)
+        ReadAheadReader::Options read_ahead;  // упреждающее чтение (последовательный режим)
+        
+        // Приближенный режим (FrequencySketch): память фиксирована,
+        // результат - top_k самых частых слов с границами частоты
+        bool approximate;
+        size_t top_k;
+        size_t sketch_width;
+        size_t sketch_depth;
+        
+        Options() : threads(1), approximate(false), top_k(10000), sketch_width(1 << 16), sketch_depth(4) {}
     };
     
     /**
      * Анализ корпуса документов
      * 
-     * @param corpus_dir директория с документами
+     * При threads > 1 документы делятся между потоками (map), у каждого
+     * потока свой словарь и таблица частот по term id; таблицы сливаются
+     * попарно деревом (reduce), итоговая сортировка тоже параллельная.
+     * Результат не зависит от числа потоков: при равной частоте слова
+     * упорядочены по первому появлению в корпусе.
+     * 
+     * При approximate анализ последовательный (threads не учитывается).
+     * 
+     * @param corpus_dir директория с документами или упакованный корпус (CorpusPack)
+     * @param options параметры анализа
      * @return вектор частот слов, отсортированный по убыванию частоты
      */
-    static std::vector<WordFrequency> analyze_corpus(const std::string& corpus_dir);
+    static std::vector<WordFrequency> analyze_corpus(const std::string& corpus_dir,
+                                                     const Options& options = Options());
+    
+    /**
+     * Анализ по готовому индексу (без повторной токенизации корпуса)
+     * 
+     * Используются частоты в коллекции, сохраненные build_index.
+     * Результат совпадает с analyze_corpus для того же корпуса.
+     * 
+     * @param index_path путь к файлу индекса
+     * @param threads потоков для сортировки
+     * @return вектор частот (пустой, если в индексе нет частот)
+     */
+    static std::vector<WordFrequency> analyze_index(const std::string& index_path, size_t threads = 1);
     
     /**
      * Анализ одного документа
      * 
+     * Частоты накапливаются в плотном массиве counts по term id из dictionary.
+     * 
      * @param filepath путь к файлу
-     * @return словарь частот слов
+     * @param dictionary словарь термов
+     * @param counts частоты термов (расширяется при появлении новых термов)
+     */
+    static void analyze_document(const std::string& filepath,
+                                 TermDictionary& dictionary,
+                                 Vector<int>& counts);
+    
+    /**
+     * Анализ содержимого документа, уже находящегося в памяти
      */
-    static Map<std::string, int> analyze_document(const std::string& filepath);
+    static void analyze_content(std::string_view content,
+                                TermDictionary& dictionary,
+                                Vector<int>& counts);
     
     /**
      * Сохранение результатов в CSV для построения графика
      * 
      * @param frequencies вектор частот
      * @param output_path путь к выходному файлу
+     * @param error_bounds добавить столбцы frequency_lower, frequency_upper
      */
     static void save_to_csv(const std::vector<WordFrequency>& frequencies, 
-                           const std::string& output_path);
+                           const std::string& output_path,
+                           bool error_bounds = false);
     
     /**
      * Вычисление ранга слова по частоте
@@ -60,8 +116,13 @@ public:
     static void calculate_zipf_values(std::vector<WordFrequency>& frequencies);
 
 private:
-    static void merge_frequencies(Map<std::string, int>& total, 
-                                  const Map<std::string, int>& doc_freq);
+    /**
+     * Приближенный анализ (последовательный, фиксированный объем памяти)
+     */
+    static std::vector<WordFrequency> analyze_approximate(bool packed,
+                                                          const CorpusPack& pack,
+                                                          const Vector<std::string>& files,
+                                                          const Options& options);
 };
 
 #endif // ZIPF_ANALYZER_H
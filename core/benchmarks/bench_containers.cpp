@@ -0,0 +1,269 @@
+#include "benchmark.h"
+#include "../utils/vector.h"
+#include "../utils/map.h"
+#include "../utils/set.h"
+#include "../utils/sort.h"
+#include "../utils/term_dictionary.h"
+#include <algorithm>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+/**
+ * Бенчмарки контейнеров: Vector, Map, Set, Sort, TermDictionary
+ * и их аналоги из стандартной библиотеки
+ */
+
+namespace {
+
+// Ключи-слова: n ключей из словаря размера n (с повторами для zipf)
+Vector<std::string> make_word_keys(const Benchmark::State& state) {
+    Vector<uint32_t> ids = Benchmark::make_keys(state.n(), state.n(), state.distribution(), state.seed());
+    Vector<std::string> words;
+    words.reserve(ids.size());
+    for (size_t i = 0; i < ids.size(); ++i) {
+        words.push_back(Benchmark::make_word(ids[i]));
+    }
+    return words;
+}
+
+bool less_int(const int& a, const int& b) {
+    return a < b;
+}
+
+// vector/push_back
+
+void vector_push_back(Benchmark::State& state) {
+    size_t n = state.n();
+    while (state.keep_running()) {
+        Vector<int> v;
+        for (size_t i = 0; i < n; ++i) {
+            v.push_back(static_cast<int>(i));
+        }
+        Benchmark::do_not_optimize(v.begin());
+    }
+    state.set_items_per_iteration(n);
+}
+
+void std_vector_push_back(Benchmark::State& state) {
+    size_t n = state.n();
+    while (state.keep_running()) {
+        std::vector<int> v;
+        for (size_t i = 0; i < n; ++i) {
+            v.push_back(static_cast<int>(i));
+        }
+        Benchmark::do_not_optimize(v.data());
+    }
+    state.set_items_per_iteration(n);
+}
+
+// map/count: подсчет частот слов (как в старом анализе Ципфа)
+
+void map_count(Benchmark::State& state) {
+    Vector<std::string> keys = make_word_keys(state);
+    while (state.keep_running()) {
+        Map<std::string, int> map;
+        for (size_t i = 0; i < keys.size(); ++i) {
+            ++map[keys[i]];
+        }
+        Benchmark::do_not_optimize(map.get_size());
+    }
+    state.set_items_per_iteration(keys.size());
+}
+
+void std_map_count(Benchmark::State& state) {
+    Vector<std::string> keys = make_word_keys(state);
+    while (state.keep_running()) {
+        std::unordered_map<std::string, int> map;
+        for (size_t i = 0; i < keys.size(); ++i) {
+            ++map[keys[i]];
+        }
+        Benchmark::do_not_optimize(map.size());
+    }
+    state.set_items_per_iteration(keys.size());
+}
+
+void dictionary_count(Benchmark::State& state) {
+    Vector<std::string> keys = make_word_keys(state);
+    while (state.keep_running()) {
+        TermDictionary dictionary;
+        Vector<int> counts;
+        for (size_t i = 0; i < keys.size(); ++i) {
+            uint32_t id = dictionary.intern(keys[i]);
+            if (id == counts.size()) {
+                counts.push_back(0);
+            }
+            ++counts[id];
+        }
+        Benchmark::do_not_optimize(counts.begin());
+    }
+    state.set_items_per_iteration(keys.size());
+}
+
+// map/find: поиск в заполненной таблице (словарь - все n слов)
+
+Vector<std::string> make_vocabulary(size_t n) {
+    Vector<std::string> words;
+    words.reserve(n);
+    for (uint32_t i = 0; i < n; ++i) {
+        words.push_back(Benchmark::make_word(i));
+    }
+    return words;
+}
+
+void map_find(Benchmark::State& state) {
+    Vector<std::string> vocabulary = make_vocabulary(state.n());
+    Vector<std::string> keys = make_word_keys(state);
+    Map<std::string, int> map;
+    for (size_t i = 0; i < vocabulary.size(); ++i) {
+        map.insert(vocabulary[i], static_cast<int>(i));
+    }
+    while (state.keep_running()) {
+        int sum = 0;
+        for (size_t i = 0; i < keys.size(); ++i) {
+            int value = 0;
+            map.find(keys[i], value);
+            sum += value;
+        }
+        Benchmark::do_not_optimize(sum);
+    }
+    state.set_items_per_iteration(keys.size());
+}
+
+void std_map_find(Benchmark::State& state) {
+    Vector<std::string> vocabulary = make_vocabulary(state.n());
+    Vector<std::string> keys = make_word_keys(state);
+    std::unordered_map<std::string, int> map;
+    for (size_t i = 0; i < vocabulary.size(); ++i) {
+        map[vocabulary[i]] = static_cast<int>(i);
+    }
+    while (state.keep_running()) {
+        int sum = 0;
+        for (size_t i = 0; i < keys.size(); ++i) {
+            auto it = map.find(keys[i]);
+            sum += it == map.end() ? 0 : it->second;
+        }
+        Benchmark::do_not_optimize(sum);
+    }
+    state.set_items_per_iteration(keys.size());
+}
+
+void dictionary_find(Benchmark::State& state) {
+    Vector<std::string> vocabulary = make_vocabulary(state.n());
+    Vector<std::string> keys = make_word_keys(state);
+    TermDictionary dictionary;
+    for (size_t i = 0; i < vocabulary.size(); ++i) {
+        dictionary.intern(vocabulary[i]);
+    }
+    while (state.keep_running()) {
+        uint32_t sum = 0;
+        for (size_t i = 0; i < keys.size(); ++i) {
+            sum += dictionary.find(keys[i]);
+        }
+        Benchmark::do_not_optimize(sum);
+    }
+    state.set_items_per_iteration(keys.size());
+}
+
+// set/insert
+
+void set_insert(Benchmark::State& state) {
+    Vector<uint32_t> keys = Benchmark::make_keys(state.n(), state.n(), state.distribution(), state.seed());
+    while (state.keep_running()) {
+        Set<int> set;
+        for (size_t i = 0; i < keys.size(); ++i) {
+            set.insert(static_cast<int>(keys[i]));
+        }
+        Benchmark::do_not_optimize(set.size());
+    }
+    state.set_items_per_iteration(keys.size());
+}
+
+void std_set_insert(Benchmark::State& state) {
+    Vector<uint32_t> keys = Benchmark::make_keys(state.n(), state.n(), state.distribution(), state.seed());
+    while (state.keep_running()) {
+        std::unordered_set<int> set;
+        for (size_t i = 0; i < keys.size(); ++i) {
+            set.insert(static_cast<int>(keys[i]));
+        }
+        Benchmark::do_not_optimize(set.size());
+    }
+    state.set_items_per_iteration(keys.size());
+}
+
+// sort (копирование входа в каждой итерации не измеряется)
+
+Vector<int> make_sort_input(const Benchmark::State& state) {
+    Vector<uint32_t> keys = Benchmark::make_keys(state.n(), state.n(), state.distribution(), state.seed());
+    Vector<int> input;
+    input.reserve(keys.size());
+    for (size_t i = 0; i < keys.size(); ++i) {
+        input.push_back(static_cast<int>(keys[i]));
+    }
+    return input;
+}
+
+void sort_quicksort(Benchmark::State& state) {
+    Vector<int> input = make_sort_input(state);
+    Vector<int> data;
+    while (state.keep_running()) {
+        state.pause_timing();
+        data = input;
+        state.resume_timing();
+        Sort<int>::quicksort(data, less_int);
+        Benchmark::do_not_optimize(data.begin());
+    }
+    state.set_items_per_iteration(input.size());
+}
+
+void sort_std(Benchmark::State& state) {
+    Vector<int> input = make_sort_input(state);
+    Vector<int> data;
+    while (state.keep_running()) {
+        state.pause_timing();
+        data = input;
+        state.resume_timing();
+        std::sort(data.begin(), data.end());
+        Benchmark::do_not_optimize(data.begin());
+    }
+    state.set_items_per_iteration(input.size());
+}
+
+}
+
+BENCHMARK_REGISTER(vector_push_back, "vector/push_back", "Vector", vector_push_back,
+                   SIZES(1000, 1000000), DISTRIBUTIONS("-"));
+BENCHMARK_REGISTER(std_vector_push_back, "vector/push_back", "std::vector", std_vector_push_back,
+                   SIZES(1000, 1000000), DISTRIBUTIONS("-"));
+
+BENCHMARK_REGISTER(map_count, "map/count", "Map", map_count,
+                   SIZES(1000, 100000), DISTRIBUTIONS("uniform", "zipf"));
+BENCHMARK_REGISTER(std_map_count, "map/count", "std::unordered_map", std_map_count,
+                   SIZES(1000, 100000), DISTRIBUTIONS("uniform", "zipf"));
+BENCHMARK_REGISTER(dictionary_count, "map/count", "TermDictionary", dictionary_count,
+                   SIZES(1000, 100000), DISTRIBUTIONS("uniform", "zipf"));
+
+BENCHMARK_REGISTER(map_find, "map/find", "Map", map_find,
+                   SIZES(1000, 100000), DISTRIBUTIONS("uniform", "zipf"));
+BENCHMARK_REGISTER(std_map_find, "map/find", "std::unordered_map", std_map_find,
+                   SIZES(1000, 100000), DISTRIBUTIONS("uniform", "zipf"));
+BENCHMARK_REGISTER(dictionary_find, "map/find", "TermDictionary", dictionary_find,
+                   SIZES(1000, 100000), DISTRIBUTIONS("uniform", "zipf"));
+
+// Set - линейный поиск, поэтому размеры меньше
+BENCHMARK_REGISTER(set_insert, "set/insert", "Set", set_insert,
+                   SIZES(100, 1000, 10000), DISTRIBUTIONS("uniform", "zipf"));
+BENCHMARK_REGISTER(std_set_insert, "set/insert", "std::unordered_set", std_set_insert,
+                   SIZES(100, 1000, 10000), DISTRIBUTIONS("uniform", "zipf"));
+
+// Quicksort с опорным элементом справа вырождается на упорядоченных данных
+// и повторах (глубина рекурсии ~n) - для них размеры ограничены
+BENCHMARK_REGISTER(sort_quicksort, "sort", "Sort::quicksort", sort_quicksort,
+                   SIZES(1000, 100000), DISTRIBUTIONS("uniform"));
+BENCHMARK_REGISTER(sort_quicksort_skewed, "sort", "Sort::quicksort", sort_quicksort,
+                   SIZES(1000, 10000), DISTRIBUTIONS("zipf", "sorted"));
+BENCHMARK_REGISTER(sort_std, "sort", "std::sort", sort_std,
+                   SIZES(1000, 100000), DISTRIBUTIONS("uniform"));
+BENCHMARK_REGISTER(sort_std_skewed, "sort", "std::sort", sort_std,
+                   SIZES(1000, 10000), DISTRIBUTIONS("zipf", "sorted"));
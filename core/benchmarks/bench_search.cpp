@@ -0,0 +1,109 @@
+#include "benchmark.h"
+#include "../index/boolean_index.h"
+#include "../search/boolean_search.h"
+#include <algorithm>
+#include <iterator>
+#include <string>
+#include <vector>
+
+/**
+ * Бенчмарки операций над списками документов (BooleanSearch)
+ *
+ * Индекс из 4n документов: слово alpha встречается в n документах,
+ * beta - в n ("equal") или n/16 ("skewed") документах, выбранных случайно.
+ * Базовая линия - std::set_* над теми же отсортированными списками.
+ */
+
+namespace {
+
+struct SearchFixture {
+    BooleanIndex index;
+    
+    explicit SearchFixture(const Benchmark::State& state) {
+        size_t n = state.n();
+        size_t documents = 4 * n;
+        size_t beta_count = state.distribution() == "skewed" ? std::max<size_t>(n / 16, 1) : n;
+        
+        Benchmark::Random random(state.seed());
+        Vector<std::string> contents;
+        contents.resize(documents);
+        for (size_t i = 0; i < n; ++i) {
+            contents[random.uniform(documents)] += "alpha ";
+        }
+        for (size_t i = 0; i < beta_count; ++i) {
+            contents[random.uniform(documents)] += "beta ";
+        }
+        for (size_t i = 0; i < documents; ++i) {
+            index.add_document(static_cast<int>(i + 1), contents[i] + "gamma");
+        }
+    }
+};
+
+template<typename Op>
+void std_list_operation(Benchmark::State& state, Op op) {
+    SearchFixture fixture(state);
+    while (state.keep_running()) {
+        Vector<int> a = fixture.index.get_documents("alpha");
+        Vector<int> b = fixture.index.get_documents("beta");
+        std::vector<int> result;
+        op(a.begin(), a.end(), b.begin(), b.end(), std::back_inserter(result));
+        Benchmark::do_not_optimize(result.data());
+    }
+}
+
+void search_query(Benchmark::State& state, const char* query) {
+    SearchFixture fixture(state);
+    BooleanSearch search(fixture.index);
+    while (state.keep_running()) {
+        Vector<int> result = search.search(query);
+        Benchmark::do_not_optimize(result.begin());
+    }
+}
+
+void search_and(Benchmark::State& state) {
+    search_query(state, "alpha AND beta");
+}
+
+void search_or(Benchmark::State& state) {
+    search_query(state, "alpha OR beta");
+}
+
+void search_not(Benchmark::State& state) {
+    search_query(state, "alpha NOT beta");
+}
+
+void std_and(Benchmark::State& state) {
+    std_list_operation(state, [](const int* a, const int* ae, const int* b, const int* be,
+                                 std::back_insert_iterator<std::vector<int>> out) {
+        std::set_intersection(a, ae, b, be, out);
+    });
+}
+
+void std_or(Benchmark::State& state) {
+    std_list_operation(state, [](const int* a, const int* ae, const int* b, const int* be,
+                                 std::back_insert_iterator<std::vector<int>> out) {
+        std::set_union(a, ae, b, be, out);
+    });
+}
+
+void std_not(Benchmark::State& state) {
+    std_list_operation(state, [](const int* a, const int* ae, const int* b, const int* be,
+                                 std::back_insert_iterator<std::vector<int>> out) {
+        std::set_difference(a, ae, b, be, out);
+    });
+}
+
+}
+
+BENCHMARK_REGISTER(search_and, "search/and", "BooleanSearch", search_and,
+                   SIZES(100, 1000, 10000), DISTRIBUTIONS("equal", "skewed"));
+BENCHMARK_REGISTER(std_and, "search/and", "std::set_intersection", std_and,
+                   SIZES(100, 1000, 10000), DISTRIBUTIONS("equal", "skewed"));
+BENCHMARK_REGISTER(search_or, "search/or", "BooleanSearch", search_or,
+                   SIZES(100, 1000, 10000), DISTRIBUTIONS("equal", "skewed"));
+BENCHMARK_REGISTER(std_or, "search/or", "std::set_union", std_or,
+                   SIZES(100, 1000, 10000), DISTRIBUTIONS("equal", "skewed"));
+BENCHMARK_REGISTER(search_not, "search/not", "BooleanSearch", search_not,
+                   SIZES(100, 1000, 10000), DISTRIBUTIONS("equal", "skewed"));
+BENCHMARK_REGISTER(std_not, "search/not", "std::set_difference", std_not,
+                   SIZES(100, 1000, 10000), DISTRIBUTIONS("equal", "skewed"));
@@ -0,0 +1,211 @@
+#include "benchmark.h"
+#include "../tokenizer/tokenizer.h"
+#include "../tokenizer/text_kernels.h"
+#include "../stemmer/stemmer.h"
+#include "../stemmer/stem_cache.h"
+#include <algorithm>
+#include <cctype>
+#include <sstream>
+#include <string>
+
+/**
+ * Бенчмарки обработки текста: TextKernels, Tokenizer, Stemmer, StemCache
+ *
+ * n - размер текста в байтах (для стемминга - число слов).
+ */
+
+namespace {
+
+// fold_case
+
+void fold_case_kernel(Benchmark::State& state) {
+    std::string text = Benchmark::make_text(state.n(), state.seed());
+    std::string out(text.length(), '\0');
+    while (state.keep_running()) {
+        TextKernels::fold_case(text.data(), text.length(), &out[0]);
+        Benchmark::do_not_optimize(out.data());
+    }
+    state.set_items_per_iteration(text.length());
+    state.set_bytes_per_iteration(text.length());
+}
+
+void fold_case_scalar(Benchmark::State& state) {
+    std::string text = Benchmark::make_text(state.n(), state.seed());
+    std::string out(text.length(), '\0');
+    while (state.keep_running()) {
+        TextKernels::fold_case_scalar(text.data(), text.length(), &out[0]);
+        Benchmark::do_not_optimize(out.data());
+    }
+    state.set_items_per_iteration(text.length());
+    state.set_bytes_per_iteration(text.length());
+}
+
+// Базовая линия: std::tolower (только ASCII)
+void fold_case_std_tolower(Benchmark::State& state) {
+    std::string text = Benchmark::make_text(state.n(), state.seed());
+    std::string out(text.length(), '\0');
+    while (state.keep_running()) {
+        std::transform(text.begin(), text.end(), out.begin(),
+                       [](char c) { return static_cast<char>(std::tolower(static_cast<unsigned char>(c))); });
+        Benchmark::do_not_optimize(out.data());
+    }
+    state.set_items_per_iteration(text.length());
+    state.set_bytes_per_iteration(text.length());
+}
+
+// Границы слов
+
+void word_boundaries_kernel(Benchmark::State& state) {
+    std::string text = Benchmark::make_text(state.n(), state.seed());
+    while (state.keep_running()) {
+        size_t words = 0;
+        size_t pos = 0;
+        while (true) {
+            pos = TextKernels::skip_spaces(text.data(), pos, text.length());
+            if (pos >= text.length()) {
+                break;
+            }
+            pos = TextKernels::find_space(text.data(), pos, text.length());
+            ++words;
+        }
+        Benchmark::do_not_optimize(words);
+    }
+    state.set_items_per_iteration(text.length());
+    state.set_bytes_per_iteration(text.length());
+}
+
+void word_boundaries_isspace(Benchmark::State& state) {
+    std::string text = Benchmark::make_text(state.n(), state.seed());
+    while (state.keep_running()) {
+        size_t words = 0;
+        bool in_word = false;
+        for (size_t i = 0; i < text.length(); ++i) {
+            bool space = std::isspace(static_cast<unsigned char>(text[i])) != 0;
+            if (!space && !in_word) {
+                ++words;
+            }
+            in_word = !space;
+        }
+        Benchmark::do_not_optimize(words);
+    }
+    state.set_items_per_iteration(text.length());
+    state.set_bytes_per_iteration(text.length());
+}
+
+// Токенизация
+
+void tokenize_callback(Benchmark::State& state) {
+    std::string text = Benchmark::make_text(state.n(), state.seed());
+    while (state.keep_running()) {
+        size_t bytes = 0;
+        Tokenizer::for_each_token(text.data(), text.length(), [&bytes](std::string_view token) {
+            bytes += token.length();
+        });
+        Benchmark::do_not_optimize(bytes);
+    }
+    state.set_items_per_iteration(text.length());
+    state.set_bytes_per_iteration(text.length());
+}
+
+void tokenize_vector(Benchmark::State& state) {
+    std::string text = Benchmark::make_text(state.n(), state.seed());
+    while (state.keep_running()) {
+        std::vector<std::string> tokens = Tokenizer::tokenize(text);
+        Benchmark::do_not_optimize(tokens.data());
+    }
+    state.set_items_per_iteration(text.length());
+    state.set_bytes_per_iteration(text.length());
+}
+
+// Базовая линия: istringstream >> word (без нормализации)
+void tokenize_istringstream(Benchmark::State& state) {
+    std::string text = Benchmark::make_text(state.n(), state.seed());
+    while (state.keep_running()) {
+        std::istringstream in(text);
+        std::string word;
+        size_t bytes = 0;
+        while (in >> word) {
+            bytes += word.length();
+        }
+        Benchmark::do_not_optimize(bytes);
+    }
+    state.set_items_per_iteration(text.length());
+    state.set_bytes_per_iteration(text.length());
+}
+
+// Стемминг: n слов из словаря 50000 с заданным распределением
+
+Vector<std::string> make_stem_input(const Benchmark::State& state) {
+    Vector<uint32_t> ids = Benchmark::make_keys(state.n(), 50000, state.distribution(), state.seed());
+    Vector<std::string> words;
+    words.reserve(ids.size());
+    for (size_t i = 0; i < ids.size(); ++i) {
+        words.push_back(Benchmark::make_word(ids[i]));
+    }
+    return words;
+}
+
+void stem_length(Benchmark::State& state) {
+    Vector<std::string> words = make_stem_input(state);
+    while (state.keep_running()) {
+        size_t total = 0;
+        for (size_t i = 0; i < words.size(); ++i) {
+            total += Stemmer::stem_length(words[i]);
+        }
+        Benchmark::do_not_optimize(total);
+    }
+    state.set_items_per_iteration(words.size());
+}
+
+void stem_cached(Benchmark::State& state) {
+    Vector<std::string> words = make_stem_input(state);
+    StemCache cache;
+    while (state.keep_running()) {
+        size_t total = 0;
+        for (size_t i = 0; i < words.size(); ++i) {
+            total += cache.stem_length(words[i]);
+        }
+        Benchmark::do_not_optimize(total);
+    }
+    state.set_items_per_iteration(words.size());
+}
+
+void stem_string(Benchmark::State& state) {
+    Vector<std::string> words = make_stem_input(state);
+    while (state.keep_running()) {
+        size_t total = 0;
+        for (size_t i = 0; i < words.size(); ++i) {
+            total += Stemmer::stem(words[i]).length();
+        }
+        Benchmark::do_not_optimize(total);
+    }
+    state.set_items_per_iteration(words.size());
+}
+
+}
+
+BENCHMARK_REGISTER(fold_case_kernel, "text/fold_case", "TextKernels::fold_case", fold_case_kernel,
+                   SIZES(65536, 1048576), DISTRIBUTIONS("text"));
+BENCHMARK_REGISTER(fold_case_scalar, "text/fold_case", "fold_case_scalar", fold_case_scalar,
+                   SIZES(65536, 1048576), DISTRIBUTIONS("text"));
+BENCHMARK_REGISTER(fold_case_std_tolower, "text/fold_case", "std::tolower (ASCII)", fold_case_std_tolower,
+                   SIZES(65536, 1048576), DISTRIBUTIONS("text"));
+
+BENCHMARK_REGISTER(word_boundaries_kernel, "text/word_boundaries", "TextKernels", word_boundaries_kernel,
+                   SIZES(1048576), DISTRIBUTIONS("text"));
+BENCHMARK_REGISTER(word_boundaries_isspace, "text/word_boundaries", "std::isspace", word_boundaries_isspace,
+                   SIZES(1048576), DISTRIBUTIONS("text"));
+
+BENCHMARK_REGISTER(tokenize_callback, "tokenizer/tokenize", "for_each_token", tokenize_callback,
+                   SIZES(65536, 1048576), DISTRIBUTIONS("text"));
+BENCHMARK_REGISTER(tokenize_vector, "tokenizer/tokenize", "tokenize (vector)", tokenize_vector,
+                   SIZES(65536, 1048576), DISTRIBUTIONS("text"));
+BENCHMARK_REGISTER(tokenize_istringstream, "tokenizer/tokenize", "std::istringstream", tokenize_istringstream,
+                   SIZES(65536, 1048576), DISTRIBUTIONS("text"));
+
+BENCHMARK_REGISTER(stem_length, "stemmer/stem", "Stemmer::stem_length", stem_length,
+                   SIZES(100000), DISTRIBUTIONS("uniform", "zipf"));
+BENCHMARK_REGISTER(stem_cached, "stemmer/stem", "StemCache", stem_cached,
+                   SIZES(100000), DISTRIBUTIONS("uniform", "zipf"));
+BENCHMARK_REGISTER(stem_string, "stemmer/stem", "Stemmer::stem", stem_string,
+                   SIZES(100000), DISTRIBUTIONS("uniform", "zipf"));
@@ -0,0 +1,336 @@
+#include "benchmark.h"
+#include "../utils/string_utils.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+
+Benchmark::State::State(size_t n, const std::string& distribution, uint64_t seed, uint64_t iterations)
+    : n_(n), distribution_(distribution), seed_(seed), iterations_(iterations), done_(0),
+      running_(false), elapsed_ns_(0.0), items_per_iteration_(1), bytes_per_iteration_(0) {
+}
+
+void Benchmark::State::start() {
+    alloc_started_ = AllocStats::snapshot();
+    resume_timing();
+}
+
+void Benchmark::State::stop() {
+    pause_timing();
+    allocated_ = AllocStats::snapshot() - alloc_started_;
+}
+
+void Benchmark::State::pause_timing() {
+    if (running_) {
+        elapsed_ns_ += std::chrono::duration<double, std::nano>(Clock::now() - started_at_).count();
+        running_ = false;
+    }
+}
+
+void Benchmark::State::resume_timing() {
+    if (!running_) {
+        running_ = true;
+        started_at_ = Clock::now();
+    }
+}
+
+Vector<Benchmark::Case>& Benchmark::registry() {
+    static Vector<Case> cases;
+    return cases;
+}
+
+void Benchmark::add(const char* group, const char* implementation, Function function,
+                    const Vector<size_t>& sizes, const Vector<std::string>& distributions) {
+    for (size_t i = 0; i < sizes.size(); ++i) {
+        for (size_t j = 0; j < distributions.size(); ++j) {
+            Case c;
+            c.group = group;
+            c.implementation = implementation;
+            c.function = function;
+            c.n = sizes[i];
+            c.distribution = distributions[j];
+            registry().push_back(c);
+        }
+    }
+}
+
+Benchmark::ZipfSampler::ZipfSampler(size_t universe) {
+    cdf_.resize(universe);
+    double sum = 0.0;
+    for (size_t i = 0; i < universe; ++i) {
+        sum += 1.0 / static_cast<double>(i + 1);
+        cdf_[i] = sum;
+    }
+}
+
+size_t Benchmark::ZipfSampler::sample(Random& random) const {
+    double target = random.real() * cdf_.back();
+    const double* it = std::upper_bound(cdf_.begin(), cdf_.end(), target);
+    size_t rank = static_cast<size_t>(it - cdf_.begin());
+    return rank < cdf_.size() ? rank : cdf_.size() - 1;
+}
+
+Vector<uint32_t> Benchmark::make_keys(size_t n, size_t universe, const std::string& distribution, uint64_t seed) {
+    Vector<uint32_t> keys;
+    keys.reserve(n);
+    Random random(seed);
+    
+    if (distribution == "zipf") {
+        ZipfSampler sampler(universe);
+        // Ранг -> ключ через перестановку, чтобы частые ключи не были соседними
+        for (size_t i = 0; i < n; ++i) {
+            uint64_t rank = sampler.sample(random);
+            keys.push_back(static_cast<uint32_t>((rank * 2654435761ull) % universe));
+        }
+    } else if (distribution == "sorted") {
+        for (size_t i = 0; i < n; ++i) {
+            keys.push_back(static_cast<uint32_t>(i * universe / (n == 0 ? 1 : n)));
+        }
+    } else {
+        for (size_t i = 0; i < n; ++i) {
+            keys.push_back(static_cast<uint32_t>(random.uniform(universe)));
+        }
+    }
+    return keys;
+}
+
+std::string Benchmark::make_word(uint32_t id) {
+    Random random(0x5EEDull + id * 0x100000001B3ull);
+    size_t length = 3 + random.uniform(10);
+    std::string word;
+    
+    if (id % 5 == 0) {
+        // Кириллица: а-я (U+0430 - U+044F)
+        for (size_t i = 0; i < length; ++i) {
+            unsigned cp = 0x430 + static_cast<unsigned>(random.uniform(32));
+            word += static_cast<char>(0xC0 | (cp >> 6));
+            word += static_cast<char>(0x80 | (cp & 0x3F));
+        }
+    } else {
+        for (size_t i = 0; i < length; ++i) {
+            word += static_cast<char>('a' + random.uniform(26));
+        }
+    }
+    return word;
+}
+
+std::string Benchmark::make_text(size_t bytes, uint64_t seed) {
+    static const size_t VOCABULARY = 50000;
+    
+    Vector<std::string> vocabulary;
+    vocabulary.reserve(VOCABULARY);
+    for (uint32_t i = 0; i < VOCABULARY; ++i) {
+        vocabulary.push_back(make_word(i));
+    }
+    
+    ZipfSampler sampler(VOCABULARY);
+    Random random(seed);
+    
+    std::string text;
+    text.reserve(bytes + 64);
+    size_t words_in_line = 0;
+    while (text.length() < bytes) {
+        std::string word = vocabulary[sampler.sample(random)];
+        
+        // Заглавная первая буква (латиница или кириллица)
+        if (random.uniform(10) == 0) {
+            unsigned char c = static_cast<unsigned char>(word[0]);
+            if (c >= 'a' && c <= 'z') {
+                word[0] = static_cast<char>(c - 0x20);
+            } else if (c == 0xD0 && static_cast<unsigned char>(word[1]) >= 0xB0) {
+                word[1] = static_cast<char>(static_cast<unsigned char>(word[1]) - 0x20);
+            }
+        }
+        text += word;
+        
+        uint64_t r = random.uniform(100);
+        if (r < 5) {
+            text += ',';
+        } else if (r < 8) {
+            text += '.';
+        }
+        
+        if (++words_in_line == 12) {
+            text += '\n';
+            words_in_line = 0;
+        } else {
+            text += ' ';
+        }
+    }
+    return text;
+}
+
+namespace {
+
+struct Result {
+    std::string group;
+    std::string implementation;
+    size_t n;
+    std::string distribution;
+    uint64_t iterations;
+    double ns_per_op;
+    double ns_per_op_min;
+    double ns_per_op_max;
+    double items_per_second;
+    double bytes_per_second;
+    double allocations_per_op;
+    double allocated_bytes_per_op;
+};
+
+void write_json(const std::string& path, const Vector<Result>& results, uint64_t seed,
+                double min_time_ms, size_t repetitions) {
+    std::ofstream out(path);
+    if (!out.is_open()) {
+        std::cerr << "Ошибка открытия файла для записи: " << path << std::endl;
+        return;
+    }
+    
+    out << "{\n  \"context\": {\n";
+#ifdef __VERSION__
+    out << "    \"compiler\": " << StringUtils::json_quote(__VERSION__) << ",\n";
+#endif
+#ifdef NDEBUG
+    out << "    \"assertions\": false,\n";
+#else
+    out << "    \"assertions\": true,\n";
+#endif
+    out << "    \"seed\": " << seed << ",\n";
+    out << "    \"min_time_ms\": " << min_time_ms << ",\n";
+    out << "    \"repetitions\": " << repetitions << "\n";
+    out << "  },\n  \"benchmarks\": [\n";
+    
+    for (size_t i = 0; i < results.size(); ++i) {
+        const Result& r = results[i];
+        out << "    {\"group\": " << StringUtils::json_quote(r.group)
+            << ", \"implementation\": " << StringUtils::json_quote(r.implementation)
+            << ", \"n\": " << r.n
+            << ", \"distribution\": " << StringUtils::json_quote(r.distribution)
+            << ", \"iterations\": " << r.iterations
+            << ", \"ns_per_op\": " << r.ns_per_op
+            << ", \"ns_per_op_min\": " << r.ns_per_op_min
+            << ", \"ns_per_op_max\": " << r.ns_per_op_max
+            << ", \"items_per_second\": " << r.items_per_second
+            << ", \"bytes_per_second\": " << r.bytes_per_second
+            << ", \"allocations_per_op\": " << r.allocations_per_op
+            << ", \"allocated_bytes_per_op\": " << r.allocated_bytes_per_op
+            << "}" << (i + 1 < results.size() ? "," : "") << "\n";
+    }
+    out << "  ]\n}\n";
+}
+
+}
+
+int Benchmark::main(int argc, char* argv[]) {
+    std::string filter;
+    std::string output_path;
+    double min_time_ms = 100.0;
+    size_t repetitions = 5;
+    uint64_t seed = 42;
+    bool list_only = false;
+    
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--filter" && i + 1 < argc) {
+            filter = argv[++i];
+        } else if (arg == "--out" && i + 1 < argc) {
+            output_path = argv[++i];
+        } else if (arg == "--min-time-ms" && i + 1 < argc) {
+            min_time_ms = std::stod(argv[++i]);
+        } else if (arg == "--repetitions" && i + 1 < argc) {
+            repetitions = static_cast<size_t>(std::stoul(argv[++i]));
+        } else if (arg == "--seed" && i + 1 < argc) {
+            seed = std::stoull(argv[++i]);
+        } else if (arg == "--list") {
+            list_only = true;
+        } else {
+            std::cerr << "Использование: " << argv[0] << " [опции]" << std::endl;
+            std::cerr << "  --filter S - только бенчмарки, в имени которых (группа/реализация) есть S" << std::endl;
+            std::cerr << "  --out FILE - сохранить результаты в JSON" << std::endl;
+            std::cerr << "  --min-time-ms N - минимальное время одного замера (по умолчанию 100)" << std::endl;
+            std::cerr << "  --repetitions N - повторов замера, берется медиана (по умолчанию 5)" << std::endl;
+            std::cerr << "  --seed N - seed генератора входных данных (по умолчанию 42)" << std::endl;
+            std::cerr << "  --list - вывести список бенчмарков" << std::endl;
+            return 1;
+        }
+    }
+    if (repetitions == 0) {
+        repetitions = 1;
+    }
+    
+    const Vector<Case>& cases = registry();
+    Vector<Result> results;
+    
+    std::printf("%-28s %-24s %9s %-8s %12s %14s %10s %10s %12s\n",
+                "group", "implementation", "n", "dist", "ns/op", "ops/s", "MB/s", "allocs/op", "bytes/op");
+    
+    for (size_t c = 0; c < cases.size(); ++c) {
+        const Case& bench = cases[c];
+        std::string name = bench.group + "/" + bench.implementation;
+        if (!filter.empty() && name.find(filter) == std::string::npos) {
+            continue;
+        }
+        if (list_only) {
+            std::printf("%s n=%zu %s\n", name.c_str(), bench.n, bench.distribution.c_str());
+            continue;
+        }
+        
+        // Подбор числа итераций (заодно прогрев)
+        double min_time_ns = min_time_ms * 1e6;
+        uint64_t iterations = 1;
+        while (true) {
+            State state(bench.n, bench.distribution, seed, iterations);
+            bench.function(state);
+            if (state.elapsed_ns() >= min_time_ns || iterations >= 1000000000ull) {
+                break;
+            }
+            double scale = state.elapsed_ns() > 0 ? min_time_ns * 1.2 / state.elapsed_ns() : 100.0;
+            scale = std::min(std::max(scale, 2.0), 100.0);
+            iterations = static_cast<uint64_t>(static_cast<double>(iterations) * scale) + 1;
+        }
+        
+        Vector<double> ns_per_op;
+        State last(bench.n, bench.distribution, seed, iterations);
+        for (size_t r = 0; r < repetitions; ++r) {
+            State state(bench.n, bench.distribution, seed, iterations);
+            bench.function(state);
+            double ops = static_cast<double>(iterations) * static_cast<double>(state.items_per_iteration());
+            ns_per_op.push_back(state.elapsed_ns() / ops);
+            last = state;
+        }
+        std::sort(ns_per_op.begin(), ns_per_op.end());
+        
+        double ops = static_cast<double>(iterations) * static_cast<double>(last.items_per_iteration());
+        Result result;
+        result.group = bench.group;
+        result.implementation = bench.implementation;
+        result.n = bench.n;
+        result.distribution = bench.distribution;
+        result.iterations = iterations;
+        result.ns_per_op = ns_per_op[ns_per_op.size() / 2];
+        result.ns_per_op_min = ns_per_op[0];
+        result.ns_per_op_max = ns_per_op.back();
+        result.items_per_second = 1e9 / result.ns_per_op;
+        result.bytes_per_second = static_cast<double>(last.bytes_per_iteration()) /
+                                  static_cast<double>(last.items_per_iteration()) * result.items_per_second;
+        result.allocations_per_op = static_cast<double>(last.allocated().allocations) / ops;
+        result.allocated_bytes_per_op = static_cast<double>(last.allocated().bytes) / ops;
+        results.push_back(result);
+        
+        std::printf("%-28s %-24s %9zu %-8s %12.2f %14.0f %10.1f %10.3f %12.1f\n",
+                    result.group.c_str(), result.implementation.c_str(), result.n, result.distribution.c_str(),
+                    result.ns_per_op, result.items_per_second, result.bytes_per_second / 1e6,
+                    result.allocations_per_op, result.allocated_bytes_per_op);
+        std::fflush(stdout);
+    }
+    
+    if (!output_path.empty() && !list_only) {
+        write_json(output_path, results, seed, min_time_ms, repetitions);
+        std::cout << "Результаты сохранены в: " << output_path << std::endl;
+    }
+    return 0;
+}
+
+int main(int argc, char* argv[]) {
+    return Benchmark::main(argc, argv);
+}
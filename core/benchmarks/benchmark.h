@@ -0,0 +1,209 @@
+#ifndef BENCHMARK_H
+#define BENCHMARK_H
+
+#include <chrono>
+#include <initializer_list>
+#include <cstdint>
+#include <string>
+#include "../utils/vector.h"
+#include "../utils/alloc_stats.h"
+
+/**
+ * Микробенчмарки ядра
+ *
+ * Каждый бенчмарк - функция, измеряющая цикл while (state.keep_running()).
+ * Исполнитель подбирает число итераций под минимальное время замера,
+ * повторяет замер несколько раз и берет медиану. Результат (нс/оп,
+ * операций и байт в секунду, выделения памяти на операцию) выводится
+ * таблицей и в JSON - для сравнения между коммитами.
+ *
+ * Входные данные генерируются детерминированно из seed.
+ */
+class Benchmark {
+public:
+    /**
+     * Состояние одного замера
+     */
+    class State {
+    public:
+        State(size_t n, const std::string& distribution, uint64_t seed, uint64_t iterations);
+
+        /**
+         * Продолжать ли цикл (первый вызов запускает таймер, последний - останавливает)
+         */
+        bool keep_running() {
+            if (done_ < iterations_) {
+                if (done_ == 0) {
+                    start();
+                }
+                ++done_;
+                return true;
+            }
+            stop();
+            return false;
+        }
+
+        /**
+         * Исключение подготовки данных внутри цикла из замера
+         */
+        void pause_timing();
+        void resume_timing();
+
+        /**
+         * Операций и байт за одну итерацию (для нс/оп и пропускной способности)
+         */
+        void set_items_per_iteration(uint64_t items) { items_per_iteration_ = items; }
+        void set_bytes_per_iteration(uint64_t bytes) { bytes_per_iteration_ = bytes; }
+
+        size_t n() const { return n_; }
+        const std::string& distribution() const { return distribution_; }
+        uint64_t seed() const { return seed_; }
+        uint64_t iterations() const { return iterations_; }
+
+        double elapsed_ns() const { return elapsed_ns_; }
+        uint64_t items_per_iteration() const { return items_per_iteration_; }
+        uint64_t bytes_per_iteration() const { return bytes_per_iteration_; }
+        const AllocStats::Snapshot& allocated() const { return allocated_; }
+
+    private:
+        typedef std::chrono::steady_clock Clock;
+
+        void start();
+        void stop();
+
+        size_t n_;
+        std::string distribution_;
+        uint64_t seed_;
+        uint64_t iterations_;
+        uint64_t done_;
+        bool running_;
+
+        Clock::time_point started_at_;
+        double elapsed_ns_;
+        AllocStats::Snapshot alloc_started_;
+        AllocStats::Snapshot allocated_;
+
+        uint64_t items_per_iteration_;
+        uint64_t bytes_per_iteration_;
+    };
+
+    typedef void (*Function)(State&);
+
+    /**
+     * Регистрация бенчмарка
+     *
+     * @param group что измеряется (например "map/insert"), сравниваемые реализации - в одной группе
+     * @param implementation реализация ("Map", "std::unordered_map")
+     * @param sizes размеры входа
+     * @param distributions распределения входа (например "uniform", "zipf")
+     */
+    static void add(const char* group, const char* implementation, Function function,
+                    const Vector<size_t>& sizes, const Vector<std::string>& distributions);
+
+    /**
+     * Запуск (разбор аргументов командной строки, вывод результатов)
+     */
+    static int main(int argc, char* argv[]);
+
+    /**
+     * Не дать компилятору выбросить вычисление
+     */
+    template<typename T>
+    static void do_not_optimize(const T& value) {
+        asm volatile("" : : "r,m"(value) : "memory");
+    }
+
+    /**
+     * Детерминированный генератор (splitmix64)
+     */
+    class Random {
+    public:
+        explicit Random(uint64_t seed) : state_(seed) {}
+
+        uint64_t next() {
+            uint64_t z = (state_ += 0x9E3779B97F4A7C15ull);
+            z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+            z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+            return z ^ (z >> 31);
+        }
+
+        // Равномерно в [0, bound)
+        uint64_t uniform(uint64_t bound) {
+            return next() % bound;
+        }
+
+        // В [0, 1)
+        double real() {
+            return static_cast<double>(next() >> 11) * (1.0 / 9007199254740992.0);
+        }
+
+    private:
+        uint64_t state_;
+    };
+
+    /**
+     * Выборка ранга по закону Ципфа (s = 1) из [0, universe)
+     */
+    class ZipfSampler {
+    public:
+        explicit ZipfSampler(size_t universe);
+        size_t sample(Random& random) const;
+
+    private:
+        Vector<double> cdf_;
+    };
+
+    /**
+     * Последовательность n ключей из [0, universe) с распределением
+     * "uniform", "zipf" или "sorted" (возрастающая)
+     */
+    static Vector<uint32_t> make_keys(size_t n, size_t universe, const std::string& distribution, uint64_t seed);
+
+    /**
+     * Псевдослово по номеру (латиница или кириллица, 3-12 букв), одно и то же для номера
+     */
+    static std::string make_word(uint32_t id);
+
+    /**
+     * Текст около bytes байт: слова по закону Ципфа, заглавные буквы, знаки препинания
+     */
+    static std::string make_text(size_t bytes, uint64_t seed);
+
+private:
+    struct Case {
+        std::string group;
+        std::string implementation;
+        Function function;
+        size_t n;
+        std::string distribution;
+    };
+
+    static Vector<Case>& registry();
+};
+
+/**
+ * Регистрация при статической инициализации:
+ *   BENCHMARK_REGISTER(map_insert_map, "map/insert", "Map", fn, SIZES(1000, 100000), DISTRIBUTIONS("uniform", "zipf"))
+ */
+struct BenchmarkRegistration {
+    BenchmarkRegistration(const char* group, const char* implementation, Benchmark::Function function,
+                          std::initializer_list<size_t> sizes, std::initializer_list<const char*> distributions) {
+        Vector<size_t> size_list;
+        for (size_t n : sizes) {
+            size_list.push_back(n);
+        }
+        Vector<std::string> distribution_list;
+        for (const char* d : distributions) {
+            distribution_list.push_back(d);
+        }
+        Benchmark::add(group, implementation, function, size_list, distribution_list);
+    }
+};
+
+#define BENCHMARK_REGISTER(id, group, implementation, function, sizes, distributions) \
+    static BenchmarkRegistration benchmark_registration_##id(group, implementation, function, sizes, distributions)
+
+#define SIZES(...) std::initializer_list<size_t>{__VA_ARGS__}
+#define DISTRIBUTIONS(...) std::initializer_list<const char*>{__VA_ARGS__}
+
+#endif // BENCHMARK_H
@@ -1,21 +1,144 @@
+#include <algorithm>
+#include <chrono>
+#include <fstream>
 #include <iostream>
 #include <string>
+#include <sys/resource.h>
 #include "../index/boolean_index.h"
+#include "../index/doc_store.h"
+#include "../index/sharded_index.h"
+#include "../stemmer/stem_cache.h"
+#include "../utils/alloc_stats.h"
+#include "../utils/string_utils.h"
+
+namespace {
+
+/**
+ * Пиковый размер резидентной памяти процесса, байт
+ */
+uint64_t peak_rss_bytes() {
+    struct rusage usage;
+    if (getrusage(RUSAGE_SELF, &usage) != 0) {
+        return 0;
+    }
+    return static_cast<uint64_t>(usage.ru_maxrss) * 1024;  // ru_maxrss в КБ (Linux)
+}
+
+/**
+ * Отчет о построении в JSON (для сравнения ночных сборок)
+ */
+bool write_report(const std::string& path, const std::string& corpus_dir, const std::string& index_path,
+                  size_t shards, const BooleanIndex::BuildStats& build, const BooleanIndex::IndexStats& stats,
+                  double save_seconds, const AllocStats::Snapshot& allocated, const DocStore::BuildStats* doc_store) {
+    std::ofstream out(path);
+    if (!out.is_open()) {
+        std::cerr << "Ошибка открытия файла для записи: " << path << std::endl;
+        return false;
+    }
+    
+    StemCache::Stats cache_stats = StemCache::total_stats();
+    double total_seconds = build.total_seconds + save_seconds;
+    
+    out << "{\n";
+    out << "  \"corpus\": " << StringUtils::json_quote(corpus_dir) << ",\n";
+    out << "  \"index\": " << StringUtils::json_quote(index_path) << ",\n";
+    out << "  \"shards\": " << shards << ",\n";
+    out << "  \"documents\": " << build.documents << ",\n";
+    out << "  \"bytes_read\": " << build.bytes_read << ",\n";
+    out << "  \"tokens\": " << build.tokens << ",\n";
+    out << "  \"unique_terms\": " << stats.total_words << ",\n";
+    out << "  \"field_terms\": " << stats.field_terms << ",\n";
+    out << "  \"attribute_values\": " << stats.attribute_values << ",\n";
+    out << "  \"postings\": " << stats.total_postings << ",\n";
+    out << "  \"total_seconds\": " << total_seconds << ",\n";
+    out << "  \"stages\": {\n";
+    for (int stage = 0; stage < BooleanIndex::BuildStats::STAGE_COUNT; ++stage) {
+        out << "    \"" << BooleanIndex::BuildStats::stage_name(stage) << "\": {\"seconds\": "
+            << build.stage_seconds[stage] << ", \"share\": "
+            << (total_seconds > 0.0 ? build.stage_seconds[stage] / total_seconds : 0.0) << "},\n";
+    }
+    out << "    \"save\": {\"seconds\": " << save_seconds << ", \"share\": "
+        << (total_seconds > 0.0 ? save_seconds / total_seconds : 0.0) << "}\n";
+    out << "  },\n";
+    out << "  \"stage_sampled_documents\": " << build.sampled_documents << ",\n";
+    out << "  \"tokens_per_second\": " << (build.total_seconds > 0.0 ? build.tokens / build.total_seconds : 0.0) << ",\n";
+    out << "  \"megabytes_per_second\": "
+        << (build.total_seconds > 0.0 ? build.bytes_read / build.total_seconds / 1e6 : 0.0) << ",\n";
+    out << "  \"peak_rss_bytes\": " << peak_rss_bytes() << ",\n";
+    out << "  \"allocations\": " << allocated.allocations << ",\n";
+    out << "  \"allocated_bytes\": " << allocated.bytes << ",\n";
+    if (doc_store != nullptr) {
+        out << "  \"doc_store\": {\"documents\": " << doc_store->documents
+            << ", \"blocks\": " << doc_store->blocks
+            << ", \"raw_bytes\": " << doc_store->raw_bytes
+            << ", \"file_bytes\": " << doc_store->file_bytes
+            << ", \"seconds\": " << doc_store->seconds << "},\n";
+    }
+    out << "  \"stem_cache\": {\"hits\": " << cache_stats.hits
+        << ", \"misses\": " << cache_stats.misses
+        << ", \"hit_rate\": " << cache_stats.hit_rate() << "}\n";
+    out << "}\n";
+    return true;
+}
+
+}
 
 int main(int argc, char* argv[]) {
-    // TODO: Утилита для построения индекса
-    // Использование: ./build_index <corpus_dir> <index_path>
+    // Использование: ./build_index <corpus_dir> <index_path> [опции]
+    std::string corpus_dir;
+    std::string index_path;
+    ReadAheadReader::Options read_ahead;
+    std::string report_path;
+    double progress_interval = 0.0;
+    size_t shards = 1;
+    size_t build_threads = 1;
+    bool doc_store = true;
+    size_t doc_block_size = DocStore::DEFAULT_BLOCK_SIZE;
+    
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--stem-cache" && i + 1 < argc) {
+            StemCache::set_default_capacity(static_cast<size_t>(std::stoul(argv[++i])));
+        } else if (arg == "--read-ahead" && i + 1 < argc) {
+            read_ahead.depth = static_cast<size_t>(std::stoul(argv[++i]));
+        } else if (arg == "--io-threads" && i + 1 < argc) {
+            read_ahead.threads = static_cast<size_t>(std::stoul(argv[++i]));
+        } else if (arg == "--report" && i + 1 < argc) {
+            report_path = argv[++i];
+        } else if (arg == "--progress" && i + 1 < argc) {
+            progress_interval = std::stod(argv[++i]);
+        } else if (arg == "--shards" && i + 1 < argc) {
+            shards = std::max<size_t>(static_cast<size_t>(std::stoul(argv[++i])), 1);
+        } else if (arg == "--build-threads" && i + 1 < argc) {
+            build_threads = std::max<size_t>(static_cast<size_t>(std::stoul(argv[++i])), 1);
+        } else if (arg == "--no-doc-store") {
+            doc_store = false;
+        } else if (arg == "--doc-block-size" && i + 1 < argc) {
+            doc_block_size = std::max<size_t>(static_cast<size_t>(std::stoul(argv[++i])), 1024);
+        } else if (corpus_dir.empty()) {
+            corpus_dir = arg;
+        } else if (index_path.empty()) {
+            index_path = arg;
+        }
+    }
     
-    if (argc < 3) {
-        std::cerr << "Использование: " << argv[0] << " <corpus_dir> <index_path>" << std::endl;
+    if (corpus_dir.empty() || index_path.empty()) {
+        std::cerr << "Использование: " << argv[0] << " <corpus_dir> <index_path> [опции]" << std::endl;
         std::cerr << "  corpus_dir - директория с документами корпуса" << std::endl;
-        std::cerr << "  index_path - путь к выходному файлу индекса" << std::endl;
+        std::cerr << "  index_path - путь к выходному файлу индекса (с --shards - манифест сегментов)" << std::endl;
+        std::cerr << "Опции:" << std::endl;
+        std::cerr << "  --stem-cache N - размер кеша стемминга (записей)" << std::endl;
+        std::cerr << "  --read-ahead N - файлов, читаемых заранее (0 - без упреждающего чтения)" << std::endl;
+        std::cerr << "  --io-threads N - потоков чтения файлов" << std::endl;
+        std::cerr << "  --report FILE - отчет о построении в JSON (время стадий, память, выделения)" << std::endl;
+        std::cerr << "  --progress S - прогресс с оценкой оставшегося времени раз в S секунд" << std::endl;
+        std::cerr << "  --shards K - разбить индекс на K сегментов по диапазонам ID документов" << std::endl;
+        std::cerr << "  --build-threads N - строить до N сегментов параллельно" << std::endl;
+        std::cerr << "  --no-doc-store - не записывать хранилище документов (<index_path>.docs)" << std::endl;
+        std::cerr << "  --doc-block-size N - байт текста в блоке хранилища до сжатия" << std::endl;
         return 1;
     }
     
-    std::string corpus_dir = argv[1];
-    std::string index_path = argv[2];
-    
     // Создать директорию для индекса если нужно
     size_t last_slash = index_path.find_last_of("/\\");
     if (last_slash != std::string::npos) {
@@ -24,27 +147,116 @@ int main(int argc, char* argv[]) {
         system(("mkdir -p " + index_dir).c_str());
     }
     
-    BooleanIndex index;
-    
     std::cout << "Построение индекса из корпуса: " << corpus_dir << std::endl;
     std::cout << "Выходной файл: " << index_path << std::endl;
     std::cout << std::endl;
     
-    // Построение индекса
-    index.build(corpus_dir);
+    AllocStats::Snapshot alloc_start = AllocStats::snapshot();
+    
+    BooleanIndex::BuildStats build_stats;
+    BooleanIndex::IndexStats stats;
+    double save_seconds = 0.0;
+    
+    // Хранилище документов для вывода результатов (тексты и поля заголовка)
+    // пишется в том же проходе по корпусу, что и индекс
+    DocStore::Writer doc_store_writer;
+    DocStore::Writer* doc_store_target = nullptr;
+    if (doc_store) {
+        if (!doc_store_writer.open(DocStore::path_for_index(index_path), doc_block_size)) {
+            std::cerr << "Ошибка записи хранилища документов: " << DocStore::path_for_index(index_path) << std::endl;
+            return 1;
+        }
+        doc_store_target = &doc_store_writer;
+    }
+    
+    if (shards > 1) {
+        // Сегменты строятся и сохраняются по одному (или по build_threads)
+        ShardedIndex::BuildSummary summary;
+        if (!ShardedIndex::build(corpus_dir, index_path, shards, build_threads, read_ahead,
+                                 progress_interval, summary, doc_store_target)) {
+            return 1;
+        }
+        build_stats = summary.build;
+        stats = summary.stats;
+        save_seconds = summary.save_seconds;
+    } else {
+        BooleanIndex index;
+        
+        // Построение индекса
+        index.build(corpus_dir, read_ahead, progress_interval, doc_store_target);
+        
+        // Сохранение индекса
+        std::cout << "Сохранение индекса..." << std::endl;
+        std::chrono::steady_clock::time_point save_start = std::chrono::steady_clock::now();
+        index.save(index_path);
+        save_seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - save_start).count();
+        
+        build_stats = index.get_build_stats();
+        stats = index.get_stats();
+    }
     
-    // Сохранение индекса
-    std::cout << "Сохранение индекса..." << std::endl;
-    index.save(index_path);
+    // Таблицы хранилища - после индекса; время входит в стадию store
+    DocStore::BuildStats doc_store_stats;
+    if (doc_store) {
+        std::chrono::steady_clock::time_point finish_start = std::chrono::steady_clock::now();
+        doc_store_stats.documents = doc_store_writer.document_count();
+        doc_store_stats.raw_bytes = doc_store_writer.raw_bytes();
+        if (!doc_store_writer.finish()) {
+            std::cerr << "Ошибка записи хранилища документов: " << DocStore::path_for_index(index_path) << std::endl;
+            return 1;
+        }
+        doc_store_stats.blocks = doc_store_writer.block_count();
+        doc_store_stats.file_bytes = doc_store_writer.bytes_written();
+        double finish_seconds =
+            std::chrono::duration<double>(std::chrono::steady_clock::now() - finish_start).count();
+        build_stats.stage_seconds[BooleanIndex::BuildStats::STAGE_STORE] += finish_seconds;
+        build_stats.total_seconds += finish_seconds;
+        doc_store_stats.seconds = build_stats.stage_seconds[BooleanIndex::BuildStats::STAGE_STORE];
+    }
+    
+    AllocStats::Snapshot allocated = AllocStats::snapshot() - alloc_start;
     
     // Вывод статистики
-    BooleanIndex::IndexStats stats = index.get_stats();
     std::cout << std::endl;
     std::cout << "Индекс построен:" << std::endl;
     std::cout << "  Уникальных слов: " << stats.total_words << std::endl;
+    std::cout << "  Термов полей (title:, url:): " << stats.field_terms << std::endl;
+    std::cout << "  Документов с длиной (words:): " << stats.attribute_values << std::endl;
     std::cout << "  Документов: " << stats.total_documents << std::endl;
     std::cout << "  Всего записей: " << stats.total_postings << std::endl;
     std::cout << "  Сохранен в: " << index_path << std::endl;
+    if (doc_store) {
+        std::cout << "  Хранилище документов: " << DocStore::path_for_index(index_path)
+                  << " (" << doc_store_stats.documents << " документов, " << doc_store_stats.blocks << " блоков, "
+                  << doc_store_stats.raw_bytes / (1024.0 * 1024.0) << " -> "
+                  << doc_store_stats.file_bytes / (1024.0 * 1024.0) << " МБ, "
+                  << doc_store_stats.seconds << " с)" << std::endl;
+    }
+    
+    StemCache::Stats cache_stats = StemCache::total_stats();
+    std::cout << "  Кеш стемминга: попаданий " << (cache_stats.hit_rate() * 100.0) << "%"
+              << " (hits: " << cache_stats.hits
+              << ", misses: " << cache_stats.misses
+              << ", evictions: " << cache_stats.evictions
+              << ", bypassed: " << cache_stats.bypassed
+              << ", размер: " << StemCache::local().capacity() << ")" << std::endl;
+    
+    // Время по стадиям
+    std::cout << "  Стадии (с):";
+    for (int stage = 0; stage < BooleanIndex::BuildStats::STAGE_COUNT; ++stage) {
+        std::cout << " " << BooleanIndex::BuildStats::stage_name(stage) << " " << build_stats.stage_seconds[stage];
+    }
+    std::cout << " save " << save_seconds << std::endl;
+    std::cout << "  Пиковая память: " << peak_rss_bytes() / (1024 * 1024) << " МБ"
+              << ", выделений: " << allocated.allocations << std::endl;
+    
+    if (!report_path.empty()) {
+        if (!write_report(report_path, corpus_dir, index_path, shards, build_stats, stats, save_seconds, allocated,
+                          doc_store ? &doc_store_stats : nullptr)) {
+            return 1;
+        }
+        std::cout << "  Отчет: " << report_path << std::endl;
+    }
     
     return 0;
 }
@@ -0,0 +1,133 @@
+#include <fstream>
+#include <iostream>
+#include <string>
+#include "../utils/corpus_generator.h"
+#include "../utils/corpus_pack.h"
+#include "../utils/file_utils.h"
+
+namespace {
+
+void print_usage(const char* program) {
+    std::cerr << "Использование: " << program << " <output_dir> [опции]" << std::endl;
+    std::cerr << "  output_dir - директория для doc_NNNNN.txt (с --pack - файл пакета)" << std::endl;
+    std::cerr << "Опции:" << std::endl;
+    std::cerr << "  --docs N - число документов (по умолчанию 1000)" << std::endl;
+    std::cerr << "  --start-id N - ID первого документа (по умолчанию 1)" << std::endl;
+    std::cerr << "  --vocab N - размер словаря (по умолчанию 100000)" << std::endl;
+    std::cerr << "  --zipf S - показатель распределения Ципфа (по умолчанию 1.0)" << std::endl;
+    std::cerr << "  --words N - медиана длины документа в словах (по умолчанию 2000)" << std::endl;
+    std::cerr << "  --length-sigma X - разброс длины, логнормальный (по умолчанию 0.6)" << std::endl;
+    std::cerr << "  --min-words N, --max-words N - границы длины (по умолчанию 200 и 50000)" << std::endl;
+    std::cerr << "  --cyrillic F - доля кириллических слов словаря, 0..1 (по умолчанию 0.5)" << std::endl;
+    std::cerr << "  --seed N - seed генерации (по умолчанию 42)" << std::endl;
+    std::cerr << "  --pack - записать один файл пакета (CorpusPack) вместо директории" << std::endl;
+}
+
+}
+
+int main(int argc, char* argv[]) {
+    // Использование: ./gen_corpus <output_dir> [опции]
+    std::string output;
+    CorpusGenerator::Options options;
+    size_t documents = 1000;
+    int start_id = 1;
+    bool pack = false;
+
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--docs" && i + 1 < argc) {
+            documents = static_cast<size_t>(std::stoul(argv[++i]));
+        } else if (arg == "--start-id" && i + 1 < argc) {
+            start_id = std::stoi(argv[++i]);
+        } else if (arg == "--vocab" && i + 1 < argc) {
+            options.vocabulary = static_cast<size_t>(std::stoul(argv[++i]));
+        } else if (arg == "--zipf" && i + 1 < argc) {
+            options.zipf_exponent = std::stod(argv[++i]);
+        } else if (arg == "--words" && i + 1 < argc) {
+            options.median_words = static_cast<size_t>(std::stoul(argv[++i]));
+        } else if (arg == "--length-sigma" && i + 1 < argc) {
+            options.length_sigma = std::stod(argv[++i]);
+        } else if (arg == "--min-words" && i + 1 < argc) {
+            options.min_words = static_cast<size_t>(std::stoul(argv[++i]));
+        } else if (arg == "--max-words" && i + 1 < argc) {
+            options.max_words = static_cast<size_t>(std::stoul(argv[++i]));
+        } else if (arg == "--cyrillic" && i + 1 < argc) {
+            options.cyrillic_share = std::stod(argv[++i]);
+        } else if (arg == "--seed" && i + 1 < argc) {
+            options.seed = std::stoull(argv[++i]);
+        } else if (arg == "--pack") {
+            pack = true;
+        } else if (arg == "--help" || arg == "-h") {
+            print_usage(argv[0]);
+            return 0;
+        } else if (!arg.empty() && arg[0] == '-') {
+            // Неизвестная опция или опция без значения - не имя директории
+            std::cerr << "Неизвестная опция или нет значения: " << arg << std::endl;
+            print_usage(argv[0]);
+            return 1;
+        } else if (output.empty()) {
+            output = arg;
+        } else {
+            std::cerr << "Лишний аргумент: " << arg << std::endl;
+            print_usage(argv[0]);
+            return 1;
+        }
+    }
+
+    if (output.empty() || start_id < 1) {
+        print_usage(argv[0]);
+        return 1;
+    }
+
+    CorpusGenerator generator(options);
+    CorpusPack::Writer writer;
+    if (pack) {
+        if (!writer.open(output)) {
+            std::cerr << "Ошибка создания пакета: " << output << std::endl;
+            return 1;
+        }
+    } else {
+        if (!FileUtils::create_directories(output)) {
+            std::cerr << "Ошибка создания директории: " << output << std::endl;
+            return 1;
+        }
+    }
+
+    std::cout << "Генерация корпуса: " << documents << " документов, словарь " << options.vocabulary
+              << ", s = " << options.zipf_exponent << ", seed " << options.seed << std::endl;
+
+    uint64_t total_bytes = 0;
+    for (size_t i = 0; i < documents; ++i) {
+        int doc_id = start_id + static_cast<int>(i);
+        std::string name = CorpusGenerator::file_name(doc_id);
+        std::string content = generator.document(doc_id);
+        total_bytes += content.length();
+
+        if (pack) {
+            if (!writer.add(doc_id, name, content)) {
+                std::cerr << "Ошибка записи в пакет: " << output << std::endl;
+                return 1;
+            }
+        } else {
+            std::ofstream out(output + "/" + name, std::ios::binary);
+            if (!out.is_open()) {
+                std::cerr << "Ошибка открытия файла для записи: " << output << "/" << name << std::endl;
+                return 1;
+            }
+            out.write(content.data(), static_cast<std::streamsize>(content.length()));
+        }
+
+        if ((i + 1) % 1000 == 0) {
+            std::cout << "Сгенерировано документов: " << (i + 1) << std::endl;
+        }
+    }
+
+    if (pack && !writer.finish()) {
+        std::cerr << "Ошибка записи пакета: " << output << std::endl;
+        return 1;
+    }
+
+    std::cout << "Готово: " << documents << " документов, " << total_bytes / (1024 * 1024) << " МБ"
+              << " -> " << output << std::endl;
+    return 0;
+}
@@ -1,46 +1,201 @@
+#include <algorithm>
+#include <iomanip>
 #include <iostream>
 #include <string>
+#include <unistd.h>
 #include "search_cli.h"
 #include "../index/boolean_index.h"
-#include "../search/boolean_search.h"
+#include "../search/index_handle.h"
+#include "../search/snippet_generator.h"
+#include "../utils/alloc_stats.h"
+#include "../utils/thread_pool.h"
 #include "../utils/vector.h"
 
+namespace {
+
+void print_memory_line(const std::string& name, size_t bytes, size_t total) {
+    // Выравнивание по символам, а не байтам UTF-8
+    size_t width = 0;
+    for (size_t i = 0; i < name.length(); ++i) {
+        if ((static_cast<unsigned char>(name[i]) & 0xC0) != 0x80) {
+            ++width;
+        }
+    }
+    std::cout << "  " << name << std::string(width < 34 ? 34 - width : 1, ' ') << std::fixed << std::setprecision(2)
+              << std::setw(10) << bytes / (1024.0 * 1024.0) << " МБ"
+              << std::setw(8) << std::setprecision(1) << (total > 0 ? 100.0 * bytes / total : 0.0) << "%" << std::endl;
+}
+
+/**
+ * Разбивка памяти индекса по компонентам и сверка с кучей
+ */
+void print_memory_stats(const BooleanIndex::IndexStats& stats, int64_t heap_bytes) {
+    const BooleanIndex::MemoryStats& memory = stats.memory;
+    std::cout << std::endl << "Память индекса:" << std::endl;
+    print_memory_line("Словарь (строки, таблица термов)", memory.dictionary_bytes, memory.total_bytes);
+    print_memory_line("Хеш-таблица словаря", memory.dictionary_hash_bytes, memory.total_bytes);
+    print_memory_line("Постинги", memory.postings_bytes, memory.total_bytes);
+    print_memory_line("Заголовки списков", memory.postings_overhead_bytes, memory.total_bytes);
+    print_memory_line("Частоты в коллекции", memory.frequencies_bytes, memory.total_bytes);
+    print_memory_line("Таблица документов", memory.document_table_bytes, memory.total_bytes);
+    print_memory_line("Атрибуты (words:)", memory.attributes_bytes, memory.total_bytes);
+    print_memory_line("Кеш стемминга (все потоки)", memory.stem_cache_bytes, memory.total_bytes);
+    print_memory_line("Всего", memory.total_bytes, memory.total_bytes);
+    
+    std::cout << std::endl << "Постинги:" << std::endl;
+    std::cout << "  Занято (int32): " << memory.postings_raw_bytes / (1024.0 * 1024.0) << " МБ"
+              << ", выделено: " << memory.postings_bytes / (1024.0 * 1024.0) << " МБ" << std::endl;
+    std::cout << "  В varint-дельтах (оценка): " << memory.postings_compressed_bytes / (1024.0 * 1024.0) << " МБ";
+    if (memory.postings_compressed_bytes > 0) {
+        std::cout << " (сжатие x" << static_cast<double>(memory.postings_raw_bytes) / memory.postings_compressed_bytes << ")";
+    }
+    std::cout << std::endl;
+    if (stats.total_postings > 0) {
+        std::cout << "  Байт на запись: " << static_cast<double>(memory.postings_bytes) / stats.total_postings
+                  << " (varint: " << static_cast<double>(memory.postings_compressed_bytes) / stats.total_postings << ")"
+                  << std::endl;
+    }
+    
+    // Куча по счетчику аллокатора: включает округление блоков malloc
+    std::cout << std::endl << "Куча после загрузки (счетчик аллокатора): "
+              << heap_bytes / (1024.0 * 1024.0) << " МБ, учтено в разбивке "
+              << (heap_bytes > 0 ? 100.0 * memory.total_bytes / heap_bytes : 0.0) << "%" << std::endl;
+    std::cout << "Пик кучи: " << AllocStats::peak_live_bytes() / (1024.0 * 1024.0) << " МБ" << std::endl;
+}
+
+}
+
 int main(int argc, char* argv[]) {
-    // TODO: Обработка аргументов командной строки
-    // Использование: ./search_cli <index_path> [query]
+    // Использование: ./search_cli [опции] <index_path> [query]
+    SearchCLI::ExplainMode explain = SearchCLI::EXPLAIN_NONE;
+    bool show_stats = false;
+    size_t threads = ThreadPool::default_threads();
+    bool snippets = false;
+    bool json = false;
+    size_t offset = 0;
+    size_t limit = 10;
+    std::string corpus;
+    double watch = 0.0;
+    Vector<std::string> args;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--explain") {
+            explain = SearchCLI::EXPLAIN_TEXT;
+        } else if (arg == "--explain-json") {
+            explain = SearchCLI::EXPLAIN_JSON;
+        } else if (arg == "--stats") {
+            show_stats = true;
+        } else if (arg == "--threads" && i + 1 < argc) {
+            threads = std::max<size_t>(static_cast<size_t>(std::stoul(argv[++i])), 1);
+        } else if (arg == "--snippets") {
+            snippets = true;
+        } else if (arg == "--json") {
+            json = true;
+        } else if (arg == "--offset" && i + 1 < argc) {
+            offset = static_cast<size_t>(std::stoul(argv[++i]));
+        } else if (arg == "--limit" && i + 1 < argc) {
+            limit = static_cast<size_t>(std::stoul(argv[++i]));
+        } else if (arg == "--corpus" && i + 1 < argc) {
+            corpus = argv[++i];
+        } else if (arg == "--watch" && i + 1 < argc) {
+            watch = std::stod(argv[++i]);
+        } else {
+            args.push_back(arg);
+        }
+    }
     
-    if (argc < 2) {
-        std::cerr << "Использование: " << argv[0] << " <index_path> [query]" << std::endl;
-        std::cerr << "  index_path - путь к файлу индекса" << std::endl;
+    if (args.empty()) {
+        std::cerr << "Использование: " << argv[0] << " [опции] <index_path> [query]" << std::endl;
+        std::cerr << "  index_path - путь к файлу индекса или манифесту сегментов (build_index --shards)" << std::endl;
         std::cerr << "  query - поисковый запрос (опционально, если не указан - интерактивный режим)" << std::endl;
+        std::cerr << "Опции:" << std::endl;
+        std::cerr << "  --explain - вывести план выполнения запроса (ядра, счетчики, время узлов)" << std::endl;
+        std::cerr << "  --explain-json - то же в JSON" << std::endl;
+        std::cerr << "  --stats - память индекса по компонентам (без запроса - только статистика)" << std::endl;
+        std::cerr << "  --threads N - потоков выполнения запроса: сегменты и диапазоны ID (по умолчанию по числу ядер)" << std::endl;
+        std::cerr << "  --snippets - сниппеты с подсветкой для страницы результатов" << std::endl;
+        std::cerr << "  --offset N, --limit N - страница результатов для сниппетов (по умолчанию 0 и 10)" << std::endl;
+        std::cerr << "  --corpus PATH - корпус для сниппетов: директория, пакет (pack_corpus) или хранилище"
+                  << " документов (по умолчанию <index_path>.docs, если есть)" << std::endl;
+        std::cerr << "  --json - ответ одной строкой JSON на запрос (сообщения загрузки - в stderr)" << std::endl;
+        std::cerr << "  --watch S - в интерактивном режиме раз в S секунд проверять файлы индекса"
+                  << " и подменять индекс перестроенным (команда reload - сразу)" << std::endl;
         return 1;
     }
     
-    std::string index_path = argv[1];
+    std::string index_path = args[0];
     
-    // Загрузка индекса
-    BooleanIndex index;
-    std::cout << "Загрузка индекса из: " << index_path << std::endl;
-    index.load(index_path);
+    // В режиме JSON stdout - только ответы
+    std::ostream& log = json ? std::cerr : std::cout;
     
-    BooleanIndex::IndexStats stats = index.get_stats();
-    std::cout << "Индекс загружен:" << std::endl;
-    std::cout << "  Уникальных слов: " << stats.total_words << std::endl;
-    std::cout << "  Документов: " << stats.total_documents << std::endl;
-    std::cout << "  Всего записей: " << stats.total_postings << std::endl;
+    // Сниппеты: в JSON - HTML с <mark>, в терминале - жирный шрифт
+    SnippetGenerator::Options snippet_options;
+    if (!json) {
+        snippet_options.html = false;
+        bool tty = isatty(STDOUT_FILENO) != 0;
+        snippet_options.open_tag = tty ? "\033[1m" : "**";
+        snippet_options.close_tag = tty ? "\033[0m" : "**";
+    }
     
-    // Создание поискового движка
-    BooleanSearch search_engine(index);
-    SearchCLI cli(search_engine);
+    // Загрузка индекса (снимок с генератором сниппетов; без --corpus -
+    // хранилище документов рядом с индексом, если оно есть)
+    AllocStats::Snapshot heap_before = AllocStats::snapshot();
+    IndexHandle index(index_path, snippet_options, corpus);
+    log << "Загрузка индекса из: " << index_path << std::endl;
+    if (!index.reload()) {
+        return 1;
+    }
+    std::shared_ptr<const IndexHandle::Snapshot> snapshot = index.acquire();
+    
+    // Статистика включает кеш стемминга, который создается при первом обращении
+    BooleanIndex::IndexStats stats = snapshot->index.get_stats();
+    AllocStats::Snapshot loaded = AllocStats::snapshot() - heap_before;
+    log << "Индекс загружен:" << std::endl;
+    log << "  Уникальных слов: " << stats.total_words << std::endl;
+    if (stats.field_terms > 0) {
+        log << "  Термов полей (title:, url:): " << stats.field_terms << std::endl;
+    }
+    if (stats.attribute_values > 0) {
+        log << "  Документов с длиной (words:): " << stats.attribute_values << std::endl;
+    }
+    log << "  Документов: " << stats.total_documents << std::endl;
+    log << "  Всего записей: " << stats.total_postings << std::endl;
+    if (snapshot->index.size() > 1) {
+        log << "  Сегментов: " << snapshot->index.size() << std::endl;
+    }
+    // Первый снимок держат только IndexHandle и запросы
+    snapshot.reset();
+    
+    if (show_stats) {
+        std::cout << "  Вхождений слов: " << stats.total_tokens << std::endl;
+        print_memory_stats(stats, loaded.live_bytes);
+        if (args.size() < 2) {
+            return 0;
+        }
+        std::cout << std::endl;
+    }
+    
+    // Создание поискового движка: сегменты и диапазоны ID тяжелых
+    // запросов выполняются параллельно (вызывающий поток - один из потоков)
+    ThreadPool pool(threads - 1);
+    SearchCLI cli(index, &pool);
+    cli.set_explain(explain);
+    cli.set_page(offset, limit);
+    cli.set_json(json);
+    cli.set_snippets(snippets);
     
     // Если указан запрос - выполнить поиск, иначе - интерактивный режим
-    if (argc >= 3) {
-        std::string query = argv[2];
-        for (int i = 3; i < argc; ++i) {
-            query += " " + std::string(argv[i]);
+    if (args.size() >= 2) {
+        std::string query = args[1];
+        for (size_t i = 2; i < args.size(); ++i) {
+            query += " " + args[i];
         }
         cli.process_query(query);
     } else {
+        // Перестроенный индекс подхватывается между запросами
+        if (watch > 0.0) {
+            index.watch(watch);
+        }
         cli.interactive_mode();
     }
     
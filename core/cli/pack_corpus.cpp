@@ -0,0 +1,94 @@
+#include <iostream>
+#include <string>
+#include "../index/boolean_index.h"
+#include "../utils/corpus_pack.h"
+#include "../utils/file_utils.h"
+#include "../utils/read_ahead.h"
+
+static int print_document(const std::string& pack_path, int doc_id) {
+    CorpusPack pack;
+    if (!pack.open(pack_path)) {
+        std::cerr << "Ошибка открытия пакета корпуса: " << pack_path << std::endl;
+        return 1;
+    }
+    
+    CorpusPack::Document doc;
+    if (!pack.find(doc_id, doc)) {
+        std::cerr << "Документ не найден: " << doc_id << std::endl;
+        return 1;
+    }
+    
+    std::cout.write(doc.content.data(), static_cast<std::streamsize>(doc.content.length()));
+    return 0;
+}
+
+int main(int argc, char* argv[]) {
+    // Использование: ./pack_corpus <corpus_dir> <pack_path>
+    //                ./pack_corpus --cat <pack_path> <doc_id>
+    if (argc == 4 && std::string(argv[1]) == "--cat") {
+        return print_document(argv[2], std::stoi(argv[3]));
+    }
+    
+    if (argc != 3) {
+        std::cerr << "Использование: " << argv[0] << " <corpus_dir> <pack_path>" << std::endl;
+        std::cerr << "               " << argv[0] << " --cat <pack_path> <doc_id>" << std::endl;
+        std::cerr << "  corpus_dir - директория с документами корпуса" << std::endl;
+        std::cerr << "  pack_path - выходной файл пакета (вход для build_index и zipf_analysis)" << std::endl;
+        std::cerr << "  --cat - вывести документ из пакета" << std::endl;
+        return 1;
+    }
+    
+    std::string corpus_dir = argv[1];
+    std::string pack_path = argv[2];
+    
+    Vector<std::string> files = FileUtils::list_files(corpus_dir);
+    Vector<BooleanIndex::DocumentInfo> documents = BooleanIndex::assign_document_ids(files);
+    
+    Vector<std::string> paths;
+    paths.reserve(documents.size());
+    for (size_t i = 0; i < documents.size(); ++i) {
+        paths.push_back(documents[i].path);
+    }
+    
+    CorpusPack::Writer writer;
+    if (!writer.open(pack_path)) {
+        std::cerr << "Ошибка открытия файла для записи: " << pack_path << std::endl;
+        return 1;
+    }
+    
+    std::cout << "Упаковка " << documents.size() << " документов из " << corpus_dir << std::endl;
+    
+    // Документы записываются по возрастанию ID
+    ReadAheadReader reader(paths);
+    while (const ReadAheadReader::Item* item = reader.next()) {
+        const BooleanIndex::DocumentInfo& doc = documents[item->index];
+        std::string name = FileUtils::get_filename(doc.path);
+        
+        bool ok = false;
+        if (item->status == ReadAheadReader::READ_OK) {
+            ok = writer.add(doc.id, name, item->data);
+        } else if (item->status == ReadAheadReader::READ_TOO_LARGE) {
+            ok = writer.add(doc.id, name, FileUtils::read_file(doc.path));
+        } else {
+            std::cerr << "Ошибка чтения файла: " << doc.path << std::endl;
+            continue;
+        }
+        
+        if (!ok) {
+            std::cerr << "Ошибка записи пакета: " << pack_path << std::endl;
+            return 1;
+        }
+    }
+    
+    if (!writer.finish()) {
+        std::cerr << "Ошибка записи пакета: " << pack_path << std::endl;
+        return 1;
+    }
+    
+    std::cout << "Пакет создан:" << std::endl;
+    std::cout << "  Документов: " << writer.document_count() << std::endl;
+    std::cout << "  Размер: " << writer.bytes_written() << " байт" << std::endl;
+    std::cout << "  Сохранен в: " << pack_path << std::endl;
+    
+    return 0;
+}
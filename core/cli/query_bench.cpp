@@ -0,0 +1,414 @@
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <string>
+#include <thread>
+#include "../index/boolean_index.h"
+#include "../index/sharded_index.h"
+#include "../search/boolean_search.h"
+#include "../utils/latency_histogram.h"
+#include "../utils/string_utils.h"
+#include "../utils/thread_pool.h"
+#include "../utils/vector.h"
+
+/**
+ * Нагрузочный тест поиска: задержки запросов под нагрузкой
+ *
+ * Индекс загружается один раз, запросы берутся из журнала (по строке
+ * на запрос) или генерируются: термы выбираются с вероятностью,
+ * пропорциональной документной частоте (частые слова чаще встречаются
+ * и в запросах). Два режима:
+ *
+ * - closed loop (по умолчанию): N потоков-клиентов, каждый отправляет
+ *   следующий запрос сразу после ответа на предыдущий;
+ * - open loop (--qps R): запросы приходят по расписанию (пуассоновский
+ *   поток с интенсивностью R) независимо от скорости ответов, N потоков
+ *   обслуживают очередь. Задержка считается от запланированного момента
+ *   прихода, поэтому ожидание в очереди при перегрузке тоже учитывается.
+ *
+ * Индекс может быть сегментированным (манифест build_index --shards):
+ * каждый запрос рассылается всем сегментам на общем пуле потоков,
+ * тяжелые запросы еще и делятся на диапазоны ID (--query-threads).
+ */
+
+namespace {
+
+typedef std::chrono::steady_clock Clock;
+
+struct BenchOptions {
+    std::string index_path;
+    std::string queries_path;
+    std::string json_path;
+    size_t synthetic;     // синтетических запросов
+    size_t max_terms;     // максимум термов в синтетическом запросе
+    std::string operators;
+    size_t threads;
+    size_t query_threads; // потоков выполнения одного запроса (0 - по числу ядер)
+    double qps;           // 0 - closed loop
+    double duration;      // секунд
+    size_t requests;      // 0 - ограничение по времени
+    size_t warmup;
+    uint64_t seed;
+
+    BenchOptions()
+        : synthetic(1000), max_terms(3), operators("AND,OR"), threads(1), query_threads(0), qps(0.0),
+          duration(10.0), requests(0), warmup(100), seed(42) {}
+};
+
+struct WorkerResult {
+    LatencyHistogram latency;  // от прихода запроса до ответа
+    LatencyHistogram service;  // время выполнения поиска
+    uint64_t completed;
+    uint64_t results;          // найдено документов (сумма)
+
+    WorkerResult() : completed(0), results(0) {}
+};
+
+uint64_t elapsed_ns(Clock::time_point from, Clock::time_point to) {
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(to - from).count());
+}
+
+Vector<std::string> load_queries(const std::string& path) {
+    Vector<std::string> queries;
+    std::ifstream in(path);
+    if (!in.is_open()) {
+        std::cerr << "Ошибка открытия журнала запросов: " << path << std::endl;
+        return queries;
+    }
+    std::string line;
+    while (std::getline(in, line)) {
+        if (!line.empty() && line.back() == '\r') {
+            line.pop_back();
+        }
+        if (!line.empty() && line[0] != '#') {
+            queries.push_back(line);
+        }
+    }
+    return queries;
+}
+
+Vector<std::string> split_operators(const std::string& list) {
+    Vector<std::string> operators;
+    size_t start = 0;
+    while (start <= list.length()) {
+        size_t comma = list.find(',', start);
+        if (comma == std::string::npos) {
+            comma = list.length();
+        }
+        if (comma > start) {
+            operators.push_back(list.substr(start, comma - start));
+        }
+        start = comma + 1;
+    }
+    return operators;
+}
+
+/**
+ * Синтетические запросы: 1..max_terms термов, выбранных пропорционально
+ * документной частоте, через случайные операторы из списка
+ *
+ * Для сегментов выбирается запись постингов среди всех сегментов -
+ * частота слова по всему индексу та же сумма по сегментам.
+ */
+Vector<std::string> synthesize_queries(const ShardedIndex& index, const BenchOptions& options) {
+    Vector<std::string> queries;
+
+    // Термы всех сегментов подряд: term_offsets[s] - номер первого терма сегмента s
+    Vector<uint64_t> cumulative;
+    Vector<size_t> term_offsets;
+    uint64_t total = 0;
+    for (size_t shard = 0; shard < index.size(); ++shard) {
+        const BooleanIndex& shard_index = index.shard(shard);
+        term_offsets.push_back(cumulative.size());
+        for (uint32_t id = 0; id < shard_index.get_dictionary().size(); ++id) {
+            // Термы полей (title:, url:) не выбираются - запросы по тексту
+            if (!BooleanIndex::is_field_term(shard_index.get_dictionary().term(id))) {
+                total += shard_index.get_postings(id).size();
+            }
+            cumulative.push_back(total);
+        }
+    }
+    if (total == 0) {
+        return queries;
+    }
+
+    Vector<std::string> operators = split_operators(options.operators);
+    if (operators.empty()) {
+        operators.push_back("AND");
+    }
+
+    std::mt19937_64 random(options.seed);
+    std::uniform_int_distribution<uint64_t> pick_posting(0, total - 1);
+    std::uniform_int_distribution<size_t> pick_length(1, std::max<size_t>(options.max_terms, 1));
+    std::uniform_int_distribution<size_t> pick_operator(0, operators.size() - 1);
+
+    queries.reserve(options.synthetic);
+    for (size_t q = 0; q < options.synthetic; ++q) {
+        size_t terms = pick_length(random);
+        std::string query;
+        for (size_t t = 0; t < terms; ++t) {
+            uint64_t target = pick_posting(random);
+            size_t term = std::upper_bound(cumulative.begin(), cumulative.end(), target) - cumulative.begin();
+            size_t shard = std::upper_bound(term_offsets.begin(), term_offsets.end(), term) - term_offsets.begin() - 1;
+            if (t > 0) {
+                query += " " + operators[pick_operator(random)] + " ";
+            }
+            query += index.shard(shard).get_dictionary().term(static_cast<uint32_t>(term - term_offsets[shard]));
+        }
+        queries.push_back(query);
+    }
+    return queries;
+}
+
+/**
+ * Моменты прихода запросов (нс от начала) для open loop:
+ * экспоненциальные интервалы со средним 1/qps
+ */
+Vector<uint64_t> schedule_arrivals(size_t count, double qps, uint64_t seed) {
+    Vector<uint64_t> arrivals;
+    arrivals.reserve(count);
+    std::mt19937_64 random(seed ^ 0x9E3779B97F4A7C15ull);
+    std::exponential_distribution<double> gap(qps);
+    double at = 0.0;
+    for (size_t i = 0; i < count; ++i) {
+        arrivals.push_back(static_cast<uint64_t>(at * 1e9));
+        at += gap(random);
+    }
+    return arrivals;
+}
+
+void print_row(const char* name, const LatencyHistogram& h) {
+    std::cout << "  " << std::left << std::setw(10) << name << std::right << std::fixed << std::setprecision(1)
+              << std::setw(10) << h.min() / 1e3
+              << std::setw(10) << h.mean() / 1e3
+              << std::setw(10) << h.percentile(50) / 1e3
+              << std::setw(10) << h.percentile(90) / 1e3
+              << std::setw(10) << h.percentile(99) / 1e3
+              << std::setw(10) << h.percentile(99.9) / 1e3
+              << std::setw(12) << h.max() / 1e3 << std::endl;
+}
+
+void write_histogram_json(std::ostream& out, const LatencyHistogram& h) {
+    out << "{\"count\": " << h.count()
+        << ", \"min_us\": " << h.min() / 1e3
+        << ", \"mean_us\": " << h.mean() / 1e3
+        << ", \"p50_us\": " << h.percentile(50) / 1e3
+        << ", \"p90_us\": " << h.percentile(90) / 1e3
+        << ", \"p99_us\": " << h.percentile(99) / 1e3
+        << ", \"p999_us\": " << h.percentile(99.9) / 1e3
+        << ", \"max_us\": " << h.max() / 1e3 << "}";
+}
+
+void print_usage(const char* program) {
+    std::cerr << "Использование: " << program << " <index_path> [опции]" << std::endl;
+    std::cerr << "  index_path - путь к файлу индекса или манифесту сегментов" << std::endl;
+    std::cerr << "Опции:" << std::endl;
+    std::cerr << "  --queries FILE - журнал запросов (по строке на запрос), иначе синтетические" << std::endl;
+    std::cerr << "  --synthetic N - число синтетических запросов (по умолчанию 1000)" << std::endl;
+    std::cerr << "  --terms N - максимум термов в синтетическом запросе (по умолчанию 3)" << std::endl;
+    std::cerr << "  --operators LIST - операторы синтетических запросов (по умолчанию AND,OR)" << std::endl;
+    std::cerr << "  --threads N - потоков-клиентов (closed loop) или обработчиков (open loop)" << std::endl;
+    std::cerr << "  --query-threads N - потоков выполнения одного запроса: сегменты и диапазоны ID" << std::endl;
+    std::cerr << "    (по умолчанию по числу ядер, 1 - без внутризапросного параллелизма)" << std::endl;
+    std::cerr << "  --qps R - open loop: R запросов в секунду (пуассоновский поток)" << std::endl;
+    std::cerr << "  --duration S - длительность замера в секундах (по умолчанию 10)" << std::endl;
+    std::cerr << "  --requests N - фиксированное число запросов вместо длительности" << std::endl;
+    std::cerr << "  --warmup N - запросов прогрева, не входящих в замер (по умолчанию 100)" << std::endl;
+    std::cerr << "  --seed N - seed генерации запросов и расписания" << std::endl;
+    std::cerr << "  --json FILE - сохранить результаты в JSON" << std::endl;
+}
+
+}
+
+int main(int argc, char* argv[]) {
+    BenchOptions options;
+
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--queries" && i + 1 < argc) {
+            options.queries_path = argv[++i];
+        } else if (arg == "--synthetic" && i + 1 < argc) {
+            options.synthetic = static_cast<size_t>(std::stoul(argv[++i]));
+        } else if (arg == "--terms" && i + 1 < argc) {
+            options.max_terms = static_cast<size_t>(std::stoul(argv[++i]));
+        } else if (arg == "--operators" && i + 1 < argc) {
+            options.operators = argv[++i];
+        } else if (arg == "--threads" && i + 1 < argc) {
+            options.threads = std::max<size_t>(static_cast<size_t>(std::stoul(argv[++i])), 1);
+        } else if (arg == "--query-threads" && i + 1 < argc) {
+            options.query_threads = static_cast<size_t>(std::stoul(argv[++i]));
+        } else if (arg == "--qps" && i + 1 < argc) {
+            options.qps = std::stod(argv[++i]);
+        } else if (arg == "--duration" && i + 1 < argc) {
+            options.duration = std::stod(argv[++i]);
+        } else if (arg == "--requests" && i + 1 < argc) {
+            options.requests = static_cast<size_t>(std::stoul(argv[++i]));
+        } else if (arg == "--warmup" && i + 1 < argc) {
+            options.warmup = static_cast<size_t>(std::stoul(argv[++i]));
+        } else if (arg == "--seed" && i + 1 < argc) {
+            options.seed = std::stoull(argv[++i]);
+        } else if (arg == "--json" && i + 1 < argc) {
+            options.json_path = argv[++i];
+        } else if (options.index_path.empty()) {
+            options.index_path = arg;
+        }
+    }
+
+    if (options.index_path.empty()) {
+        print_usage(argv[0]);
+        return 1;
+    }
+
+    ShardedIndex index;
+    std::cout << "Загрузка индекса из: " << options.index_path << std::endl;
+    Clock::time_point load_start = Clock::now();
+    index.load(options.index_path);
+    double load_seconds = elapsed_ns(load_start, Clock::now()) / 1e9;
+
+    BooleanIndex::IndexStats stats = index.get_stats();
+    std::cout << "  Уникальных слов: " << stats.total_words
+              << ", документов: " << stats.total_documents
+              << ", сегментов: " << index.size()
+              << ", загрузка: " << load_seconds << " с" << std::endl;
+
+    Vector<std::string> queries = options.queries_path.empty() ?
+        synthesize_queries(index, options) : load_queries(options.queries_path);
+    if (queries.empty()) {
+        std::cerr << "Нет запросов для выполнения" << std::endl;
+        return 1;
+    }
+    std::cout << "Запросов: " << queries.size()
+              << (options.queries_path.empty() ? " (синтетические)" : " (журнал)") << std::endl;
+
+    // Пул общий для всех клиентов; вызывающий поток тоже выполняет свою
+    // часть запроса, поэтому фоновых потоков на один меньше
+    size_t query_threads = options.query_threads > 0 ? options.query_threads : ThreadPool::default_threads();
+    ThreadPool pool(query_threads - 1);
+    BooleanSearch search(index, &pool);
+
+    // Прогрев: кеши стемминга, страницы индекса
+    for (size_t i = 0; i < options.warmup; ++i) {
+        Vector<int> result = search.search(queries[i % queries.size()]);
+        (void)result;
+    }
+
+    bool open_loop = options.qps > 0.0;
+    size_t limit = options.requests;
+    if (open_loop && limit == 0) {
+        limit = static_cast<size_t>(options.qps * options.duration);
+    }
+    Vector<uint64_t> arrivals;
+    if (open_loop) {
+        arrivals = schedule_arrivals(limit, options.qps, options.seed);
+    }
+
+    std::cout << "Режим: " << (open_loop ? "open loop" : "closed loop")
+              << ", потоков: " << options.threads;
+    if (open_loop) {
+        std::cout << ", целевая нагрузка: " << options.qps << " запр/с";
+    }
+    std::cout << std::endl << std::endl;
+
+    Vector<WorkerResult> results;
+    results.resize(options.threads);
+    std::atomic<size_t> next_request(0);
+    Clock::time_point start = Clock::now();
+    Clock::time_point deadline = start + std::chrono::nanoseconds(static_cast<uint64_t>(options.duration * 1e9));
+
+    auto worker = [&](size_t worker_id) {
+        WorkerResult& result = results[worker_id];
+        while (true) {
+            size_t i = next_request.fetch_add(1, std::memory_order_relaxed);
+            if (limit != 0 && i >= limit) {
+                break;
+            }
+
+            Clock::time_point arrival;
+            if (open_loop) {
+                arrival = start + std::chrono::nanoseconds(arrivals[i]);
+                std::this_thread::sleep_until(arrival);
+            } else {
+                arrival = Clock::now();
+                if (limit == 0 && arrival >= deadline) {
+                    break;
+                }
+            }
+
+            Clock::time_point begin = Clock::now();
+            Vector<int> found = search.search(queries[i % queries.size()]);
+            Clock::time_point end = Clock::now();
+
+            result.latency.record(elapsed_ns(arrival, end));
+            result.service.record(elapsed_ns(begin, end));
+            result.results += found.size();
+            ++result.completed;
+        }
+    };
+
+    Vector<std::thread> workers;
+    for (size_t t = 0; t < options.threads; ++t) {
+        workers.push_back(std::thread(worker, t));
+    }
+    for (size_t t = 0; t < workers.size(); ++t) {
+        workers[t].join();
+    }
+    double seconds = elapsed_ns(start, Clock::now()) / 1e9;
+
+    WorkerResult total;
+    for (size_t t = 0; t < results.size(); ++t) {
+        total.latency.merge(results[t].latency);
+        total.service.merge(results[t].service);
+        total.completed += results[t].completed;
+        total.results += results[t].results;
+    }
+    double throughput = seconds > 0.0 ? total.completed / seconds : 0.0;
+    double average_results = total.completed > 0 ? static_cast<double>(total.results) / total.completed : 0.0;
+
+    std::cout << "Выполнено запросов: " << total.completed << " за " << seconds << " с" << std::endl;
+    std::cout << "Пропускная способность: " << std::fixed << std::setprecision(1) << throughput << " запр/с" << std::endl;
+    std::cout << "Найдено документов в среднем: " << average_results << std::endl;
+    std::cout << std::endl;
+    std::cout << "Задержки, мкс:" << std::endl;
+    std::cout << "  " << std::left << std::setw(10) << "" << std::right
+              << std::setw(10) << "min" << std::setw(10) << "mean" << std::setw(10) << "p50"
+              << std::setw(10) << "p90" << std::setw(10) << "p99" << std::setw(10) << "p999"
+              << std::setw(12) << "max" << std::endl;
+    print_row("latency", total.latency);
+    if (open_loop) {
+        print_row("service", total.service);
+    }
+
+    if (!options.json_path.empty()) {
+        std::ofstream out(options.json_path);
+        if (!out.is_open()) {
+            std::cerr << "Ошибка открытия файла для записи: " << options.json_path << std::endl;
+            return 1;
+        }
+        out << "{\n";
+        out << "  \"index\": " << StringUtils::json_quote(options.index_path) << ",\n";
+        out << "  \"mode\": \"" << (open_loop ? "open" : "closed") << "\",\n";
+        out << "  \"threads\": " << options.threads << ",\n";
+        out << "  \"shards\": " << index.size() << ",\n";
+        out << "  \"query_threads\": " << pool.size() + 1 << ",\n";
+        out << "  \"target_qps\": " << options.qps << ",\n";
+        out << "  \"queries\": " << queries.size() << ",\n";
+        out << "  \"synthetic\": " << (options.queries_path.empty() ? "true" : "false") << ",\n";
+        out << "  \"seed\": " << options.seed << ",\n";
+        out << "  \"completed\": " << total.completed << ",\n";
+        out << "  \"seconds\": " << seconds << ",\n";
+        out << "  \"throughput_qps\": " << throughput << ",\n";
+        out << "  \"average_results\": " << average_results << ",\n";
+        out << "  \"latency\": ";
+        write_histogram_json(out, total.latency);
+        out << ",\n  \"service\": ";
+        write_histogram_json(out, total.service);
+        out << "\n}\n";
+        std::cout << std::endl << "Результаты сохранены в: " << options.json_path << std::endl;
+    }
+
+    return 0;
+}
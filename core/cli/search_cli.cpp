@@ -1,9 +1,13 @@
 #include "search_cli.h"
 #include "../search/boolean_search.h"
+#include "../search/snippet_generator.h"
+#include "../utils/string_utils.h"
 #include <iostream>
 #include <string>
 
-SearchCLI::SearchCLI(const BooleanSearch& search_engine) : search_engine_(search_engine) {
+SearchCLI::SearchCLI(IndexHandle& index, ThreadPool* pool)
+    : index_(index), pool_(pool), explain_(EXPLAIN_NONE), snippets_(false),
+      offset_(0), limit_(10), json_(false) {
 }
 
 void SearchCLI::process_query(const std::string& query) {
@@ -11,29 +15,78 @@ void SearchCLI::process_query(const std::string& query) {
         return;
     }
     
+    // Снимок держится до конца запроса: перезагрузка в это время его не освободит
+    std::shared_ptr<const IndexHandle::Snapshot> snapshot = index_.acquire();
+    BooleanSearch search_engine(snapshot->index, pool_);
+    
+    if (json_) {
+        print_json(*snapshot, query, search_engine.search(query));
+        return;
+    }
+    
     std::cout << "Поиск: " << query << std::endl;
     
-    Vector<int> results = search_engine_.search(query);
+    if (explain_ == EXPLAIN_NONE) {
+        Vector<int> results = search_engine.search(query);
+        print_results(results);
+        print_snippets(snapshot->snippets, query, results);
+        return;
+    }
     
+    Vector<int> results;
+    QueryPlan plan = search_engine.explain(query, results);
     print_results(results);
+    print_snippets(snapshot->snippets, query, results);
+    
+    std::cout << std::endl;
+    if (explain_ == EXPLAIN_JSON) {
+        std::cout << plan.to_json() << std::endl;
+    } else {
+        std::cout << plan.to_text();
+    }
 }
 
 void SearchCLI::interactive_mode() {
-    std::cout << "Введите поисковый запрос (или 'quit' для выхода):" << std::endl;
+    // В режиме JSON - только ответы, по строке на запрос
+    if (!json_) {
+        std::cout << "Введите поисковый запрос (или 'quit' для выхода):" << std::endl;
+    }
     
     std::string query;
     while (std::getline(std::cin, query)) {
         if (query == "quit" || query == "exit" || query == "q") {
             break;
         }
+        if (query == "reload") {
+            reload_index();
+            continue;
+        }
         
         if (!query.empty()) {
             process_query(query);
-            std::cout << "\nВведите следующий запрос:" << std::endl;
+            if (!json_) {
+                std::cout << "\nВведите следующий запрос:" << std::endl;
+            }
         }
     }
 }
 
+void SearchCLI::reload_index() {
+    bool ok = index_.reload();
+    std::shared_ptr<const IndexHandle::Snapshot> snapshot = index_.acquire();
+    if (json_) {
+        std::cout << "{\"reload\": " << (ok ? "true" : "false") << ", \"version\": " << snapshot->version
+                  << ", \"documents\": " << snapshot->documents << "}" << std::endl;
+        return;
+    }
+    if (ok) {
+        std::cout << "Индекс перезагружен: версия " << snapshot->version << ", документов "
+                  << snapshot->documents << ", загрузка " << snapshot->load_seconds << " с" << std::endl;
+    } else {
+        std::cout << "Индекс не перезагружен, используется версия " << snapshot->version << std::endl;
+    }
+}
+
 void SearchCLI::print_results(const Vector<int>& doc_ids) {
     std::cout << "Найдено документов: " << doc_ids.size() << std::endl;
     
@@ -59,3 +112,69 @@ void SearchCLI::print_results(const Vector<int>& doc_ids) {
         std::cout << std::endl;
     }
 }
+
+Vector<int> SearchCLI::page(const Vector<int>& doc_ids) const {
+    Vector<int> result;
+    for (size_t i = offset_; i < doc_ids.size() && i - offset_ < limit_; ++i) {
+        result.push_back(doc_ids[i]);
+    }
+    return result;
+}
+
+void SearchCLI::print_snippets(const SnippetGenerator& generator, const std::string& query,
+                               const Vector<int>& doc_ids) {
+    if (!snippets_) {
+        return;
+    }
+    Vector<SnippetGenerator::Snippet> snippets = generator.generate(query, page(doc_ids));
+    if (snippets.empty()) {
+        return;
+    }
+    
+    std::cout << std::endl << "Сниппеты (результаты " << offset_ + 1 << "-" << offset_ + snippets.size() << "):" << std::endl;
+    for (size_t i = 0; i < snippets.size(); ++i) {
+        const SnippetGenerator::Snippet& snippet = snippets[i];
+        std::cout << "[" << snippet.doc_id << "] ";
+        if (!snippet.found) {
+            std::cout << "(документ недоступен)" << std::endl;
+            continue;
+        }
+        std::cout << (snippet.title.empty() ? "Без названия" : snippet.title) << std::endl;
+        if (!snippet.url.empty()) {
+            std::cout << "    " << snippet.url << std::endl;
+        }
+        std::cout << "    " << snippet.text << std::endl;
+    }
+}
+
+void SearchCLI::print_json(const IndexHandle::Snapshot& snapshot, const std::string& query,
+                           const Vector<int>& doc_ids) {
+    std::string out = "{\"query\": " + StringUtils::json_quote(query);
+    out += ", \"count\": " + std::to_string(doc_ids.size());
+    out += ", \"doc_ids\": [";
+    for (size_t i = 0; i < doc_ids.size(); ++i) {
+        out += i > 0 ? ", " : "";
+        out += std::to_string(doc_ids[i]);
+    }
+    out += "], \"offset\": " + std::to_string(offset_);
+    
+    if (snippets_) {
+        Vector<SnippetGenerator::Snippet> snippets = snapshot.snippets.generate(query, page(doc_ids));
+        out += ", \"snippets\": [";
+        for (size_t i = 0; i < snippets.size(); ++i) {
+            const SnippetGenerator::Snippet& snippet = snippets[i];
+            out += i > 0 ? ", " : "";
+            out += "{\"id\": " + std::to_string(snippet.doc_id);
+            out += ", \"found\": ";
+            out += snippet.found ? "true" : "false";
+            out += ", \"title\": " + StringUtils::json_quote(snippet.title);
+            out += ", \"url\": " + StringUtils::json_quote(snippet.url);
+            out += ", \"word_count\": " + std::to_string(snippet.word_count);
+            out += ", \"snippet\": " + StringUtils::json_quote(snippet.text);
+            out += ", \"matches\": " + std::to_string(snippet.matches) + "}";
+        }
+        out += "]";
+    }
+    out += "}";
+    std::cout << out << std::endl;
+}
@@ -2,26 +2,77 @@
 #define SEARCH_CLI_H
 
 #include <string>
+#include "../search/index_handle.h"
 #include "../utils/vector.h"
 
-// Forward declaration
-class BooleanSearch;
+class ThreadPool;
 
 /**
  * CLI интерфейс для поиска
+ *
+ * Каждый запрос выполняется на снимке индекса, взятом в его начале
+ * (IndexHandle): команда reload интерактивного режима или фоновая
+ * проверка файлов подменяют индекс между запросами, не прерывая их.
  */
 class SearchCLI {
 public:
+    /**
+     * Вывод плана выполнения запроса (EXPLAIN)
+     */
+    enum ExplainMode {
+        EXPLAIN_NONE,
+        EXPLAIN_TEXT,
+        EXPLAIN_JSON
+    };
+    
     /**
      * Конструктор
+     *
+     * @param index перезагружаемый индекс (уже загруженный)
+     * @param pool потоки выполнения запросов (nullptr - в вызывающем потоке)
+     */
+    SearchCLI(IndexHandle& index, ThreadPool* pool);
+    
+    /**
+     * Выводить план после результатов каждого запроса
+     */
+    void set_explain(ExplainMode mode) {
+        explain_ = mode;
+    }
+    
+    /**
+     * Выводить сниппеты для страницы результатов (генератор снимка индекса)
+     */
+    void set_snippets(bool snippets) {
+        snippets_ = snippets;
+    }
+    
+    /**
+     * Страница результатов: с какого и сколько (по умолчанию первые 10)
      */
-    SearchCLI(const BooleanSearch& search_engine);
+    void set_page(size_t offset, size_t limit) {
+        offset_ = offset;
+        limit_ = limit;
+    }
+    
+    /**
+     * Ответ одной строкой JSON на запрос: число и все ID результатов,
+     * сниппеты страницы (для веб-интерфейса)
+     */
+    void set_json(bool json) {
+        json_ = json;
+    }
     
     /**
      * Обработка запроса и вывод результатов
      */
     void process_query(const std::string& query);
     
+    /**
+     * Перезагрузка индекса с выводом результата (команда reload)
+     */
+    void reload_index();
+    
     /**
      * Интерактивный режим (чтение из stdin)
      */
@@ -33,7 +84,22 @@ private:
      */
     void print_results(const Vector<int>& doc_ids);
     
-    const BooleanSearch& search_engine_;
+    void print_snippets(const SnippetGenerator& generator, const std::string& query, const Vector<int>& doc_ids);
+    
+    void print_json(const IndexHandle::Snapshot& snapshot, const std::string& query, const Vector<int>& doc_ids);
+    
+    /**
+     * ID результатов текущей страницы
+     */
+    Vector<int> page(const Vector<int>& doc_ids) const;
+    
+    IndexHandle& index_;
+    ThreadPool* pool_;
+    ExplainMode explain_;
+    bool snippets_;
+    size_t offset_;
+    size_t limit_;
+    bool json_;
 };
 
 #endif // SEARCH_CLI_H
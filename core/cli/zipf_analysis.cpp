@@ -1,32 +1,70 @@
 #include <iostream>
 #include <string>
 #include "../analysis/zipf_analyzer.h"
+#include "../stemmer/stem_cache.h"
 
 int main(int argc, char* argv[]) {
-    // TODO: Утилита для анализа закона Ципфа
-    // Использование: ./zipf_analysis <corpus_dir> <output_csv>
+    // Использование: ./zipf_analysis <corpus_dir> <output_csv> [опции]
+    std::string corpus_dir;
+    std::string output_csv;
+    ZipfAnalyzer::Options options;
+    bool from_index = false;
     
-    if (argc < 3) {
-        std::cerr << "Использование: " << argv[0] << " <corpus_dir> <output_csv>" << std::endl;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--stem-cache" && i + 1 < argc) {
+            StemCache::set_default_capacity(static_cast<size_t>(std::stoul(argv[++i])));
+        } else if (arg == "--read-ahead" && i + 1 < argc) {
+            options.read_ahead.depth = static_cast<size_t>(std::stoul(argv[++i]));
+        } else if (arg == "--io-threads" && i + 1 < argc) {
+            options.read_ahead.threads = static_cast<size_t>(std::stoul(argv[++i]));
+        } else if (arg == "--threads" && i + 1 < argc) {
+            options.threads = static_cast<size_t>(std::stoul(argv[++i]));
+        } else if (arg == "--from-index") {
+            from_index = true;
+        } else if (arg == "--approx") {
+            options.approximate = true;
+        } else if (arg == "--top-k" && i + 1 < argc) {
+            options.top_k = static_cast<size_t>(std::stoul(argv[++i]));
+        } else if (arg == "--sketch-width" && i + 1 < argc) {
+            options.sketch_width = static_cast<size_t>(std::stoul(argv[++i]));
+        } else if (arg == "--sketch-depth" && i + 1 < argc) {
+            options.sketch_depth = static_cast<size_t>(std::stoul(argv[++i]));
+        } else if (corpus_dir.empty()) {
+            corpus_dir = arg;
+        } else if (output_csv.empty()) {
+            output_csv = arg;
+        }
+    }
+    
+    if (corpus_dir.empty() || output_csv.empty()) {
+        std::cerr << "Использование: " << argv[0] << " <corpus_dir> <output_csv> [опции]" << std::endl;
         std::cerr << "  corpus_dir - директория с документами корпуса" << std::endl;
         std::cerr << "  output_csv - путь к выходному CSV файлу с результатами" << std::endl;
+        std::cerr << "Опции:" << std::endl;
+        std::cerr << "  --from-index - corpus_dir - файл индекса build_index (без повторной токенизации)" << std::endl;
+        std::cerr << "  --threads N - потоков анализа (0 - по числу ядер, по умолчанию 1)" << std::endl;
+        std::cerr << "  --approx - приближенный подсчет в фиксированной памяти (Space-Saving + Count-Min)" << std::endl;
+        std::cerr << "  --top-k N - число отслеживаемых слов в приближенном режиме (по умолчанию 10000)" << std::endl;
+        std::cerr << "  --sketch-width N, --sketch-depth N - размеры Count-Min (по умолчанию 65536 x 4)" << std::endl;
+        std::cerr << "  --stem-cache N - размер кеша стемминга (записей)" << std::endl;
+        std::cerr << "  --read-ahead N - файлов, читаемых заранее (0 - без упреждающего чтения)" << std::endl;
+        std::cerr << "  --io-threads N - потоков чтения файлов" << std::endl;
         return 1;
     }
     
-    std::string corpus_dir = argv[1];
-    std::string output_csv = argv[2];
-    
     std::cout << "Анализ закона Ципфа для корпуса: " << corpus_dir << std::endl;
     std::cout << "Выходной файл: " << output_csv << std::endl;
     std::cout << std::endl;
     
-    // Анализ корпуса
-    std::vector<ZipfAnalyzer::WordFrequency> frequencies = 
-        ZipfAnalyzer::analyze_corpus(corpus_dir);
+    // Анализ корпуса (или готового индекса)
+    std::vector<ZipfAnalyzer::WordFrequency> frequencies = from_index ?
+        ZipfAnalyzer::analyze_index(corpus_dir, options.threads) :
+        ZipfAnalyzer::analyze_corpus(corpus_dir, options);
     
     // Сохранение результатов
     std::cout << "Сохранение результатов..." << std::endl;
-    ZipfAnalyzer::save_to_csv(frequencies, output_csv);
+    ZipfAnalyzer::save_to_csv(frequencies, output_csv, options.approximate);
     
     // Вывод топ-10 слов
     std::cout << std::endl;
@@ -42,6 +80,13 @@ int main(int argc, char* argv[]) {
     
     std::cout << std::endl;
     std::cout << "Всего уникальных слов: " << frequencies.size() << std::endl;
+    
+    StemCache::Stats cache_stats = StemCache::total_stats();
+    std::cout << "Кеш стемминга: попаданий " << (cache_stats.hit_rate() * 100.0) << "%"
+              << " (hits: " << cache_stats.hits
+              << ", misses: " << cache_stats.misses
+              << ", evictions: " << cache_stats.evictions
+              << ", bypassed: " << cache_stats.bypassed << ")" << std::endl;
     std::cout << "Результаты сохранены в: " << output_csv << std::endl;
     
     return 0;
@@ -1,130 +1,979 @@
 #include "boolean_index.h"
+#include "doc_store.h"
 #include "../tokenizer/tokenizer.h"
 #include "../stemmer/stemmer.h"
+#include "../stemmer/stem_cache.h"
 #include "../utils/file_utils.h"
-#include "../utils/sort.h"
+#include "../utils/corpus_pack.h"
+#include <algorithm>
+#include <cctype>
+#include <cerrno>
+#include <chrono>
 #include <fstream>
 #include <iostream>
-#include <sstream>
+#include <limits>
+#include <cstdio>
+#include <cstdlib>
 
-static bool compare_int(const int& a, const int& b) {
-    return a < b;
+Vector<BooleanIndex::DocumentInfo> BooleanIndex::assign_document_ids(const Vector<std::string>& files) {
+    // ID из имен файлов
+    Vector<DocumentInfo> named;
+    Vector<std::string> rest;
+    for (size_t i = 0; i < files.size(); ++i) {
+        int doc_id = FileUtils::parse_doc_id(files[i]);
+        if (doc_id < 0) {
+            rest.push_back(files[i]);
+            continue;
+        }
+        DocumentInfo doc;
+        doc.id = doc_id;
+        doc.path = files[i];
+        named.push_back(std::move(doc));
+    }
+    
+    std::sort(named.begin(), named.end(),
+              [](const DocumentInfo& a, const DocumentInfo& b) {
+                  if (a.id != b.id) {
+                      return a.id < b.id;
+                  }
+                  return a.path < b.path;
+              });
+    
+    Vector<DocumentInfo> documents;
+    documents.reserve(files.size());
+    int next_id = 1;
+    for (size_t i = 0; i < named.size(); ++i) {
+        // Повторяющийся ID (doc_1.txt и doc_00001.txt) - файл нумеруется как остальные
+        if (!documents.empty() && documents.back().id == named[i].id) {
+            rest.push_back(named[i].path);
+            continue;
+        }
+        next_id = named[i].id + 1;
+        documents.push_back(std::move(named[i]));
+    }
+    
+    // Остальные файлы - после максимального ID (в порядке имен)
+    std::sort(rest.begin(), rest.end());
+    for (size_t i = 0; i < rest.size(); ++i) {
+        DocumentInfo doc;
+        doc.id = next_id++;
+        doc.path = rest[i];
+        documents.push_back(std::move(doc));
+    }
+    
+    return documents;
 }
 
-void BooleanIndex::build(const std::string& corpus_dir) {
-    Vector<std::string> files = FileUtils::list_files(corpus_dir);
+namespace {
+
+typedef std::chrono::steady_clock Clock;
+
+/**
+ * Длина числа в кодировке varint (7 бит на байт)
+ */
+size_t varint_size(int value) {
+    uint32_t v = static_cast<uint32_t>(value);
+    size_t bytes = 1;
+    while (v >= 0x80) {
+        v >>= 7;
+        ++bytes;
+    }
+    return bytes;
+}
+
+uint64_t nanoseconds_between(Clock::time_point from, Clock::time_point to) {
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(to - from).count());
+}
+
+/**
+ * Стоимость одного вызова Clock::now() (наименьшая из нескольких серий)
+ */
+double clock_overhead_ns() {
+    const int CALLS = 256;
+    double best = 0.0;
+    for (int round = 0; round < 8; ++round) {
+        Clock::time_point start = Clock::now();
+        for (int i = 0; i < CALLS - 1; ++i) {
+            Clock::now();
+        }
+        double per_call = static_cast<double>(nanoseconds_between(start, Clock::now())) / CALLS;
+        if (round == 0 || per_call < best) {
+            best = per_call;
+        }
+    }
+    return best;
+}
+
+/**
+ * Добавление прочитанного документа в хранилище
+ * 
+ * @return время записи, нс (стадия store, не входит в обработку)
+ */
+uint64_t store_document(DocStore::Writer& doc_store, int doc_id, std::string_view content) {
+    Clock::time_point start = Clock::now();
+    doc_store.add(doc_id, content);
+    return nanoseconds_between(start, Clock::now());
+}
+
+/**
+ * Время обработки документов для BuildStats: всего и по выборке
+ * (в выборке стемминг и вставка замерены отдельно)
+ */
+struct ProcessingTime {
+    uint64_t total_ns;
+    uint64_t sampled_ns;
+    uint64_t sampled_stem_ns;
+    uint64_t sampled_insert_ns;
+    uint64_t sampled_tokens;
     
-    std::cout << "Построение индекса из " << files.size() << " документов" << std::endl;
+    ProcessingTime() : total_ns(0), sampled_ns(0), sampled_stem_ns(0), sampled_insert_ns(0), sampled_tokens(0) {}
     
-    // Обработка каждого документа
-    for (size_t i = 0; i < files.size(); ++i) {
-        int doc_id = static_cast<int>(i + 1);
+    /**
+     * Распределение общего времени по стадиям в пропорции выборки
+     * 
+     * Из выборки вычитается стоимость самих замеров: три вызова часов
+     * на токен, по одному внутри интервалов стемминга и вставки.
+     */
+    void split(BooleanIndex::BuildStats& stats) const {
+        double clock_ns = clock_overhead_ns();
+        double overhead = clock_ns * sampled_tokens;
+        double sampled = std::max(0.0, sampled_ns - 3.0 * overhead);
+        double stem = std::max(0.0, sampled_stem_ns - overhead);
+        double insert = std::max(0.0, sampled_insert_ns - overhead);
         
-        if ((i + 1) % 100 == 0) {
-            std::cout << "Индексировано документов: " << (i + 1) << std::endl;
+        double stem_share = 0.0;
+        double insert_share = 0.0;
+        if (sampled > 0.0) {
+            stem_share = std::min(1.0, stem / sampled);
+            insert_share = std::min(1.0 - stem_share, insert / sampled);
+        }
+        double total = total_ns / 1e9;
+        stats.stage_seconds[BooleanIndex::BuildStats::STAGE_STEM] = total * stem_share;
+        stats.stage_seconds[BooleanIndex::BuildStats::STAGE_INSERT] = total * insert_share;
+        stats.stage_seconds[BooleanIndex::BuildStats::STAGE_TOKENIZE] = total * (1.0 - stem_share - insert_share);
+    }
+};
+
+/**
+ * Вывод прогресса построения
+ * 
+ * Без интервала - строка на каждые 100 документов, с интервалом -
+ * не чаще раза в interval секунд, со скоростью и оценкой оставшегося времени,
+ * с отрицательным интервалом - без вывода.
+ */
+class BuildProgress {
+public:
+    BuildProgress(size_t total_documents, double interval)
+        : total_(total_documents), interval_(interval), start_(Clock::now()), last_(start_) {}
+    
+    void update(size_t done, uint64_t bytes) {
+        if (interval_ < 0.0) {
+            return;
+        }
+        if (interval_ == 0.0) {
+            if (done % 100 == 0) {
+                std::cout << "Индексировано документов: " << done << std::endl;
+            }
+            return;
         }
         
-        std::string content = FileUtils::read_file(files[i]);
-        if (content.empty()) {
-            continue;
+        Clock::time_point now = Clock::now();
+        if (nanoseconds_between(last_, now) < interval_ * 1e9) {
+            return;
         }
+        last_ = now;
         
-        add_document(doc_id, content);
+        double elapsed = nanoseconds_between(start_, now) / 1e9;
+        double fraction = total_ > 0 ? static_cast<double>(done) / total_ : 1.0;
+        double remaining = done > 0 ? elapsed * (total_ - done) / done : 0.0;
+        std::cout << "Индексировано документов: " << done << "/" << total_
+                  << " (" << static_cast<int>(fraction * 1000) / 10.0 << "%), "
+                  << static_cast<int>(bytes / elapsed / 1e5) / 10.0 << " МБ/с, "
+                  << "осталось ~" << static_cast<int>(remaining * 10 + 0.5) / 10.0 << " с" << std::endl;
     }
     
-    std::cout << "Индекс построен. Уникальных слов: " << index_.get_size() << std::endl;
+private:
+    size_t total_;
+    double interval_;
+    Clock::time_point start_;
+    Clock::time_point last_;
+};
+
 }
 
-void BooleanIndex::add_document(int doc_id, const std::string& content) {
-    // Токенизация текста
-    std::vector<std::string> tokens = Tokenizer::tokenize(content);
+const char* BooleanIndex::BuildStats::stage_name(int stage) {
+    static const char* const NAMES[STAGE_COUNT] = {"enumerate", "read", "tokenize", "stem", "insert", "store"};
+    return stage >= 0 && stage < STAGE_COUNT ? NAMES[stage] : "";
+}
+
+BooleanIndex::BuildStats::BuildStats()
+    : total_seconds(0.0), documents(0), sampled_documents(0), bytes_read(0), tokens(0) {
+    for (int i = 0; i < STAGE_COUNT; ++i) {
+        stage_seconds[i] = 0.0;
+    }
+}
+
+void BooleanIndex::build(const std::string& corpus_dir, const ReadAheadReader::Options& read_ahead,
+                         double progress_interval, DocStore::Writer* doc_store) {
+    build_range(corpus_dir, std::numeric_limits<int>::min(), std::numeric_limits<int>::max(),
+                read_ahead, progress_interval, doc_store);
+}
+
+void BooleanIndex::build_range(const std::string& corpus_dir, int first_id, int last_id,
+                               const ReadAheadReader::Options& read_ahead, double progress_interval,
+                               DocStore::Writer* doc_store) {
+    if (CorpusPack::is_pack(corpus_dir)) {
+        build_from_pack(corpus_dir, first_id, last_id, progress_interval, doc_store);
+        return;
+    }
     
-    // Множество уникальных слов в документе
-    Set<std::string> unique_words;
+    build_stats_ = BuildStats();
+    uint64_t tokens_before = total_tokens_;
+    Clock::time_point build_start = Clock::now();
     
-    // Обработка каждого токена
-    for (size_t i = 0; i < tokens.size(); ++i) {
-        // Стемминг
-        std::string stemmed = Stemmer::stem(tokens[i]);
-        if (!stemmed.empty()) {
-            unique_words.insert(stemmed);
+    Vector<std::string> files = FileUtils::list_files(corpus_dir);
+    
+    // ID известны заранее, файлы обрабатываются по возрастанию ID
+    Vector<DocumentInfo> all_documents = assign_document_ids(files);
+    Vector<DocumentInfo> documents;
+    Vector<std::string> paths;
+    for (size_t i = 0; i < all_documents.size(); ++i) {
+        if (all_documents[i].id >= first_id && all_documents[i].id <= last_id) {
+            paths.push_back(all_documents[i].path);
+            documents.push_back(std::move(all_documents[i]));
         }
     }
     
-    // Добавить слова в индекс
-    Vector<std::string> words;
-    unique_words.to_vector(words);
+    if (progress_interval >= 0.0) {
+        std::cout << "Построение индекса из " << documents.size() << " документов" << std::endl;
+    }
     
-    for (size_t i = 0; i < words.size(); ++i) {
-        const std::string& word = words[i];
+    Clock::time_point wait_start = Clock::now();
+    build_stats_.stage_seconds[BuildStats::STAGE_ENUMERATE] = nanoseconds_between(build_start, wait_start) / 1e9;
+    
+    // Обработка каждого документа (файлы приходят в порядке списка)
+    ReadAheadReader reader(paths, read_ahead);
+    BuildProgress progress(documents.size(), progress_interval);
+    ProcessingTime processing;
+    uint64_t read_ns = 0;
+    uint64_t store_ns = 0;
+    uint64_t streamed_bytes = 0;
+    while (const ReadAheadReader::Item* item = reader.next()) {
+        Clock::time_point ready = Clock::now();
+        read_ns += nanoseconds_between(wait_start, ready);
         
-        // Проверить, есть ли уже это слово в индексе
-        Vector<int> doc_list;
-        index_.find(word, doc_list);
+        size_t i = item->index;
+        const DocumentInfo& doc = documents[i];
+        bool sampled = false;
+        uint64_t document_store_ns = 0;
         
-        // Добавить doc_id в список (если его еще нет)
-        bool found = false;
-        for (size_t j = 0; j < doc_list.size(); ++j) {
-            if (doc_list[j] == doc_id) {
-                found = true;
-                break;
+        if (item->status == ReadAheadReader::READ_OK) {
+            if (i % STAGE_SAMPLE_EVERY == 0) {
+                uint64_t stem_ns = 0;
+                uint64_t insert_ns = 0;
+                processing.sampled_tokens += add_document_sampled(doc.id, item->data, stem_ns, insert_ns);
+                processing.sampled_stem_ns += stem_ns;
+                processing.sampled_insert_ns += insert_ns;
+                ++build_stats_.sampled_documents;
+                sampled = true;
+            } else {
+                add_document(doc.id, item->data);
+            }
+            register_document(doc.id, doc.path);
+            ++build_stats_.documents;
+            if (doc_store != nullptr) {
+                document_store_ns = store_document(*doc_store, doc.id, item->data);
             }
+        } else if (item->status == ReadAheadReader::READ_TOO_LARGE) {
+            // Большой файл - потоковое чтение (время чтения входит в обработку)
+            if (add_document_file(doc.id, doc.path)) {
+                streamed_bytes += item->file_size;
+                ++build_stats_.documents;
+                if (doc_store != nullptr) {
+                    // Хранилищу нужен текст целиком - файл отображается еще раз
+                    Clock::time_point store_start = Clock::now();
+                    FileUtils::MappedFile file;
+                    if (file.open(doc.path)) {
+                        doc_store->add(doc.id, std::string_view(file.data(), file.size()));
+                    }
+                    document_store_ns = nanoseconds_between(store_start, Clock::now());
+                }
+            }
+        }
+        
+        wait_start = Clock::now();
+        store_ns += document_store_ns;
+        uint64_t document_ns = nanoseconds_between(ready, wait_start) - document_store_ns;
+        processing.total_ns += document_ns;
+        if (sampled) {
+            processing.sampled_ns += document_ns;
+        }
+        
+        progress.update(i + 1, reader.bytes_read() + streamed_bytes);
+    }
+    
+    sort_attributes();
+    build_stats_.stage_seconds[BuildStats::STAGE_READ] = read_ns / 1e9;
+    build_stats_.stage_seconds[BuildStats::STAGE_STORE] = store_ns / 1e9;
+    processing.split(build_stats_);
+    build_stats_.bytes_read = reader.bytes_read() + streamed_bytes;
+    build_stats_.tokens = total_tokens_ - tokens_before;
+    build_stats_.total_seconds = nanoseconds_between(build_start, Clock::now()) / 1e9;
+    
+    if (progress_interval >= 0.0) {
+        std::cout << "Индекс построен. Уникальных слов: " << dictionary_.size() - field_terms_ << std::endl;
+    }
+}
+
+void BooleanIndex::build_from_pack(const std::string& pack_path, int first_id, int last_id,
+                                   double progress_interval, DocStore::Writer* doc_store) {
+    build_stats_ = BuildStats();
+    uint64_t tokens_before = total_tokens_;
+    Clock::time_point build_start = Clock::now();
+    
+    CorpusPack pack;
+    if (!pack.open(pack_path)) {
+        std::cerr << "Ошибка открытия пакета корпуса: " << pack_path << std::endl;
+        return;
+    }
+    
+    // Документы диапазона: в пакетах pack_corpus и gen_corpus они идут
+    // подряд (по возрастанию ID), поэтому обход - от первого до последнего
+    size_t begin = pack.size();
+    size_t end = 0;
+    size_t total = 0;
+    for (size_t i = 0; i < pack.size(); ++i) {
+        int id = pack.document(i).id;
+        if (id >= first_id && id <= last_id) {
+            begin = std::min(begin, i);
+            end = i + 1;
+            ++total;
+        }
+    }
+    
+    if (progress_interval >= 0.0) {
+        std::cout << "Построение индекса из " << total << " документов (пакет)" << std::endl;
+    }
+    
+    Clock::time_point stage_start = Clock::now();
+    build_stats_.stage_seconds[BuildStats::STAGE_ENUMERATE] = nanoseconds_between(build_start, stage_start) / 1e9;
+    
+    // Чтение - это запросы страниц и обращения к отображенному файлу,
+    // отдельно замеряется только prefetch
+    BuildProgress progress(total, progress_interval);
+    ProcessingTime processing;
+    uint64_t read_ns = 0;
+    uint64_t store_ns = 0;
+    size_t done = 0;
+    for (size_t i = begin; i < end; ++i) {
+        // Страницы следующих документов запрашиваются заранее
+        if ((i - begin) % CorpusPack::PREFETCH_DOCUMENTS == 0) {
+            pack.prefetch(i + CorpusPack::PREFETCH_DOCUMENTS, CorpusPack::PREFETCH_DOCUMENTS);
+            Clock::time_point prefetched = Clock::now();
+            read_ns += nanoseconds_between(stage_start, prefetched);
+            stage_start = prefetched;
         }
         
-        if (!found) {
-            doc_list.push_back(doc_id);
-            index_.insert(word, doc_list);
+        CorpusPack::Document doc = pack.document(i);
+        if (doc.id < first_id || doc.id > last_id) {
+            continue;
+        }
+        bool sampled = done % STAGE_SAMPLE_EVERY == 0;
+        if (sampled) {
+            uint64_t stem_ns = 0;
+            uint64_t insert_ns = 0;
+            processing.sampled_tokens += add_document_sampled(doc.id, doc.content, stem_ns, insert_ns);
+            processing.sampled_stem_ns += stem_ns;
+            processing.sampled_insert_ns += insert_ns;
+            ++build_stats_.sampled_documents;
         } else {
-            // Уже есть, обновить список (хотя он не изменился)
-            index_.insert(word, doc_list);
+            add_document(doc.id, doc.content);
         }
+        register_document(doc.id, std::string(doc.name));
+        ++build_stats_.documents;
+        build_stats_.bytes_read += doc.content.length();
+        uint64_t document_store_ns = 0;
+        if (doc_store != nullptr) {
+            document_store_ns = store_document(*doc_store, doc.id, doc.content);
+            store_ns += document_store_ns;
+        }
+        
+        Clock::time_point finished = Clock::now();
+        uint64_t document_ns = nanoseconds_between(stage_start, finished) - document_store_ns;
+        processing.total_ns += document_ns;
+        if (sampled) {
+            processing.sampled_ns += document_ns;
+        }
+        stage_start = finished;
+        
+        progress.update(++done, build_stats_.bytes_read);
     }
     
-    // Записать doc_id в множество документов
-    document_ids_.insert(doc_id);
+    sort_attributes();
+    build_stats_.stage_seconds[BuildStats::STAGE_READ] = read_ns / 1e9;
+    build_stats_.stage_seconds[BuildStats::STAGE_STORE] = store_ns / 1e9;
+    processing.split(build_stats_);
+    build_stats_.tokens = total_tokens_ - tokens_before;
+    build_stats_.total_seconds = nanoseconds_between(build_start, Clock::now()) / 1e9;
+    
+    if (progress_interval >= 0.0) {
+        std::cout << "Индекс построен. Уникальных слов: " << dictionary_.size() - field_terms_ << std::endl;
+    }
 }
 
-Vector<int> BooleanIndex::get_documents(const std::string& word) const {
-    // Применить стемминг к слову
-    std::string stemmed = Stemmer::stem(word);
+size_t BooleanIndex::find_document(int doc_id) const {
+    size_t left = 0;
+    size_t right = documents_.size();
+    while (left < right) {
+        size_t mid = left + (right - left) / 2;
+        if (documents_[mid].id < doc_id) {
+            left = mid + 1;
+        } else {
+            right = mid;
+        }
+    }
+    return left;
+}
+
+void BooleanIndex::register_document(int doc_id, const std::string& path) {
+    // Основной случай: документы добавляются по возрастанию ID
+    size_t pos = documents_.size();
+    if (!documents_.empty() && documents_.back().id >= doc_id) {
+        pos = find_document(doc_id);
+    }
+    
+    if (pos < documents_.size() && documents_[pos].id == doc_id) {
+        if (!path.empty()) {
+            documents_[pos].path = path;
+        }
+        return;
+    }
+    
+    DocumentInfo doc;
+    doc.id = doc_id;
+    doc.path = path;
+    documents_.push_back(std::move(doc));
+    for (size_t j = documents_.size() - 1; j > pos; --j) {
+        std::swap(documents_[j], documents_[j - 1]);
+    }
+}
+
+const char* BooleanIndex::field_name(int field) {
+    switch (field) {
+        case FIELD_TITLE: return "title";
+        case FIELD_URL: return "url";
+    }
+    return "";
+}
+
+std::string BooleanIndex::field_term(int field, std::string_view term) {
+    std::string result(1, FIELD_MARK);
+    result += field_name(field);
+    result += ':';
+    result.append(term.data(), term.length());
+    return result;
+}
+
+int BooleanIndex::parse_field(const std::string& word, std::string& rest) {
+    size_t colon = word.find(':');
+    if (colon == std::string::npos || colon == 0) {
+        return -1;
+    }
+    for (int field = 0; field < FIELD_COUNT; ++field) {
+        std::string_view name = field_name(field);
+        if (name.length() != colon) {
+            continue;
+        }
+        bool same = true;
+        for (size_t i = 0; i < colon && same; ++i) {
+            same = std::tolower(static_cast<unsigned char>(word[i])) == name[i];
+        }
+        if (same) {
+            rest = word.substr(colon + 1);
+            return field;
+        }
+    }
+    return -1;
+}
+
+const char* BooleanIndex::attribute_name(int attribute) {
+    switch (attribute) {
+        case ATTR_WORDS: return "words";
+    }
+    return "";
+}
+
+namespace {
+
+/**
+ * Целое число на всю строку (без пробелов и лишних символов)
+ */
+bool parse_int64(const std::string& text, int64_t& value) {
+    if (text.empty()) {
+        return false;
+    }
+    char* end = nullptr;
+    errno = 0;
+    long long parsed = std::strtoll(text.c_str(), &end, 10);
+    if (errno != 0 || end != text.c_str() + text.length() || std::isspace(static_cast<unsigned char>(text[0]))) {
+        return false;
+    }
+    value = parsed;
+    return true;
+}
+
+}
+
+bool BooleanIndex::parse_range(const std::string& word, Range& range) {
+    size_t colon = word.find(':');
+    if (colon == std::string::npos || colon == 0) {
+        return false;
+    }
+    int attribute = -1;
+    for (int a = 0; a < ATTR_COUNT && attribute < 0; ++a) {
+        std::string_view name = attribute_name(a);
+        bool same = name.length() == colon;
+        for (size_t i = 0; i < colon && same; ++i) {
+            same = std::tolower(static_cast<unsigned char>(word[i])) == name[i];
+        }
+        if (same) {
+            attribute = a;
+        }
+    }
+    if (attribute < 0) {
+        return false;
+    }
     
-    Vector<int> doc_list;
-    index_.find(stemmed, doc_list);  // Получить список (может быть пустым)
+    const int64_t min = std::numeric_limits<int64_t>::min();
+    const int64_t max = std::numeric_limits<int64_t>::max();
+    std::string condition = word.substr(colon + 1);
+    if (condition.empty()) {
+        return false;
+    }
+    int64_t value = 0;
+    range.attribute = attribute;
+    if (condition.compare(0, 2, ">=") == 0 || condition.compare(0, 2, "<=") == 0) {
+        if (!parse_int64(condition.substr(2), value)) {
+            return false;
+        }
+        range.low = condition[0] == '>' ? value : min;
+        range.high = condition[0] == '>' ? max : value;
+        return true;
+    }
+    if (condition[0] == '>' || condition[0] == '<') {
+        if (!parse_int64(condition.substr(1), value)) {
+            return false;
+        }
+        // Строгое неравенство; >max и <min - пустой диапазон (low > high)
+        if (condition[0] == '>') {
+            range.low = value == max ? max : value + 1;
+            range.high = value == max ? min : max;
+        } else {
+            range.high = value == min ? min : value - 1;
+            range.low = value == min ? max : min;
+        }
+        return true;
+    }
+    size_t dots = condition.find("..");
+    if (dots != std::string::npos) {
+        return parse_int64(condition.substr(0, dots), range.low) &&
+               parse_int64(condition.substr(dots + 2), range.high);
+    }
+    if (!parse_int64(condition[0] == '=' ? condition.substr(1) : condition, value)) {
+        return false;
+    }
+    range.low = value;
+    range.high = value;
+    return true;
+}
+
+void BooleanIndex::set_attribute(int doc_id, int attribute, int64_t value) {
+    AttributeColumn& column = attributes_[attribute];
+    column.by_value.clear();
     
-    // Сортировка списка
-    if (doc_list.size() > 0) {
-        Sort<int>::quicksort(doc_list, compare_int);
+    // Основной случай: документы добавляются по возрастанию ID
+    size_t pos = column.doc_ids.size();
+    if (!column.doc_ids.empty() && column.doc_ids.back() >= doc_id) {
+        pos = static_cast<size_t>(std::lower_bound(column.doc_ids.begin(), column.doc_ids.end(), doc_id) -
+                                  column.doc_ids.begin());
+    }
+    if (pos < column.doc_ids.size() && column.doc_ids[pos] == doc_id) {
+        column.values[pos] = value;
+        return;
     }
     
-    return doc_list;
+    column.doc_ids.push_back(doc_id);
+    column.values.push_back(value);
+    for (size_t j = column.doc_ids.size() - 1; j > pos; --j) {
+        column.doc_ids[j] = column.doc_ids[j - 1];
+        column.values[j] = column.values[j - 1];
+    }
+    column.doc_ids[pos] = doc_id;
+    column.values[pos] = value;
+}
+
+void BooleanIndex::sort_attributes() {
+    for (int a = 0; a < ATTR_COUNT; ++a) {
+        AttributeColumn& column = attributes_[a];
+        column.by_value.resize(column.doc_ids.size());
+        for (size_t i = 0; i < column.by_value.size(); ++i) {
+            column.by_value[i] = static_cast<uint32_t>(i);
+        }
+        // Равные значения - по возрастанию ID
+        const Vector<int64_t>& values = column.values;
+        std::stable_sort(column.by_value.begin(), column.by_value.end(), [&values](uint32_t a, uint32_t b) {
+            return values[a] < values[b];
+        });
+    }
+}
+
+namespace {
+
+/**
+ * Границы условия в порядке по значению: [from, to)
+ */
+void value_bounds(const BooleanIndex::AttributeColumn& column, const BooleanIndex::Range& range,
+                  const uint32_t*& from, const uint32_t*& to) {
+    const Vector<int64_t>& values = column.values;
+    from = std::lower_bound(column.by_value.begin(), column.by_value.end(), range.low,
+                            [&values](uint32_t pos, int64_t value) { return values[pos] < value; });
+    to = std::upper_bound(from, column.by_value.end(), range.high,
+                          [&values](int64_t value, uint32_t pos) { return value < values[pos]; });
+}
+
+}
+
+size_t BooleanIndex::count_range(const Range& range) const {
+    const AttributeColumn& column = attributes_[range.attribute];
+    if (range.low > range.high) {
+        return 0;
+    }
+    if (column.by_value.size() == column.doc_ids.size()) {
+        const uint32_t* from;
+        const uint32_t* to;
+        value_bounds(column, range, from, to);
+        return static_cast<size_t>(to - from);
+    }
+    
+    // Порядок не построен (документы добавлялись после построения) - просмотр
+    size_t count = 0;
+    for (size_t i = 0; i < column.values.size(); ++i) {
+        if (column.values[i] >= range.low && column.values[i] <= range.high) {
+            ++count;
+        }
+    }
+    return count;
+}
+
+Vector<int> BooleanIndex::find_range(const Range& range, int first_id, int last_id) const {
+    const AttributeColumn& column = attributes_[range.attribute];
+    Vector<int> result;
+    if (range.low > range.high) {
+        return result;
+    }
+    size_t begin = static_cast<size_t>(std::lower_bound(column.doc_ids.begin(), column.doc_ids.end(), first_id) -
+                                       column.doc_ids.begin());
+    size_t end = last_id == std::numeric_limits<int>::max() ? column.doc_ids.size() :
+        static_cast<size_t>(std::upper_bound(column.doc_ids.begin() + begin, column.doc_ids.end(), last_id) -
+                            column.doc_ids.begin());
+    
+    // Немного подходящих документов - сортировка их ID дешевле просмотра столбца
+    if (column.by_value.size() == column.doc_ids.size()) {
+        const uint32_t* from;
+        const uint32_t* to;
+        value_bounds(column, range, from, to);
+        size_t ratio = RANGE_SCAN_RATIO;
+        if (static_cast<size_t>(to - from) * ratio < end - begin) {
+            for (const uint32_t* pos = from; pos < to; ++pos) {
+                if (*pos >= begin && *pos < end) {
+                    result.push_back(column.doc_ids[*pos]);
+                }
+            }
+            std::sort(result.begin(), result.end());
+            return result;
+        }
+    }
+    
+    for (size_t i = begin; i < end; ++i) {
+        if (column.values[i] >= range.low && column.values[i] <= range.high) {
+            result.push_back(column.doc_ids[i]);
+        }
+    }
+    return result;
+}
+
+uint32_t BooleanIndex::find_term(const std::string& word) const {
+    std::string rest;
+    int field = parse_field(word, rest);
+    if (field < 0) {
+        return dictionary_.find(StemCache::local().stem(word));
+    }
+    std::string stem = StemCache::local().stem(rest);
+    return stem.empty() ? TermDictionary::INVALID_ID : dictionary_.find(field_term(field, stem));
+}
+
+int BooleanIndex::get_document_frequency(const std::string& word) const {
+    uint32_t term_id = find_term(word);
+    return term_id == TermDictionary::INVALID_ID ? 0 : static_cast<int>(postings_[term_id].size());
+}
+
+int BooleanIndex::get_collection_frequency(const std::string& word) const {
+    uint32_t term_id = find_term(word);
+    return term_id == TermDictionary::INVALID_ID ? 0 : collection_frequencies_[term_id];
+}
+
+std::string BooleanIndex::get_document_path(int doc_id) const {
+    size_t pos = find_document(doc_id);
+    if (pos < documents_.size() && documents_[pos].id == doc_id) {
+        return documents_[pos].path;
+    }
+    return std::string();
+}
+
+void BooleanIndex::add_posting(Vector<int>& doc_list, int doc_id) {
+    // Основной случай: документы добавляются по возрастанию doc_id
+    if (doc_list.empty() || doc_list.back() < doc_id) {
+        compressed_postings_bytes_ += varint_size(doc_id - (doc_list.empty() ? 0 : doc_list.back()));
+        doc_list.push_back(doc_id);
+        ++total_postings_;
+        return;
+    }
+    
+    // Бинарный поиск позиции вставки
+    size_t left = 0;
+    size_t right = doc_list.size();
+    while (left < right) {
+        size_t mid = left + (right - left) / 2;
+        if (doc_list[mid] < doc_id) {
+            left = mid + 1;
+        } else {
+            right = mid;
+        }
+    }
+    
+    if (doc_list[left] == doc_id) {
+        return;  // Уже есть
+    }
+    
+    // Разность с соседом справа делится на две
+    int prev = left > 0 ? doc_list[left - 1] : 0;
+    compressed_postings_bytes_ += varint_size(doc_id - prev) + varint_size(doc_list[left] - doc_id);
+    compressed_postings_bytes_ -= varint_size(doc_list[left] - prev);
+    ++total_postings_;
+    
+    doc_list.push_back(doc_id);
+    for (size_t j = doc_list.size() - 1; j > left; --j) {
+        doc_list[j] = doc_list[j - 1];
+    }
+    doc_list[left] = doc_id;
+}
+
+void BooleanIndex::add_token(int doc_id, std::string_view token, StemCache& stem_cache) {
+    std::string_view stemmed = token.substr(0, stem_cache.stem_length(token));
+    if (!stemmed.empty()) {
+        add_term(doc_id, stemmed);
+    }
+}
+
+uint32_t BooleanIndex::intern_term(std::string_view term) {
+    uint32_t term_id = dictionary_.intern(term);
+    if (postings_.size() <= term_id && is_field_term(term)) {
+        ++field_terms_;
+    }
+    while (postings_.size() <= term_id) {
+        postings_.push_back(Vector<int>());
+        collection_frequencies_.push_back(0);
+    }
+    return term_id;
+}
+
+void BooleanIndex::add_term(int doc_id, std::string_view term) {
+    uint32_t term_id = intern_term(term);
+    ++collection_frequencies_[term_id];
+    ++total_tokens_;
+    
+    // Повтор слова в том же документе - список уже заканчивается на doc_id
+    Vector<int>& doc_list = postings_[term_id];
+    if (doc_list.empty() || doc_list.back() != doc_id) {
+        add_posting(doc_list, doc_id);
+    }
+}
+
+void BooleanIndex::add_field_term(int doc_id, std::string_view term) {
+    // Только постинг: вхождения в поля - повтор слов текста, в частоты
+    // и счетчик вхождений (total_tokens_) не входят
+    Vector<int>& doc_list = postings_[intern_term(term)];
+    if (doc_list.empty() || doc_list.back() != doc_id) {
+        add_posting(doc_list, doc_id);
+    }
+}
+
+void BooleanIndex::add_field(int doc_id, int field, std::string_view text, StemCache& stem_cache) {
+    std::string term = field_term(field, std::string_view());
+    size_t prefix = term.length();
+    Tokenizer::for_each_token(text.data(), text.length(), [this, doc_id, &stem_cache, &term, prefix](std::string_view token) {
+        size_t stem_length = stem_cache.stem_length(token);
+        if (stem_length > 0) {
+            term.resize(prefix);
+            term.append(token.data(), stem_length);
+            add_field_term(doc_id, term);
+        }
+    });
+}
+
+void BooleanIndex::add_fields(int doc_id, std::string_view content, StemCache& stem_cache) {
+    DocStore::Metadata metadata;
+    DocStore::parse_header(content, metadata);
+    add_field(doc_id, FIELD_TITLE, metadata.title, stem_cache);
+    
+    // URL токенизатор оставил бы одним токеном: части адреса (хост, путь)
+    // разделяются по знакам препинания ASCII
+    std::string url(metadata.url);
+    for (size_t i = 0; i < url.length(); ++i) {
+        unsigned char c = static_cast<unsigned char>(url[i]);
+        if (c < 0x80 && !std::isalnum(c)) {
+            url[i] = ' ';
+        }
+    }
+    add_field(doc_id, FIELD_URL, url, stem_cache);
+    
+    if (metadata.word_count > 0) {
+        set_attribute(doc_id, ATTR_WORDS, metadata.word_count);
+    }
+}
+
+void BooleanIndex::add_document(int doc_id, std::string_view content) {
+    StemCache& stem_cache = StemCache::local();
+    add_fields(doc_id, content, stem_cache);
+    
+    Tokenizer::for_each_token(content.data(), content.length(), [this, doc_id, &stem_cache](std::string_view token) {
+        add_token(doc_id, token, stem_cache);
+    });
+    
+    // Записать документ в таблицу
+    register_document(doc_id, std::string());
+}
+
+size_t BooleanIndex::add_document_sampled(int doc_id, std::string_view content,
+                                          uint64_t& stem_ns, uint64_t& insert_ns) {
+    StemCache& stem_cache = StemCache::local();
+    size_t tokens = 0;
+    add_fields(doc_id, content, stem_cache);
+    
+    // Остаток времени документа (между вызовами) - токенизация
+    Tokenizer::for_each_token(content.data(), content.length(),
+                              [this, doc_id, &stem_cache, &stem_ns, &insert_ns, &tokens](std::string_view token) {
+        ++tokens;
+        Clock::time_point start = Clock::now();
+        std::string_view stemmed = token.substr(0, stem_cache.stem_length(token));
+        Clock::time_point stemmed_at = Clock::now();
+        if (!stemmed.empty()) {
+            add_term(doc_id, stemmed);
+        }
+        insert_ns += nanoseconds_between(stemmed_at, Clock::now());
+        stem_ns += nanoseconds_between(start, stemmed_at);
+    });
+    
+    register_document(doc_id, std::string());
+    return tokens;
+}
+
+bool BooleanIndex::add_document_file(int doc_id, const std::string& filepath) {
+    StemCache& stem_cache = StemCache::local();
+    
+    // Заголовок - в начале файла: поля по первому фрагменту
+    FileUtils::ChunkReader reader;
+    if (reader.open(filepath)) {
+        std::string head(DocStore::HEADER_MAX_BYTES, '\0');
+        size_t filled = 0;
+        while (filled < head.length()) {
+            size_t read = reader.read(&head[filled], head.length() - filled);
+            if (read == 0) {
+                break;
+            }
+            filled += read;
+        }
+        add_fields(doc_id, std::string_view(head.data(), filled), stem_cache);
+    }
+    
+    bool ok = Tokenizer::tokenize_file(filepath, [this, doc_id, &stem_cache](std::string_view token) {
+        add_token(doc_id, token, stem_cache);
+    });
+    
+    if (ok) {
+        register_document(doc_id, filepath);
+    }
+    return ok;
+}
+
+Vector<int> BooleanIndex::get_documents(const std::string& word) const {
+    Range range;
+    if (parse_range(word, range)) {
+        return find_range(range, std::numeric_limits<int>::min(), std::numeric_limits<int>::max());
+    }
+    
+    // Стемминг и поиск в словаре
+    uint32_t term_id = find_term(word);
+    if (term_id == TermDictionary::INVALID_ID) {
+        return Vector<int>();
+    }
+    
+    // Списки хранятся отсортированными
+    return postings_[term_id];
 }
 
 void BooleanIndex::save(const std::string& filepath) const {
-    std::ofstream out(filepath);
+    // Запись во временный файл и замена: процесс поиска, перечитывающий
+    // индекс, не увидит недописанный файл
+    std::string temporary = FileUtils::temporary_path(filepath);
+    std::ofstream out(temporary);
     if (!out.is_open()) {
         std::cerr << "Ошибка открытия файла для записи: " << filepath << std::endl;
         return;
     }
     
-    Vector<std::string> keys;
-    index_.get_keys(keys);
+    // Таблица документов: строки-директивы начинаются с '#'
+    // (токен не может начинаться со знака препинания)
+    for (size_t i = 0; i < documents_.size(); ++i) {
+        out << "#DOC\t" << documents_[i].id << "\t" << documents_[i].path << "\n";
+    }
     
-    for (size_t i = 0; i < keys.size(); ++i) {
-        const std::string& word = keys[i];
-        Vector<int> doc_list;
-        
-        index_.find(word, doc_list);  // Получить список
+    // Атрибуты: #ATTR\t<имя>\tid:значение,id:значение,...
+    for (int a = 0; a < ATTR_COUNT; ++a) {
+        const AttributeColumn& column = attributes_[a];
+        if (column.doc_ids.empty()) {
+            continue;
+        }
+        out << "#ATTR\t" << attribute_name(a) << "\t";
+        for (size_t i = 0; i < column.doc_ids.size(); ++i) {
+            if (i > 0) out << ",";
+            out << column.doc_ids[i] << ":" << column.values[i];
+        }
+        out << "\n";
+    }
+    
+    for (uint32_t term_id = 0; term_id < dictionary_.size(); ++term_id) {
+        const Vector<int>& doc_list = postings_[term_id];
         
-        out << word << "\t";
+        out << dictionary_.term(term_id) << "\t";
         
         for (size_t j = 0; j < doc_list.size(); ++j) {
             if (j > 0) out << ",";
             out << doc_list[j];
         }
+        
+        // Частота в коллекции - третий столбец (старый загрузчик его не читает)
+        if (has_collection_frequencies_) {
+            out << "\t" << collection_frequencies_[term_id];
+        }
         out << "\n";
     }
     
     out.close();
+    if (!out || !FileUtils::replace_file(temporary, filepath)) {
+        std::remove(temporary.c_str());
+        std::cerr << "Ошибка записи файла: " << filepath << std::endl;
+    }
 }
 
 void BooleanIndex::load(const std::string& filepath) {
@@ -134,61 +983,195 @@ void BooleanIndex::load(const std::string& filepath) {
         return;
     }
     
-    index_.clear();
-    document_ids_.clear();
+    reset();
+    
+    // Индексы старого формата без таблицы: ID документов собираются из постингов
+    Vector<int> posting_doc_ids;
     
     std::string line;
     while (std::getline(in, line)) {
         if (line.empty()) continue;
         
-        // Разделить по табуляции
+        if (line[0] == '#') {
+            // Директива: #DOC\t<id>\t<путь> (неизвестные пропускаются)
+            if (line.compare(0, 5, "#DOC\t") == 0) {
+                size_t path_pos = line.find('\t', 5);
+                const char* id_start = line.c_str() + 5;
+                const char* id_end = path_pos == std::string::npos ? line.c_str() + line.length()
+                                                                   : line.c_str() + path_pos;
+                char* next;
+                errno = 0;
+                long doc_id = std::strtol(id_start, &next, 10);
+                if (next == id_start || next != id_end || errno == ERANGE || doc_id < 1 ||
+                    doc_id > std::numeric_limits<int>::max()) {
+                    std::cerr << "Ошибка формата индекса " << filepath << ": " << line << std::endl;
+                    reset();
+                    return;
+                }
+                register_document(static_cast<int>(doc_id),
+                                  path_pos == std::string::npos ? std::string() : line.substr(path_pos + 1));
+            } else if (line.compare(0, 6, "#ATTR\t") == 0) {
+                load_attribute(line);
+            }
+            continue;
+        }
+        
+        // Строка терма: слово \t id,id,... [\t частота в коллекции]
         size_t tab_pos = line.find('\t');
         if (tab_pos == std::string::npos) continue;
         
-        std::string word = line.substr(0, tab_pos);
-        std::string doc_list_str = line.substr(tab_pos + 1);
+        uint32_t term_id = intern_term(std::string_view(line.data(), tab_pos));
+        Vector<int>& doc_list = postings_[term_id];
         
         // Разобрать список ID
-        Vector<int> doc_list;
-        std::stringstream ss(doc_list_str);
-        std::string id_str;
-        
-        while (std::getline(ss, id_str, ',')) {
-            if (!id_str.empty()) {
-                int doc_id = std::stoi(id_str);
-                doc_list.push_back(doc_id);
-                document_ids_.insert(doc_id);
+        const char* p = line.c_str() + tab_pos + 1;
+        const char* end = line.c_str() + line.length();
+        while (p < end && *p != '\t') {
+            if (*p == ',') {
+                ++p;
+                continue;
+            }
+            char* next;
+            long doc_id = std::strtol(p, &next, 10);
+            if (next == p) {
+                break;
+            }
+            p = next;
+            
+            add_posting(doc_list, static_cast<int>(doc_id));
+            if (documents_.empty()) {
+                posting_doc_ids.push_back(static_cast<int>(doc_id));
             }
         }
         
-        index_.insert(word, doc_list);
+        if (p < end && *p == '\t') {
+            collection_frequencies_[term_id] = static_cast<int>(std::strtol(p + 1, nullptr, 10));
+            if (!is_field_term(dictionary_.term(term_id))) {
+                total_tokens_ += collection_frequencies_[term_id];
+            }
+            has_collection_frequencies_ = true;
+        }
     }
     
+    if (documents_.empty() && !posting_doc_ids.empty()) {
+        std::sort(posting_doc_ids.begin(), posting_doc_ids.end());
+        for (size_t i = 0; i < posting_doc_ids.size(); ++i) {
+            if (i == 0 || posting_doc_ids[i] != posting_doc_ids[i - 1]) {
+                register_document(posting_doc_ids[i], std::string());
+            }
+        }
+    }
+    
+    sort_attributes();
     in.close();
 }
 
+void BooleanIndex::reset() {
+    dictionary_.clear();
+    postings_ = Vector<Vector<int>>();
+    collection_frequencies_ = Vector<int>();
+    has_collection_frequencies_ = false;
+    documents_ = Vector<DocumentInfo>();
+    total_postings_ = 0;
+    total_tokens_ = 0;
+    compressed_postings_bytes_ = 0;
+    field_terms_ = 0;
+    for (int a = 0; a < ATTR_COUNT; ++a) {
+        attributes_[a] = AttributeColumn();
+    }
+}
+
+void BooleanIndex::load_attribute(const std::string& line) {
+    size_t name_pos = 6;
+    size_t values_pos = line.find('\t', name_pos);
+    if (values_pos == std::string::npos) {
+        return;
+    }
+    std::string_view name(line.data() + name_pos, values_pos - name_pos);
+    int attribute = -1;
+    for (int a = 0; a < ATTR_COUNT; ++a) {
+        if (name == attribute_name(a)) {
+            attribute = a;
+        }
+    }
+    if (attribute < 0) {
+        return;  // атрибут более новой версии
+    }
+    
+    const char* p = line.c_str() + values_pos + 1;
+    while (*p != '\0') {
+        if (*p == ',') {
+            ++p;
+            continue;
+        }
+        char* next;
+        long doc_id = std::strtol(p, &next, 10);
+        if (next == p || *next != ':') {
+            break;
+        }
+        p = next + 1;
+        long long value = std::strtoll(p, &next, 10);
+        if (next == p) {
+            break;
+        }
+        p = next;
+        set_attribute(static_cast<int>(doc_id), attribute, value);
+    }
+}
+
 BooleanIndex::IndexStats BooleanIndex::get_stats() const {
     IndexStats stats;
-    stats.total_words = index_.get_size();
-    stats.total_documents = document_ids_.size();
+    stats.total_words = dictionary_.size() - field_terms_;
+    stats.field_terms = field_terms_;
+    stats.attribute_values = attributes_[ATTR_WORDS].doc_ids.size();
+    stats.total_documents = documents_.size();
+    stats.total_postings = total_postings_;
+    stats.total_tokens = total_tokens_;
+    
+    MemoryStats& memory = stats.memory;
+    memory.dictionary_hash_bytes = dictionary_.hash_table_bytes();
+    memory.dictionary_bytes = dictionary_.memory_bytes() - memory.dictionary_hash_bytes;
+    
+    memory.postings_bytes = 0;
+    for (size_t i = 0; i < postings_.size(); ++i) {
+        memory.postings_bytes += postings_[i].capacity() * sizeof(int);
+    }
+    memory.postings_raw_bytes = total_postings_ * sizeof(int);
+    memory.postings_compressed_bytes = compressed_postings_bytes_;
+    memory.postings_overhead_bytes = postings_.capacity() * sizeof(Vector<int>);
+    memory.frequencies_bytes = collection_frequencies_.capacity() * sizeof(int);
     
-    size_t total_postings = 0;
-    Vector<std::string> keys;
-    index_.get_keys(keys);
+    // Короткие пути хранятся внутри std::string (SSO), длинные - в куче
+    memory.document_table_bytes = documents_.capacity() * sizeof(DocumentInfo);
+    for (size_t i = 0; i < documents_.size(); ++i) {
+        const std::string& path = documents_[i].path;
+        if (path.capacity() > std::string().capacity()) {
+            memory.document_table_bytes += path.capacity() + 1;
+        }
+    }
     
-    for (size_t i = 0; i < keys.size(); ++i) {
-        Vector<int> doc_list;
-        index_.find(keys[i], doc_list);
-        total_postings += doc_list.size();
+    memory.attributes_bytes = 0;
+    for (int a = 0; a < ATTR_COUNT; ++a) {
+        const AttributeColumn& column = attributes_[a];
+        memory.attributes_bytes += column.doc_ids.capacity() * sizeof(int) +
+                                   column.values.capacity() * sizeof(int64_t) +
+                                   column.by_value.capacity() * sizeof(uint32_t);
     }
     
-    stats.total_postings = total_postings;
+    memory.stem_cache_bytes = StemCache::total_memory_bytes();
+    memory.total_bytes = memory.dictionary_bytes + memory.dictionary_hash_bytes +
+                         memory.postings_bytes + memory.postings_overhead_bytes +
+                         memory.frequencies_bytes + memory.document_table_bytes +
+                         memory.attributes_bytes + memory.stem_cache_bytes;
     
     return stats;
 }
 
 Vector<std::string> BooleanIndex::get_all_words() const {
     Vector<std::string> words;
-    index_.get_keys(words);
+    words.reserve(dictionary_.size());
+    for (uint32_t term_id = 0; term_id < dictionary_.size(); ++term_id) {
+        words.push_back(std::string(dictionary_.term(term_id)));
+    }
     return words;
 }
@@ -1,40 +1,224 @@
 #ifndef BOOLEAN_INDEX_H
 #define BOOLEAN_INDEX_H
 
+#include <cstdint>
 #include <string>
+#include <string_view>
 #include "../utils/vector.h"
 #include "../utils/map.h"
-#include "../utils/set.h"
+#include "../utils/term_dictionary.h"
+#include "../utils/read_ahead.h"
+#include "doc_store.h"
 
-// TODO: Заменить std::map и std::vector на собственные структуры данных
+class StemCache;
 
 /**
  * Лабораторная работа 6: Булев индекс
  * Инвертированный индекс для булева поиска
  * 
- * Структура: слово -> список ID документов, содержащих это слово
+ * Структура: слово -> term id (через TermDictionary) -> отсортированный
+ * список ID документов, содержащих это слово, и частота в коллекции
  */
 class BooleanIndex {
 public:
+    BooleanIndex()
+        : has_collection_frequencies_(true), total_postings_(0), total_tokens_(0), compressed_postings_bytes_(0),
+          field_terms_(0) {}
+    
+    /**
+     * Поля заголовка краулера с отдельными постингами
+     * 
+     * Слова строк TITLE: и URL: дополнительно индексируются как термы
+     * поля ("@title:основа" - токен не начинается со знака препинания,
+     * поэтому с термами текста они не совпадают). Запрос title:слово
+     * читает только короткий список поля, а не фильтрует результаты по
+     * всему тексту. Термы без поля по-прежнему покрывают весь документ
+     * (поиск без поля - по любому полю).
+     */
+    enum Field {
+        FIELD_TITLE,
+        FIELD_URL,
+        FIELD_COUNT
+    };
+    
+    static const char FIELD_MARK = '@';
+    
+    /**
+     * Имя поля в запросе ("title", "url")
+     */
+    static const char* field_name(int field);
+    
+    /**
+     * Терм поля в словаре по основе слова
+     */
+    static std::string field_term(int field, std::string_view term);
+    
+    static bool is_field_term(std::string_view term) {
+        return !term.empty() && term[0] == FIELD_MARK;
+    }
+    
+    /**
+     * Поле слова запроса "поле:слово" (имя поля без учета регистра)
+     * 
+     * @param word слово запроса
+     * @param rest слово без имени поля
+     * @return номер поля или -1, если поле не указано
+     */
+    static int parse_field(const std::string& word, std::string& rest);
+    
+    /**
+     * Числовые атрибуты документов (столбцы значений)
+     * 
+     * Значение поля заголовка краулера (WORDS: - длина документа в словах)
+     * хранится столбцом по ID документа, а для диапазонных условий
+     * words:>5000 - еще и порядком документов по значению: число
+     * подходящих документов находится двумя бинарными поисками, а сами
+     * документы - без просмотра всего столбца, если их немного.
+     * Документы без поля в столбец не попадают и условиям не удовлетворяют.
+     */
+    enum Attribute {
+        ATTR_WORDS,
+        ATTR_COUNT
+    };
+    
+    /**
+     * Имя атрибута в запросе ("words")
+     */
+    static const char* attribute_name(int attribute);
+    
+    /**
+     * Диапазонное условие на атрибут: low <= значение <= high
+     */
+    struct Range {
+        int attribute;
+        int64_t low;
+        int64_t high;
+    };
+    
+    /**
+     * Столбец атрибута
+     */
+    struct AttributeColumn {
+        Vector<int> doc_ids;       // по возрастанию
+        Vector<int64_t> values;    // значение документа doc_ids[i]
+        Vector<uint32_t> by_value; // позиции столбца по возрастанию значения
+                                   // (пустой - не построен после изменений)
+    };
+    
+    /**
+     * Разбор условия "атрибут:условие": words:>N, words:>=N, words:<N,
+     * words:<=N, words:N (или =N), words:A..B (включительно)
+     * 
+     * @return false, если слово - не условие на атрибут
+     */
+    static bool parse_range(const std::string& word, Range& range);
+    
+    /**
+     * Документ корпуса: ID и путь к файлу
+     */
+    struct DocumentInfo {
+        int id;
+        std::string path;  // пустой, если документ добавлен не из файла
+    };
+    
+    /**
+     * Назначение ID файлам корпуса
+     * 
+     * Для файлов doc_NNNNN.txt ID берется из имени (так же ищет документы
+     * веб-интерфейс), остальные файлы нумеруются по порядку после
+     * максимального ID. Результат не зависит от порядка readdir
+     * и известен до начала индексации.
+     * 
+     * @param files список файлов (как из FileUtils::list_files)
+     * @return документы, отсортированные по ID
+     */
+    static Vector<DocumentInfo> assign_document_ids(const Vector<std::string>& files);
+    
     /**
      * Построение индекса из корпуса документов
      * 
-     * @param corpus_dir директория с документами
+     * Файлы читаются заранее фоновыми потоками (ReadAheadReader),
+     * пока основной поток токенизирует предыдущие. Вместо директории
+     * можно передать упакованный корпус (CorpusPack) - он читается
+     * через mmap, ID документов берутся из таблицы пакета.
+     * 
+     * @param corpus_dir директория с документами или файл пакета
+     * @param read_ahead параметры упреждающего чтения
+     * @param progress_interval период вывода прогресса с оценкой оставшегося
+     *        времени, секунд (0 - строка на каждые 100 документов,
+     *        отрицательный - без вывода)
+     * @param doc_store хранилище документов, в которое добавляются прочитанные
+     *        документы (nullptr - без хранилища; finish - за вызывающим)
      */
-    void build(const std::string& corpus_dir);
+    void build(const std::string& corpus_dir,
+               const ReadAheadReader::Options& read_ahead = ReadAheadReader::Options(),
+               double progress_interval = 0.0, DocStore::Writer* doc_store = nullptr);
+    
+    /**
+     * Построение индекса по части корпуса - документам с ID в [first_id, last_id]
+     * (сегмент распределенного индекса, см. ShardedIndex)
+     */
+    void build_range(const std::string& corpus_dir, int first_id, int last_id,
+                     const ReadAheadReader::Options& read_ahead = ReadAheadReader::Options(),
+                     double progress_interval = 0.0, DocStore::Writer* doc_store = nullptr);
+    
+    /**
+     * Статистика последнего построения по стадиям
+     * 
+     * Чтение - время ожидания следующего файла (с упреждающим чтением -
+     * только та часть, что не перекрылась с обработкой). Токенизация,
+     * стемминг и вставка чередуются на каждом токене, поэтому поэтапно
+     * замеряется только каждый STAGE_SAMPLE_EVERY-й документ, а общее
+     * время обработки остальных делится в той же пропорции.
+     */
+    struct BuildStats {
+        enum Stage {
+            STAGE_ENUMERATE,  // список файлов и назначение ID
+            STAGE_READ,
+            STAGE_TOKENIZE,
+            STAGE_STEM,
+            STAGE_INSERT,     // словарь термов, постинги, таблица документов
+            STAGE_STORE,      // запись в хранилище документов (сжатие блоков)
+            STAGE_COUNT
+        };
+        
+        static const char* stage_name(int stage);
+        
+        double stage_seconds[STAGE_COUNT];
+        double total_seconds;
+        size_t documents;
+        size_t sampled_documents;  // документов с поэтапным замером
+        uint64_t bytes_read;
+        uint64_t tokens;           // токенов после стемминга (непустых)
+        
+        BuildStats();
+    };
+    
+    const BuildStats& get_build_stats() const {
+        return build_stats_;
+    }
     
     /**
      * Добавление документа в индекс
      * 
      * @param doc_id идентификатор документа
-     * @param content содержимое документа
+     * @param content содержимое документа (например, отображенный в память файл)
+     */
+    void add_document(int doc_id, std::string_view content);
+    
+    /**
+     * Добавление документа из файла (потоковое чтение, память не зависит от размера файла)
+     * 
+     * @param doc_id идентификатор документа
+     * @param filepath путь к файлу
+     * @return false, если файл не удалось открыть
      */
-    void add_document(int doc_id, const std::string& content);
+    bool add_document_file(int doc_id, const std::string& filepath);
     
     /**
      * Получение списка ID документов для слова
      * 
-     * @param word слово
+     * @param word слово или условие на атрибут (words:>5000)
      * @return список ID документов (пустой, если слова нет в индексе)
      */
     Vector<int> get_documents(const std::string& word) const;
@@ -49,17 +233,119 @@ public:
     /**
      * Загрузка индекса из файла
      * 
+     * Поврежденная таблица документов - сообщение об ошибке и пустой
+     * индекс, как при ошибке открытия файла.
+     * 
      * @param filepath путь к файлу
      */
     void load(const std::string& filepath);
     
+    /**
+     * Документная частота слова (число документов, где оно встречается)
+     */
+    int get_document_frequency(const std::string& word) const;
+    
+    /**
+     * Частота слова в коллекции (общее число вхождений)
+     * 
+     * 0 для индексов старого формата (см. has_collection_frequencies)
+     */
+    int get_collection_frequency(const std::string& word) const;
+    
+    /**
+     * Известны ли частоты в коллекции (индекс построен или загружен из файла с ними)
+     */
+    bool has_collection_frequencies() const {
+        return has_collection_frequencies_;
+    }
+    
+    /**
+     * Словарь термов и частоты в коллекции по term id
+     * (для анализа Ципфа по индексу без повторной токенизации)
+     */
+    const TermDictionary& get_dictionary() const {
+        return dictionary_;
+    }
+    
+    const Vector<int>& get_collection_frequencies() const {
+        return collection_frequencies_;
+    }
+    
+    /**
+     * Term id слова после стемминга (TermDictionary::INVALID_ID, если слова нет);
+     * "title:слово" - терм поля
+     */
+    uint32_t find_term(const std::string& word) const;
+    
+    /**
+     * Список документов по term id (без стемминга и копирования)
+     */
+    const Vector<int>& get_postings(uint32_t term_id) const {
+        return postings_[term_id];
+    }
+    
+    const AttributeColumn& get_attribute_column(int attribute) const {
+        return attributes_[attribute];
+    }
+    
+    /**
+     * Число документов, удовлетворяющих условию (O(log n) по порядку значений)
+     */
+    size_t count_range(const Range& range) const;
+    
+    /**
+     * Документы с ID в [first_id, last_id], удовлетворяющие условию
+     * (по возрастанию ID): при малом числе подходящих - по порядку
+     * значений с сортировкой, иначе просмотром столбца
+     */
+    Vector<int> find_range(const Range& range, int first_id, int last_id) const;
+    
+    /**
+     * Путь к файлу документа (пустая строка, если документ неизвестен
+     * или добавлен не из файла)
+     */
+    std::string get_document_path(int doc_id) const;
+    
+    /**
+     * Таблица документов, отсортированная по ID
+     */
+    const Vector<DocumentInfo>& get_document_table() const {
+        return documents_;
+    }
+    
+    /**
+     * Память, занимаемая компонентами индекса, в байтах
+     * 
+     * Учитывается выделенная емкость (capacity), а не только занятая часть.
+     */
+    struct MemoryStats {
+        size_t dictionary_bytes;          // арена строк и таблица термов
+        size_t dictionary_hash_bytes;     // хеш-таблица словаря
+        size_t postings_bytes;            // списки документов (емкость)
+        size_t postings_raw_bytes;        // из них занято (4 байта на запись)
+        size_t postings_compressed_bytes; // оценка в varint-дельтах (без выравнивания)
+        size_t postings_overhead_bytes;   // заголовки списков (Vector на терм)
+        size_t frequencies_bytes;         // частоты в коллекции
+        size_t document_table_bytes;      // таблица документов с путями
+        size_t attributes_bytes;          // столбцы атрибутов с порядком по значению
+        size_t stem_cache_bytes;          // кеши стемминга всех потоков
+        size_t total_bytes;
+    };
+    
     /**
      * Получение статистики индекса
+     * 
+     * Счетчики поддерживаются при добавлении (O(1)), разбивка памяти
+     * проходит по заголовкам списков (O(числа термов), без копирования).
      */
     struct IndexStats {
-        size_t total_words;      // Количество уникальных слов
+        size_t total_words;      // Количество уникальных слов (без термов полей)
+        size_t field_terms;      // Термов полей заголовка (title:, url:)
+        size_t attribute_values; // Документов со значением атрибута (WORDS:)
         size_t total_documents;  // Количество документов
         size_t total_postings;   // Общее количество записей
+        uint64_t total_tokens;   // Вхождений слов (сумма частот в коллекции)
+        MemoryStats memory;
     };
     
     IndexStats get_stats() const;
@@ -70,11 +356,114 @@ public:
     Vector<std::string> get_all_words() const;
 
 private:
-    // Инвертированный индекс: слово -> список ID документов
-    Map<std::string, Vector<int>> index_;
+    /**
+     * Добавление нормализованного токена документа (стемминг -> term id -> постинг)
+     */
+    void add_token(int doc_id, std::string_view token, StemCache& stem_cache);
+    
+    /**
+     * Добавление терма (уже после стемминга) в словарь и постинги
+     */
+    void add_term(int doc_id, std::string_view term);
+    
+    /**
+     * Термы полей из заголовка краулера в начале документа
+     */
+    void add_fields(int doc_id, std::string_view content, StemCache& stem_cache);
+    
+    void add_field(int doc_id, int field, std::string_view text, StemCache& stem_cache);
+    
+    /**
+     * Постинг терма поля (без частоты в коллекции и счетчика вхождений)
+     */
+    void add_field_term(int doc_id, std::string_view term);
+    
+    /**
+     * Значение атрибута документа (порядок по значению сбрасывается)
+     */
+    void set_attribute(int doc_id, int attribute, int64_t value);
+    
+    /**
+     * Построение порядка по значению для всех столбцов (после построения
+     * или загрузки индекса)
+     */
+    void sort_attributes();
+    
+    /**
+     * Сброс к пустому индексу (перед загрузкой и при ошибке разбора)
+     */
+    void reset();
+    
+    /**
+     * Разбор директивы #ATTR сохраненного индекса
+     */
+    void load_attribute(const std::string& line);
+    
+    /**
+     * Term id по слову из словаря; новые термы полей учитываются в field_terms_
+     */
+    uint32_t intern_term(std::string_view term);
+    
+    /**
+     * add_document с раздельным замером стемминга и вставки (для BuildStats)
+     * 
+     * @return число токенов документа
+     */
+    size_t add_document_sampled(int doc_id, std::string_view content,
+                                uint64_t& stem_ns, uint64_t& insert_ns);
+    
+    /**
+     * Построение индекса из упакованного корпуса (документы с ID в [first_id, last_id])
+     */
+    void build_from_pack(const std::string& pack_path, int first_id, int last_id, double progress_interval,
+                         DocStore::Writer* doc_store);
+    
+    /**
+     * Запись документа в таблицу (путь обновляется, если задан)
+     */
+    void register_document(int doc_id, const std::string& path);
+    
+    /**
+     * Позиция документа в таблице (или позиция для вставки)
+     */
+    size_t find_document(int doc_id) const;
+    
+    /**
+     * Добавление doc_id в список (с сохранением сортировки и без дубликатов)
+     * с учетом в счетчиках постингов
+     */
+    void add_posting(Vector<int>& doc_list, int doc_id);
+    
+    // Словарь термов: слово -> term id
+    TermDictionary dictionary_;
+    
+    // Инвертированный индекс: term id -> отсортированный список ID документов
+    Vector<Vector<int>> postings_;
+    
+    // Частота в коллекции: term id -> число вхождений (с повторами в документе)
+    Vector<int> collection_frequencies_;
+    bool has_collection_frequencies_;
+    
+    // Счетчики для get_stats: записей, вхождений, размер постингов в varint-дельтах
+    size_t total_postings_;
+    uint64_t total_tokens_;
+    size_t compressed_postings_bytes_;
+    size_t field_terms_;
+    
+    // Таблица документов: ID -> путь (отсортирована по ID, сохраняется в индексе)
+    Vector<DocumentInfo> documents_;
+    
+    // Числовые атрибуты документов
+    AttributeColumn attributes_[ATTR_COUNT];
+    
+    // Каждый какой документ замеряется поэтапно при построении
+    static const size_t STAGE_SAMPLE_EVERY = 16;
+    
+    // find_range: подходящих документов должно быть во столько раз меньше
+    // просматриваемой части столбца, чтобы их ID собирались по порядку значений
+    static const size_t RANGE_SCAN_RATIO = 8;
     
-    // Множество ID документов (для статистики)
-    Set<int> document_ids_;
+    BuildStats build_stats_;
 };
 
 #endif // BOOLEAN_INDEX_H
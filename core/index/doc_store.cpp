@@ -0,0 +1,460 @@
+#include "doc_store.h"
+#include "../utils/block_codec.h"
+#include <algorithm>
+#include <cctype>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+
+const char DocStore::MAGIC[8] = {'M', 'A', 'I', 'D', 'O', 'C', 'S', '1'};
+
+namespace {
+
+// Разделитель заголовка краулера и текста
+const size_t SEPARATOR_LENGTH = 80;
+
+/**
+ * Значение поля заголовка ("TITLE: ..."), пустое, если поля нет
+ */
+std::string_view header_field(std::string_view header, std::string_view name) {
+    size_t pos = 0;
+    while (pos < header.length()) {
+        size_t end = header.find('\n', pos);
+        if (end == std::string_view::npos) {
+            end = header.length();
+        }
+        std::string_view line = header.substr(pos, end - pos);
+        if (line.length() > name.length() && line.compare(0, name.length(), name) == 0 &&
+            line[name.length()] == ':') {
+            std::string_view value = line.substr(name.length() + 1);
+            while (!value.empty() && (value.front() == ' ' || value.front() == '\t')) {
+                value.remove_prefix(1);
+            }
+            while (!value.empty() && (value.back() == ' ' || value.back() == '\r')) {
+                value.remove_suffix(1);
+            }
+            return value;
+        }
+        pos = end + 1;
+    }
+    return std::string_view();
+}
+
+/**
+ * Позиция текста после строки-разделителя из '=' (npos, если ее нет)
+ */
+size_t body_start(std::string_view content) {
+    const std::string separator(SEPARATOR_LENGTH, '=');
+    // Документ без заголовка не просматривается целиком
+    size_t limit = DocStore::HEADER_MAX_BYTES;
+    size_t pos = content.substr(0, std::min(content.length(), limit + SEPARATOR_LENGTH)).find(separator);
+    if (pos == std::string_view::npos || (pos > 0 && content[pos - 1] != '\n')) {
+        return std::string_view::npos;
+    }
+    pos += SEPARATOR_LENGTH;
+    while (pos < content.length() && content[pos] == '=') {
+        ++pos;
+    }
+    return pos;
+}
+
+}
+
+DocStore::Writer::Writer()
+    : file_(nullptr), offset_(0), block_size_(DEFAULT_BLOCK_SIZE), raw_bytes_(0), failed_(false) {
+}
+
+DocStore::Writer::~Writer() {
+    // Незавершенная запись - временный файл не нужен
+    if (file_ != nullptr) {
+        fclose(file_);
+        std::remove(temporary_.c_str());
+    }
+}
+
+bool DocStore::Writer::write(const void* data, size_t length) {
+    if (length > 0 && fwrite(data, 1, length, file_) != length) {
+        return false;
+    }
+    offset_ += length;
+    return true;
+}
+
+bool DocStore::Writer::open(const std::string& path, size_t block_size) {
+    // Хранилище пишется рядом и заменяет старое в finish(): отображенный
+    // в память старый файл остается целым у тех, кто его читает
+    path_ = path;
+    temporary_ = FileUtils::temporary_path(path);
+    file_ = fopen(temporary_.c_str(), "wb");
+    if (file_ == nullptr) {
+        return false;
+    }
+    block_size_ = std::max<size_t>(block_size, 1);
+    block_.reserve(block_size_ * 2);
+
+    // Заголовок перезаписывается в finish(), когда известны таблицы
+    Header header;
+    std::memset(&header, 0, sizeof(header));
+    offset_ = 0;
+    return write(&header, sizeof(header));
+}
+
+bool DocStore::Writer::add(int doc_id, std::string_view content) {
+    Metadata metadata;
+    std::string_view text = parse_header(content, metadata);
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (failed_) {
+        return false;
+    }
+
+    Entry entry;
+    std::memset(&entry, 0, sizeof(entry));
+    entry.doc_id = doc_id;
+    entry.block = static_cast<uint32_t>(blocks_.size());
+    entry.offset = static_cast<uint32_t>(block_.length());
+    entry.length = static_cast<uint32_t>(text.length());
+    entry.title_offset = strings_.length();
+    entry.title_length = static_cast<uint32_t>(metadata.title.length());
+    entry.url_length = static_cast<uint32_t>(metadata.url.length());
+    entry.word_count = metadata.word_count;
+
+    strings_.append(metadata.title.data(), metadata.title.length());
+    strings_.append(metadata.url.data(), metadata.url.length());
+    block_.append(text.data(), text.length());
+    raw_bytes_ += text.length();
+    entries_.push_back(entry);
+
+    // Документ не делится между блоками: блок закрывается после него
+    if (block_.length() >= block_size_ && !flush_block()) {
+        failed_ = true;
+    }
+    return !failed_;
+}
+
+bool DocStore::Writer::flush_block() {
+    if (block_.empty()) {
+        return true;
+    }
+    compressed_.clear();
+    BlockCodec::compress(block_.data(), block_.length(), compressed_);
+
+    BlockEntry block;
+    block.offset = offset_;
+    block.length = static_cast<uint32_t>(compressed_.length());
+    block.raw_length = static_cast<uint32_t>(block_.length());
+    blocks_.push_back(block);
+    block_.clear();
+    return write(compressed_.data(), compressed_.length());
+}
+
+bool DocStore::Writer::finish() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (file_ == nullptr) {
+        return false;
+    }
+    bool ok = !failed_ && flush_block();
+
+    std::sort(entries_.begin(), entries_.end(),
+              [](const Entry& a, const Entry& b) { return a.doc_id < b.doc_id; });
+
+    // Слоты - если ID не слишком разрежены (не больше двух слотов на документ)
+    Vector<uint32_t> slots;
+    if (!entries_.empty()) {
+        uint64_t range = static_cast<uint64_t>(static_cast<int64_t>(entries_.back().doc_id) - entries_[0].doc_id) + 1;
+        if (range <= 2 * static_cast<uint64_t>(entries_.size()) + 1024) {
+            slots.resize(static_cast<size_t>(range));
+            for (size_t i = 0; i < slots.size(); ++i) {
+                slots[i] = NO_SLOT;
+            }
+            for (size_t i = 0; i < entries_.size(); ++i) {
+                slots[static_cast<size_t>(static_cast<int64_t>(entries_[i].doc_id) - entries_[0].doc_id)] =
+                    static_cast<uint32_t>(i);
+            }
+        }
+    }
+
+    // Таблицы выравниваются на 8 байт
+    static const char padding[8] = {0};
+    ok = ok && write(padding, (8 - offset_ % 8) % 8);
+
+    Header header;
+    std::memset(&header, 0, sizeof(header));
+    std::memcpy(header.magic, MAGIC, sizeof(MAGIC));
+    header.version = VERSION;
+    header.block_size = static_cast<uint32_t>(block_size_);
+    header.document_count = entries_.size();
+    header.block_count = blocks_.size();
+    header.first_id = entries_.empty() ? 0 : entries_[0].doc_id;
+
+    header.blocks_offset = offset_;
+    ok = ok && write(blocks_.begin(), blocks_.size() * sizeof(BlockEntry));
+    header.table_offset = offset_;
+    ok = ok && write(entries_.begin(), entries_.size() * sizeof(Entry));
+    header.slots_offset = offset_;
+    header.slot_count = slots.size();
+    ok = ok && write(slots.begin(), slots.size() * sizeof(uint32_t));
+    header.strings_offset = offset_;
+    ok = ok && write(strings_.data(), strings_.length());
+
+    ok = ok && fseek(file_, 0, SEEK_SET) == 0 &&
+         fwrite(&header, 1, sizeof(header), file_) == sizeof(header);
+
+    ok = (fclose(file_) == 0) && ok;
+    file_ = nullptr;
+    if (!ok) {
+        std::remove(temporary_.c_str());
+        return false;
+    }
+    return FileUtils::replace_file(temporary_, path_);
+}
+
+DocStore::DocStore(size_t cache_blocks)
+    : blocks_(nullptr), entries_(nullptr), slots_(nullptr), strings_(nullptr),
+      block_count_(0), count_(0), slot_count_(0), first_id_(0),
+      cache_capacity_(std::max<size_t>(cache_blocks, 1)), clock_(0), cache_hits_(0), cache_misses_(0) {
+}
+
+std::string DocStore::path_for_index(const std::string& index_path) {
+    return index_path + ".docs";
+}
+
+bool DocStore::is_store(const std::string& path) {
+    std::ifstream in(path, std::ios::binary);
+    if (!in.is_open()) {
+        return false;
+    }
+
+    char magic[sizeof(MAGIC)];
+    if (!in.read(magic, sizeof(magic))) {
+        return false;
+    }
+    return std::memcmp(magic, MAGIC, sizeof(MAGIC)) == 0;
+}
+
+std::string_view DocStore::parse_header(std::string_view content, Metadata& metadata) {
+    metadata.title = std::string_view();
+    metadata.url = std::string_view();
+    metadata.word_count = 0;
+
+    size_t start = body_start(content);
+    if (start == std::string_view::npos) {
+        return content;
+    }
+    std::string_view header = content.substr(0, start);
+    metadata.title = header_field(header, "TITLE");
+    metadata.url = header_field(header, "URL");
+    std::string_view words = header_field(header, "WORDS");
+    for (size_t i = 0; i < words.length() && std::isdigit(static_cast<unsigned char>(words[i])); ++i) {
+        metadata.word_count = metadata.word_count * 10 + static_cast<uint32_t>(words[i] - '0');
+    }
+    return content.substr(start);
+}
+
+bool DocStore::open(const std::string& path) {
+    close();
+
+    if (!file_.open(path) || file_.size() < sizeof(Header)) {
+        file_.close();
+        return false;
+    }
+
+    Header header;
+    std::memcpy(&header, file_.data(), sizeof(header));
+
+    uint64_t size = file_.size();
+    if (std::memcmp(header.magic, MAGIC, sizeof(MAGIC)) != 0 || header.version != VERSION ||
+        header.blocks_offset % 8 != 0 || header.blocks_offset > size ||
+        header.block_count > (size - header.blocks_offset) / sizeof(BlockEntry) ||
+        header.table_offset != header.blocks_offset + header.block_count * sizeof(BlockEntry) ||
+        header.document_count > (size - header.table_offset) / sizeof(Entry) ||
+        header.slots_offset != header.table_offset + header.document_count * sizeof(Entry) ||
+        header.slot_count > (size - header.slots_offset) / sizeof(uint32_t) ||
+        header.strings_offset != header.slots_offset + header.slot_count * sizeof(uint32_t)) {
+        file_.close();
+        return false;
+    }
+
+    blocks_ = reinterpret_cast<const BlockEntry*>(file_.data() + header.blocks_offset);
+    entries_ = reinterpret_cast<const Entry*>(file_.data() + header.table_offset);
+    slots_ = reinterpret_cast<const uint32_t*>(file_.data() + header.slots_offset);
+    strings_ = file_.data() + header.strings_offset;
+    block_count_ = header.block_count;
+    count_ = header.document_count;
+    slot_count_ = header.slot_count;
+    first_id_ = header.first_id;
+
+    // Проверка границ, чтобы чтение обходилось без проверок
+    uint64_t strings_size = size - header.strings_offset;
+    for (size_t i = 0; i < block_count_; ++i) {
+        if (blocks_[i].offset > header.blocks_offset ||
+            blocks_[i].length > header.blocks_offset - blocks_[i].offset) {
+            close();
+            return false;
+        }
+    }
+    for (size_t i = 0; i < count_; ++i) {
+        const Entry& entry = entries_[i];
+        if (entry.block >= block_count_ || entry.offset > blocks_[entry.block].raw_length ||
+            entry.length > blocks_[entry.block].raw_length - entry.offset ||
+            entry.title_offset > strings_size ||
+            static_cast<uint64_t>(entry.title_length) + entry.url_length > strings_size - entry.title_offset ||
+            (i > 0 && entries_[i - 1].doc_id >= entry.doc_id)) {
+            close();
+            return false;
+        }
+    }
+    for (size_t i = 0; i < slot_count_; ++i) {
+        if (slots_[i] != NO_SLOT && slots_[i] >= count_) {
+            close();
+            return false;
+        }
+    }
+
+    // Таблицы нужны целиком сразу
+    file_.prefetch(static_cast<size_t>(header.blocks_offset), static_cast<size_t>(size - header.blocks_offset));
+    return true;
+}
+
+void DocStore::close() {
+    file_.close();
+    blocks_ = nullptr;
+    entries_ = nullptr;
+    slots_ = nullptr;
+    strings_ = nullptr;
+    block_count_ = 0;
+    count_ = 0;
+    slot_count_ = 0;
+    first_id_ = 0;
+    std::lock_guard<std::mutex> lock(mutex_);
+    cache_.clear();
+}
+
+size_t DocStore::find_entry(int doc_id) const {
+    if (count_ == 0) {
+        return count_;
+    }
+
+    int64_t slot = static_cast<int64_t>(doc_id) - first_id_;
+    if (slot_count_ > 0) {
+        if (slot < 0 || static_cast<uint64_t>(slot) >= slot_count_ || slots_[slot] == NO_SLOT) {
+            return count_;
+        }
+        return slots_[slot];
+    }
+
+    const Entry* it = std::lower_bound(entries_, entries_ + count_, doc_id,
+                                       [](const Entry& e, int id) { return e.doc_id < id; });
+    if (it == entries_ + count_ || it->doc_id != doc_id) {
+        return count_;
+    }
+    return static_cast<size_t>(it - entries_);
+}
+
+bool DocStore::metadata(int doc_id, Metadata& metadata) const {
+    size_t pos = find_entry(doc_id);
+    if (pos == count_) {
+        return false;
+    }
+    const Entry& entry = entries_[pos];
+    metadata.title = std::string_view(strings_ + entry.title_offset, entry.title_length);
+    metadata.url = std::string_view(strings_ + entry.title_offset + entry.title_length, entry.url_length);
+    metadata.word_count = entry.word_count;
+    return true;
+}
+
+const std::string* DocStore::load_block(uint32_t block) const {
+    ++clock_;
+    for (size_t i = 0; i < cache_.size(); ++i) {
+        if (cache_[i].block == block) {
+            cache_[i].last_used = clock_;
+            ++cache_hits_;
+            return &cache_[i].data;
+        }
+    }
+    ++cache_misses_;
+
+    // Место в кеше: свободное или давно не использованное
+    size_t slot = cache_.size();
+    if (cache_.size() < cache_capacity_) {
+        cache_.push_back(CachedBlock());
+    } else {
+        slot = 0;
+        for (size_t i = 1; i < cache_.size(); ++i) {
+            if (cache_[i].last_used < cache_[slot].last_used) {
+                slot = i;
+            }
+        }
+    }
+
+    CachedBlock& cached = cache_[slot];
+    const BlockEntry& entry = blocks_[block];
+    cached.data.resize(entry.raw_length);
+    if (!BlockCodec::decompress(file_.data() + entry.offset, entry.length, &cached.data[0], entry.raw_length)) {
+        // Место освобождается (такого номера блока нет)
+        cached.block = NO_SLOT;
+        cached.last_used = 0;
+        return nullptr;
+    }
+    cached.block = block;
+    cached.last_used = clock_;
+    return &cached.data;
+}
+
+void DocStore::fill_document(const Entry& entry, const std::string& block, Document& doc) const {
+    doc.id = entry.doc_id;
+    doc.found = true;
+    doc.title.assign(strings_ + entry.title_offset, entry.title_length);
+    doc.url.assign(strings_ + entry.title_offset + entry.title_length, entry.url_length);
+    doc.word_count = entry.word_count;
+    doc.text.assign(block.data() + entry.offset, entry.length);
+}
+
+bool DocStore::find(int doc_id, Document& doc) const {
+    size_t pos = find_entry(doc_id);
+    doc.id = doc_id;
+    doc.found = false;
+    if (pos == count_) {
+        return false;
+    }
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    const std::string* block = load_block(entries_[pos].block);
+    if (block == nullptr) {
+        return false;
+    }
+    fill_document(entries_[pos], *block, doc);
+    return true;
+}
+
+Vector<DocStore::Document> DocStore::fetch(const Vector<int>& doc_ids) const {
+    Vector<Document> documents;
+    documents.resize(doc_ids.size());
+
+    // Запросы группируются по блокам: (блок, позиция в doc_ids)
+    Vector<std::pair<uint32_t, size_t>> order;
+    order.reserve(doc_ids.size());
+    for (size_t i = 0; i < doc_ids.size(); ++i) {
+        documents[i].id = doc_ids[i];
+        documents[i].found = false;
+        documents[i].word_count = 0;
+        size_t pos = find_entry(doc_ids[i]);
+        if (pos != count_) {
+            order.push_back(std::make_pair(entries_[pos].block, i));
+        }
+    }
+    std::sort(order.begin(), order.end());
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    const std::string* block = nullptr;
+    for (size_t k = 0; k < order.size(); ++k) {
+        if (k == 0 || order[k].first != order[k - 1].first) {
+            block = load_block(order[k].first);
+        }
+        if (block != nullptr) {
+            size_t i = order[k].second;
+            fill_document(entries_[find_entry(doc_ids[i])], *block, documents[i]);
+        }
+    }
+    return documents;
+}
@@ -0,0 +1,266 @@
+#ifndef DOC_STORE_H
+#define DOC_STORE_H
+
+#include <cstdint>
+#include <cstdio>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include "../utils/file_utils.h"
+#include "../utils/vector.h"
+
+/**
+ * Хранилище документов рядом с индексом (<index>.docs)
+ *
+ * Для вывода результатов нужны текст документа и поля заголовка
+ * краулера (TITLE, URL, WORDS). Вместо чтения doc_*.txt по одному
+ * тексты документов (без заголовка) сжимаются блоками примерно
+ * по block_size байт (BlockCodec), а разобранные поля лежат в таблице
+ * фиксированной ширины - их можно получить без распаковки.
+ *
+ * Формат (порядок байт - как на машине, где создано хранилище):
+ *   заголовок    Header
+ *   блоки        сжатые блоки подряд
+ *   блоки        BlockEntry[block_count]
+ *   документы    Entry[document_count], отсортирована по ID документа
+ *   слоты        uint32_t[slot_count]: позиция в таблице документов
+ *                для ID first_id + i (NO_SLOT - нет документа)
+ *   строки       заголовки и URL подряд
+ *
+ * Документ по ID - за O(1) по таблице слотов (для сильно разреженных
+ * ID слотов нет, тогда бинарный поиск). Распакованные блоки держатся
+ * в небольшом кеше (вытесняется давно не использованный).
+ *
+ * Хранилище пишется при построении индекса, в том же проходе по
+ * корпусу (Writer передается в BooleanIndex::build).
+ */
+class DocStore {
+public:
+    static const char MAGIC[8];
+    static const uint32_t VERSION = 1;
+    static const uint32_t NO_SLOT = 0xFFFFFFFFu;
+
+    static const size_t DEFAULT_BLOCK_SIZE = 64 * 1024;
+    // Заголовок краулера ищется только в начале документа
+    static const size_t HEADER_MAX_BYTES = 64 * 1024;
+    static const size_t DEFAULT_CACHE_BLOCKS = 16;
+
+    struct Header {
+        char magic[8];
+        uint32_t version;
+        uint32_t block_size;
+        uint64_t document_count;
+        uint64_t block_count;
+        uint64_t blocks_offset;   // таблица блоков
+        uint64_t table_offset;    // таблица документов
+        uint64_t slots_offset;
+        uint64_t slot_count;
+        uint64_t strings_offset;
+        int32_t first_id;         // ID слота 0
+        uint32_t reserved;
+    };
+
+    struct BlockEntry {
+        uint64_t offset;          // начало сжатого блока в файле
+        uint32_t length;          // сжатая длина
+        uint32_t raw_length;      // длина после распаковки
+    };
+
+    struct Entry {
+        int32_t doc_id;
+        uint32_t block;
+        uint32_t offset;          // начало текста в распакованном блоке
+        uint32_t length;
+        uint64_t title_offset;    // в блоке строк, URL - сразу за заголовком
+        uint32_t title_length;
+        uint32_t url_length;
+        uint32_t word_count;      // из WORDS:, 0 - нет поля
+        uint32_t reserved;
+    };
+
+    /**
+     * Поля заголовка краулера
+     */
+    struct Metadata {
+        std::string_view title;
+        std::string_view url;
+        uint32_t word_count;
+    };
+
+    struct Document {
+        int id;
+        bool found;
+        std::string title;
+        std::string url;
+        uint32_t word_count;
+        std::string text;         // текст после заголовка
+    };
+
+    /**
+     * Статистика построения
+     */
+    struct BuildStats {
+        size_t documents;
+        size_t blocks;
+        uint64_t raw_bytes;       // тексты до сжатия
+        uint64_t file_bytes;      // размер файла хранилища
+        double seconds;           // добавление документов и finish (стадия store)
+    };
+
+    /**
+     * Запись хранилища (документы добавляются по одному, таблицы - в finish)
+     *
+     * add можно вызывать из нескольких потоков (сегменты строятся
+     * параллельно и пишут документы в одно хранилище).
+     */
+    class Writer {
+    public:
+        Writer();
+        ~Writer();
+
+        Writer(const Writer&) = delete;
+        Writer& operator=(const Writer&) = delete;
+
+        /**
+         * Начало записи (во временный файл; path заменяется в finish)
+         */
+        bool open(const std::string& path, size_t block_size = DEFAULT_BLOCK_SIZE);
+
+        /**
+         * Добавление документа (содержимое с заголовком краулера или без;
+         * ID должны быть уникальны, порядок - любой)
+         *
+         * @return false при ошибке записи (finish тогда тоже вернет false)
+         */
+        bool add(int doc_id, std::string_view content);
+
+        /**
+         * Сжатие последнего блока, запись таблиц и заголовка, закрытие файла
+         *
+         * @return false, если запись документа или таблиц не удалась
+         *         (старое хранилище тогда не заменяется)
+         */
+        bool finish();
+
+        size_t document_count() const { return entries_.size(); }
+        size_t block_count() const { return blocks_.size(); }
+        uint64_t raw_bytes() const { return raw_bytes_; }
+        uint64_t bytes_written() const { return offset_; }
+
+    private:
+        bool write(const void* data, size_t length);
+        bool flush_block();
+
+        std::string path_;
+        std::string temporary_;     // пишется до finish()
+        FILE* file_;
+        uint64_t offset_;
+        size_t block_size_;
+        std::string block_;         // текущий блок до сжатия
+        std::string compressed_;
+        uint64_t raw_bytes_;
+        Vector<BlockEntry> blocks_;
+        Vector<Entry> entries_;
+        std::string strings_;
+        bool failed_;               // ошибка записи в add
+        std::mutex mutex_;
+    };
+
+    explicit DocStore(size_t cache_blocks = DEFAULT_CACHE_BLOCKS);
+
+    DocStore(const DocStore&) = delete;
+    DocStore& operator=(const DocStore&) = delete;
+
+    /**
+     * Путь хранилища для индекса (файла или манифеста сегментов)
+     */
+    static std::string path_for_index(const std::string& index_path);
+
+    /**
+     * Является ли файл хранилищем (проверка сигнатуры)
+     */
+    static bool is_store(const std::string& path);
+
+    /**
+     * Разбор заголовка краулера (строки "ПОЛЕ: значение" до строки из '=',
+     * которая начинается в первых HEADER_MAX_BYTES байтах)
+     *
+     * @return текст после заголовка (весь документ, если заголовка нет)
+     */
+    static std::string_view parse_header(std::string_view content, Metadata& metadata);
+
+    /**
+     * Открытие хранилища (отображение в память и проверка таблиц)
+     */
+    bool open(const std::string& path);
+
+    void close();
+
+    size_t size() const { return count_; }
+    size_t block_count() const { return block_count_; }
+
+    /**
+     * Поля документа без распаковки текста
+     *
+     * @return false, если документа нет
+     */
+    bool metadata(int doc_id, Metadata& metadata) const;
+
+    /**
+     * Документ по ID
+     *
+     * @return false, если документа нет или блок поврежден
+     */
+    bool find(int doc_id, Document& doc) const;
+
+    /**
+     * Документы страницы результатов (в порядке doc_ids): каждый нужный
+     * блок распаковывается один раз
+     */
+    Vector<Document> fetch(const Vector<int>& doc_ids) const;
+
+    /**
+     * Счетчики кеша блоков
+     */
+    size_t cache_hits() const { return cache_hits_; }
+    size_t cache_misses() const { return cache_misses_; }
+
+private:
+    struct CachedBlock {
+        uint32_t block;
+        uint64_t last_used;
+        std::string data;
+    };
+
+    /**
+     * Позиция документа в таблице (count_, если нет)
+     */
+    size_t find_entry(int doc_id) const;
+
+    /**
+     * Распакованный блок из кеша (nullptr, если блок поврежден);
+     * вызывается под mutex_
+     */
+    const std::string* load_block(uint32_t block) const;
+
+    void fill_document(const Entry& entry, const std::string& block, Document& doc) const;
+
+    FileUtils::MappedFile file_;
+    const BlockEntry* blocks_;
+    const Entry* entries_;
+    const uint32_t* slots_;
+    const char* strings_;
+    size_t block_count_;
+    size_t count_;
+    size_t slot_count_;
+    int first_id_;
+
+    size_t cache_capacity_;
+    mutable std::mutex mutex_;
+    mutable Vector<CachedBlock> cache_;
+    mutable uint64_t clock_;
+    mutable size_t cache_hits_;
+    mutable size_t cache_misses_;
+};
+
+#endif // DOC_STORE_H
@@ -0,0 +1,296 @@
+#include "sharded_index.h"
+#include "../stemmer/stem_cache.h"
+#include "../utils/corpus_pack.h"
+#include "../utils/file_utils.h"
+#include "../utils/thread_pool.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <limits>
+#include <mutex>
+
+namespace {
+
+const char* const MANIFEST_HEADER = "#SHARDS\t";
+const char* const SHARD_DIRECTIVE = "#SHARD\t";
+
+/**
+ * ID всех документов корпуса по возрастанию (как их назначит build)
+ */
+Vector<int> corpus_document_ids(const std::string& corpus_dir) {
+    Vector<int> ids;
+    if (CorpusPack::is_pack(corpus_dir)) {
+        CorpusPack pack;
+        if (!pack.open(corpus_dir)) {
+            std::cerr << "Ошибка открытия пакета корпуса: " << corpus_dir << std::endl;
+            return ids;
+        }
+        ids.reserve(pack.size());
+        for (size_t i = 0; i < pack.size(); ++i) {
+            ids.push_back(pack.document(i).id);
+        }
+        std::sort(ids.begin(), ids.end());
+        return ids;
+    }
+
+    Vector<BooleanIndex::DocumentInfo> documents =
+        BooleanIndex::assign_document_ids(FileUtils::list_files(corpus_dir));
+    ids.reserve(documents.size());
+    for (size_t i = 0; i < documents.size(); ++i) {
+        ids.push_back(documents[i].id);
+    }
+    return ids;
+}
+
+std::string directory_of(const std::string& path) {
+    size_t slash = path.find_last_of('/');
+    return slash == std::string::npos ? std::string() : path.substr(0, slash + 1);
+}
+
+std::string file_name_of(const std::string& path) {
+    size_t slash = path.find_last_of('/');
+    return slash == std::string::npos ? path : path.substr(slash + 1);
+}
+
+void add_index_stats(BooleanIndex::IndexStats& total, const BooleanIndex::IndexStats& shard) {
+    total.total_documents += shard.total_documents;
+    total.total_postings += shard.total_postings;
+    total.total_tokens += shard.total_tokens;
+    total.attribute_values += shard.attribute_values;
+
+    BooleanIndex::MemoryStats& memory = total.memory;
+    memory.dictionary_bytes += shard.memory.dictionary_bytes;
+    memory.dictionary_hash_bytes += shard.memory.dictionary_hash_bytes;
+    memory.postings_bytes += shard.memory.postings_bytes;
+    memory.postings_raw_bytes += shard.memory.postings_raw_bytes;
+    memory.postings_compressed_bytes += shard.memory.postings_compressed_bytes;
+    memory.postings_overhead_bytes += shard.memory.postings_overhead_bytes;
+    memory.frequencies_bytes += shard.memory.frequencies_bytes;
+    memory.document_table_bytes += shard.memory.document_table_bytes;
+    memory.attributes_bytes += shard.memory.attributes_bytes;
+    memory.total_bytes += shard.memory.total_bytes - shard.memory.stem_cache_bytes;
+}
+
+BooleanIndex::IndexStats empty_stats() {
+    BooleanIndex::IndexStats stats;
+    stats.total_words = 0;
+    stats.field_terms = 0;
+    stats.attribute_values = 0;
+    stats.total_documents = 0;
+    stats.total_postings = 0;
+    stats.total_tokens = 0;
+    stats.memory = BooleanIndex::MemoryStats();
+    return stats;
+}
+
+/**
+ * Число уникальных слов и термов полей по объединенному словарю сегментов
+ */
+void set_term_counts(BooleanIndex::IndexStats& stats, const TermDictionary& all_terms) {
+    stats.field_terms = 0;
+    for (uint32_t id = 0; id < all_terms.size(); ++id) {
+        if (BooleanIndex::is_field_term(all_terms.term(id))) {
+            ++stats.field_terms;
+        }
+    }
+    stats.total_words = all_terms.size() - stats.field_terms;
+}
+
+}
+
+bool ShardedIndex::is_manifest(const std::string& path) {
+    std::ifstream in(path);
+    std::string line;
+    return in.is_open() && std::getline(in, line) && line.compare(0, 8, MANIFEST_HEADER) == 0;
+}
+
+bool ShardedIndex::build(const std::string& corpus_dir, const std::string& manifest_path,
+                         size_t shards, size_t threads, const ReadAheadReader::Options& read_ahead,
+                         double progress_interval, BuildSummary& summary, DocStore::Writer* doc_store) {
+    typedef std::chrono::steady_clock Clock;
+    Clock::time_point build_start = Clock::now();
+
+    summary.build = BooleanIndex::BuildStats();
+    summary.stats = empty_stats();
+    summary.save_seconds = 0.0;
+
+    Vector<int> ids = corpus_document_ids(corpus_dir);
+    if (ids.empty()) {
+        std::cerr << "Корпус пуст: " << corpus_dir << std::endl;
+        return false;
+    }
+    shards = std::max<size_t>(1, std::min(shards, ids.size()));
+
+    // Равное число документов в сегменте, границы - по ID
+    Vector<ShardInfo> info;
+    for (size_t i = 0; i < shards; ++i) {
+        size_t begin = i * ids.size() / shards;
+        size_t end = (i + 1) * ids.size() / shards;
+        ShardInfo shard;
+        shard.first_id = ids[begin];
+        shard.last_id = ids[end - 1];
+        shard.path = manifest_path + ".shard" + std::to_string(i);
+        info.push_back(shard);
+    }
+    summary.build.stage_seconds[BooleanIndex::BuildStats::STAGE_ENUMERATE] =
+        std::chrono::duration<double>(Clock::now() - build_start).count();
+
+    std::cout << "Построение " << shards << " сегментов из " << ids.size() << " документов" << std::endl;
+
+    // Словарь для подсчета уникальных слов по всем сегментам
+    TermDictionary all_terms;
+    std::mutex summary_mutex;
+    bool parallel = threads > 1 && shards > 1;
+
+    ThreadPool pool(parallel ? std::min(threads, shards) - 1 : 0);
+    pool.parallel_for(shards, [&](size_t i) {
+        const ShardInfo& shard = info[i];
+        BooleanIndex index;
+        // Строки прогресса параллельных сегментов перемешались бы
+        index.build_range(corpus_dir, shard.first_id, shard.last_id, read_ahead,
+                          parallel ? -1.0 : progress_interval, doc_store);
+
+        Clock::time_point save_start = Clock::now();
+        index.save(shard.path);
+        double save_seconds = std::chrono::duration<double>(Clock::now() - save_start).count();
+
+        BooleanIndex::IndexStats stats = index.get_stats();
+        const BooleanIndex::BuildStats& build = index.get_build_stats();
+
+        std::lock_guard<std::mutex> lock(summary_mutex);
+        std::cout << "Сегмент " << i << ": документы " << shard.first_id << "-" << shard.last_id
+                  << " (" << build.documents << "), уникальных слов: " << stats.total_words
+                  << " -> " << shard.path << std::endl;
+
+        for (int stage = 0; stage < BooleanIndex::BuildStats::STAGE_COUNT; ++stage) {
+            if (stage != BooleanIndex::BuildStats::STAGE_ENUMERATE) {
+                summary.build.stage_seconds[stage] += build.stage_seconds[stage];
+            }
+        }
+        summary.build.documents += build.documents;
+        summary.build.sampled_documents += build.sampled_documents;
+        summary.build.bytes_read += build.bytes_read;
+        summary.build.tokens += build.tokens;
+        summary.save_seconds += save_seconds;
+
+        add_index_stats(summary.stats, stats);
+        const TermDictionary& dictionary = index.get_dictionary();
+        for (uint32_t id = 0; id < dictionary.size(); ++id) {
+            all_terms.intern(dictionary.term(id));
+        }
+    });
+    set_term_counts(summary.stats, all_terms);
+    // Кеши всех потоков построения, одновременно существовавших
+    summary.stats.memory.stem_cache_bytes = StemCache::peak_memory_bytes();
+    summary.stats.memory.total_bytes += summary.stats.memory.stem_cache_bytes;
+
+    // Манифест заменяется последним, когда все сегменты уже записаны
+    std::string temporary = FileUtils::temporary_path(manifest_path);
+    std::ofstream out(temporary);
+    if (!out.is_open()) {
+        std::cerr << "Ошибка открытия файла для записи: " << manifest_path << std::endl;
+        return false;
+    }
+    out << MANIFEST_HEADER << shards << "\n";
+    for (size_t i = 0; i < info.size(); ++i) {
+        out << SHARD_DIRECTIVE << info[i].first_id << "\t" << info[i].last_id << "\t"
+            << file_name_of(info[i].path) << "\n";
+    }
+    out.close();
+    if (!out || !FileUtils::replace_file(temporary, manifest_path)) {
+        std::remove(temporary.c_str());
+        std::cerr << "Ошибка записи манифеста: " << manifest_path << std::endl;
+        return false;
+    }
+
+    // Время сохранения учитывается отдельно (save_seconds), как у одного индекса
+    summary.build.total_seconds =
+        std::chrono::duration<double>(Clock::now() - build_start).count() - summary.save_seconds;
+    if (summary.build.total_seconds < 0.0) {
+        summary.build.total_seconds = 0.0;
+    }
+    return true;
+}
+
+void ShardedIndex::load(const std::string& path) {
+    info_ = Vector<ShardInfo>();
+    shards_ = Vector<std::unique_ptr<BooleanIndex>>();
+
+    if (!is_manifest(path)) {
+        ShardInfo shard;
+        shard.first_id = std::numeric_limits<int>::min();
+        shard.last_id = std::numeric_limits<int>::max();
+        shard.path = path;
+        info_.push_back(shard);
+        shards_.push_back(std::unique_ptr<BooleanIndex>(new BooleanIndex()));
+        shards_.back()->load(path);
+        return;
+    }
+
+    std::ifstream in(path);
+    std::string directory = directory_of(path);
+    std::string line;
+    while (std::getline(in, line)) {
+        if (line.compare(0, 7, SHARD_DIRECTIVE) != 0) {
+            continue;
+        }
+        // #SHARD\t<первый ID>\t<последний ID>\t<файл>
+        size_t first_tab = line.find('\t', 7);
+        size_t second_tab = first_tab == std::string::npos ? first_tab : line.find('\t', first_tab + 1);
+        if (second_tab == std::string::npos) {
+            std::cerr << "Некорректная строка манифеста: " << line << std::endl;
+            continue;
+        }
+        ShardInfo shard;
+        shard.first_id = std::stoi(line.substr(7, first_tab - 7));
+        shard.last_id = std::stoi(line.substr(first_tab + 1, second_tab - first_tab - 1));
+        std::string file = line.substr(second_tab + 1);
+        shard.path = !file.empty() && file[0] == '/' ? file : directory + file;
+        info_.push_back(shard);
+    }
+
+    for (size_t i = 0; i < info_.size(); ++i) {
+        shards_.push_back(std::unique_ptr<BooleanIndex>(new BooleanIndex()));
+        shards_.back()->load(info_[i].path);
+    }
+}
+
+BooleanIndex::IndexStats ShardedIndex::get_stats() const {
+    if (shards_.size() == 1) {
+        return shards_[0]->get_stats();
+    }
+
+    BooleanIndex::IndexStats stats = empty_stats();
+    TermDictionary all_terms;
+    for (size_t i = 0; i < shards_.size(); ++i) {
+        add_index_stats(stats, shards_[i]->get_stats());
+        const TermDictionary& dictionary = shards_[i]->get_dictionary();
+        for (uint32_t id = 0; id < dictionary.size(); ++id) {
+            all_terms.intern(dictionary.term(id));
+        }
+    }
+    set_term_counts(stats, all_terms);
+    stats.memory.stem_cache_bytes = StemCache::total_memory_bytes();
+    stats.memory.total_bytes += stats.memory.stem_cache_bytes;
+    return stats;
+}
+
+std::string ShardedIndex::get_document_path(int doc_id) const {
+    // Последний сегмент с first_id <= doc_id
+    size_t left = 0;
+    size_t right = info_.size();
+    while (left < right) {
+        size_t middle = left + (right - left) / 2;
+        if (info_[middle].first_id <= doc_id) {
+            left = middle + 1;
+        } else {
+            right = middle;
+        }
+    }
+    if (left == 0) {
+        return std::string();
+    }
+    return shards_[left - 1]->get_document_path(doc_id);
+}
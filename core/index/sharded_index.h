@@ -0,0 +1,98 @@
+#ifndef SHARDED_INDEX_H
+#define SHARDED_INDEX_H
+
+#include <memory>
+#include <string>
+#include "boolean_index.h"
+#include "../utils/vector.h"
+
+/**
+ * Индекс, разбитый на сегменты по диапазонам ID документов
+ *
+ * Каждый сегмент - обычный файл BooleanIndex с документами своего
+ * диапазона, диапазоны не пересекаются и идут по возрастанию. Список
+ * сегментов хранится в манифесте (текстовый файл по пути индекса):
+ *
+ *   #SHARDS\t<число сегментов>
+ *   #SHARD\t<первый ID>\t<последний ID>\t<файл сегмента>
+ *
+ * Файлы сегментов лежат рядом с манифестом (<манифест>.shardN). Булев
+ * запрос проверяет каждый документ отдельно, поэтому результат по всему
+ * индексу - объединение результатов сегментов, а так как диапазоны
+ * упорядочены, отсортированные списки сегментов просто склеиваются
+ * (см. BooleanSearch).
+ *
+ * load принимает и обычный файл индекса - он загружается как один
+ * сегмент, так что программы поиска работают с обоими форматами.
+ */
+class ShardedIndex {
+public:
+    struct ShardInfo {
+        int first_id;
+        int last_id;
+        std::string path;  // файл сегмента
+    };
+
+    /**
+     * Итоги построения: стадии и счетчики - суммы по сегментам,
+     * total_seconds - общее время по часам
+     */
+    struct BuildSummary {
+        BooleanIndex::BuildStats build;
+        BooleanIndex::IndexStats stats;
+        double save_seconds;
+    };
+
+    /**
+     * Является ли файл манифестом сегментированного индекса
+     */
+    static bool is_manifest(const std::string& path);
+
+    /**
+     * Построение сегментированного индекса
+     *
+     * Документы корпуса (директория или пакет) делятся на shards
+     * непрерывных диапазонов ID с равным числом документов, каждый
+     * сегмент строится, сохраняется и освобождается, затем пишется
+     * манифест. Сегменты строятся параллельно в threads потоках
+     * (в памяти одновременно до threads сегментов).
+     *
+     * @param doc_store общее хранилище документов всех сегментов
+     *        (nullptr - без хранилища; finish - за вызывающим)
+     * @return false, если корпус пуст или файлы не удалось записать
+     */
+    static bool build(const std::string& corpus_dir, const std::string& manifest_path,
+                      size_t shards, size_t threads, const ReadAheadReader::Options& read_ahead,
+                      double progress_interval, BuildSummary& summary,
+                      DocStore::Writer* doc_store = nullptr);
+
+    /**
+     * Загрузка манифеста и всех сегментов (или одного файла индекса)
+     */
+    void load(const std::string& path);
+
+    size_t size() const { return shards_.size(); }
+    const ShardInfo& shard_info(size_t i) const { return info_[i]; }
+    const BooleanIndex& shard(size_t i) const { return *shards_[i]; }
+
+    /**
+     * Статистика по всем сегментам
+     *
+     * Уникальные слова считаются по объединению словарей (слово,
+     * встречающееся в нескольких сегментах, учитывается один раз),
+     * остальные счетчики и память - суммы; кеш стемминга общий для
+     * потока и учитывается один раз.
+     */
+    BooleanIndex::IndexStats get_stats() const;
+
+    /**
+     * Путь к файлу документа (из сегмента, в диапазон которого попадает ID)
+     */
+    std::string get_document_path(int doc_id) const;
+
+private:
+    Vector<ShardInfo> info_;
+    Vector<std::unique_ptr<BooleanIndex>> shards_;
+};
+
+#endif // SHARDED_INDEX_H
@@ -1,13 +1,19 @@
 #include "boolean_search.h"
-#include "../utils/sort.h"
+#include "../utils/thread_pool.h"
 #include <sstream>
 #include <cctype>
+#include <functional>
+#include <limits>
+#include <memory>
 
-static bool compare_int(const int& a, const int& b) {
-    return a < b;
+BooleanSearch::BooleanSearch(const BooleanIndex& index, ThreadPool* pool) : pool_(pool) {
+    shards_.push_back(&index);
 }
 
-BooleanSearch::BooleanSearch(const BooleanIndex& index) : index_(index) {
+BooleanSearch::BooleanSearch(const ShardedIndex& index, ThreadPool* pool) : pool_(pool) {
+    for (size_t i = 0; i < index.size(); ++i) {
+        shards_.push_back(&index.shard(i));
+    }
 }
 
 Vector<int> BooleanSearch::search(const std::string& query) const {
@@ -18,140 +24,127 @@ Vector<int> BooleanSearch::parse_and_search(const std::string& query) const {
     // Токенизация запроса
     Vector<std::string> tokens = tokenize_query(query);
     
-    if (tokens.empty()) {
+    if (tokens.empty() || shards_.empty()) {
         return Vector<int>();
     }
     
     // Обработка простого случая (без операторов)
     if (tokens.size() == 1) {
-        return index_.get_documents(tokens[0]);
+        return search_term(tokens[0]);
     }
     
-    // Упрощенная версия: обработка последовательно слева направо
-    Vector<int> result;
-    bool is_first = true;
-    std::string current_op = "OR";  // По умолчанию OR
+    // Разбор слева направо, n-арные AND/OR/NOT, линейные ядра
+    bool parallel = pool_ != nullptr && pool_->size() > 0;
+    if (shards_.size() == 1 && !parallel) {
+        QueryPlan plan(*shards_[0]);
+        plan.build(tokens);
+        return plan.execute(false);
+    }
     
-    for (size_t i = 0; i < tokens.size(); ++i) {
-        const std::string& token = tokens[i];
-        
-        // Проверка на оператор
-        if (token == "AND" || token == "OR" || token == "NOT") {
-            current_op = token;
-            continue;
-        }
-        
-        // Получить документы для слова
-        Vector<int> word_docs = index_.get_documents(token);
-        
-        if (is_first) {
-            result = word_docs;
-            is_first = false;
-        } else {
-            // Применить оператор
-            if (current_op == "AND") {
-                result = intersect_lists(result, word_docs);
-            } else if (current_op == "OR") {
-                result = union_lists(result, word_docs);
-            } else if (current_op == "NOT") {
-                result = difference_lists(result, word_docs);
-            }
+    // Задачи: сегмент x диапазон ID. Тяжелые планы делятся на диапазоны
+    // с равным числом документов, легкие выполняются целиком
+    size_t ranges_per_plan = parallel ? (pool_->size() + 1) * RANGES_PER_THREAD : 1;
+    Vector<std::unique_ptr<QueryPlan>> plans;
+    Vector<RangeTask> tasks;
+    for (size_t s = 0; s < shards_.size(); ++s) {
+        plans.push_back(std::unique_ptr<QueryPlan>(new QueryPlan(*shards_[s])));
+        plans.back()->build(tokens);
+        size_t ranges = plans.back()->input_postings() >= PARALLEL_MIN_POSTINGS ? ranges_per_plan : 1;
+        split_ranges(*shards_[s], s, ranges, tasks);
+    }
+    
+    Vector<Vector<int>> partial;
+    partial.resize(tasks.size());
+    std::function<void(size_t)> run = [&](size_t i) {
+        const RangeTask& task = tasks[i];
+        // Копия плана на диапазон: у выполнения свои результаты узлов
+        QueryPlan plan(*plans[task.shard]);
+        partial[i] = plan.execute_range(task.first_id, task.last_id, false);
+    };
+    if (parallel && tasks.size() > 1) {
+        pool_->parallel_for(tasks.size(), run);
+    } else {
+        for (size_t i = 0; i < tasks.size(); ++i) {
+            run(i);
         }
     }
     
-    return normalize_list(result);
+    return concatenate(partial);
 }
 
-Vector<int> BooleanSearch::union_lists(const Vector<int>& list1, 
-                                       const Vector<int>& list2) const {
-    Vector<int> result = list1;
+Vector<int> BooleanSearch::search_term(const std::string& word) const {
+    if (shards_.size() == 1) {
+        return shards_[0]->get_documents(word);
+    }
     
-    // Добавить элементы из list2, которых нет в result
-    for (size_t i = 0; i < list2.size(); ++i) {
-        int doc_id = list2[i];
-        bool found = false;
-        
-        for (size_t j = 0; j < result.size(); ++j) {
-            if (result[j] == doc_id) {
-                found = true;
-                break;
-            }
-        }
-        
-        if (!found) {
-            result.push_back(doc_id);
+    Vector<Vector<int>> partial;
+    partial.resize(shards_.size());
+    std::function<void(size_t)> run = [&](size_t i) {
+        partial[i] = shards_[i]->get_documents(word);
+    };
+    if (pool_ != nullptr) {
+        pool_->parallel_for(shards_.size(), run);
+    } else {
+        for (size_t i = 0; i < shards_.size(); ++i) {
+            run(i);
         }
     }
-    
-    Sort<int>::quicksort(result, compare_int);
-    return result;
+    return concatenate(partial);
 }
 
-Vector<int> BooleanSearch::intersect_lists(const Vector<int>& list1, 
-                                           const Vector<int>& list2) const {
-    Vector<int> result;
-    
-    for (size_t i = 0; i < list1.size(); ++i) {
-        int doc_id = list1[i];
-        
-        for (size_t j = 0; j < list2.size(); ++j) {
-            if (list2[j] == doc_id) {
-                result.push_back(doc_id);
-                break;
-            }
-        }
+void BooleanSearch::split_ranges(const BooleanIndex& index, size_t shard, size_t ranges, Vector<RangeTask>& tasks) {
+    const Vector<BooleanIndex::DocumentInfo>& documents = index.get_document_table();
+    if (ranges > documents.size()) {
+        ranges = documents.size();
     }
     
-    Sort<int>::quicksort(result, compare_int);
-    return result;
+    // Крайние диапазоны открыты: постинги вне таблицы документов тоже попадут
+    RangeTask task;
+    task.shard = shard;
+    task.first_id = std::numeric_limits<int>::min();
+    for (size_t r = 1; r < ranges; ++r) {
+        int boundary = documents[r * documents.size() / ranges].id;
+        task.last_id = boundary - 1;
+        tasks.push_back(task);
+        task.first_id = boundary;
+    }
+    task.last_id = std::numeric_limits<int>::max();
+    tasks.push_back(task);
 }
 
-Vector<int> BooleanSearch::difference_lists(const Vector<int>& list1, 
-                                            const Vector<int>& list2) const {
-    Vector<int> result;
-    
-    for (size_t i = 0; i < list1.size(); ++i) {
-        int doc_id = list1[i];
-        bool found = false;
-        
-        for (size_t j = 0; j < list2.size(); ++j) {
-            if (list2[j] == doc_id) {
-                found = true;
-                break;
-            }
-        }
-        
-        if (!found) {
-            result.push_back(doc_id);
+Vector<int> BooleanSearch::concatenate(const Vector<Vector<int>>& parts) {
+    // Части упорядочены по диапазонам ID - склейка сохраняет сортировку
+    size_t total = 0;
+    for (size_t i = 0; i < parts.size(); ++i) {
+        total += parts[i].size();
+    }
+    Vector<int> results;
+    results.reserve(total);
+    for (size_t i = 0; i < parts.size(); ++i) {
+        for (size_t j = 0; j < parts[i].size(); ++j) {
+            results.push_back(parts[i][j]);
         }
     }
-    
-    Sort<int>::quicksort(result, compare_int);
-    return result;
+    return results;
 }
 
-Vector<int> BooleanSearch::normalize_list(const Vector<int>& list) const {
-    if (list.empty()) {
-        return list;
-    }
+QueryPlan BooleanSearch::explain(const std::string& query, Vector<int>& results) const {
+    Vector<std::string> tokens = tokenize_query(query);
+    QueryPlan plan(*shards_[0]);
+    plan.build(tokens);
+    results = plan.execute(true);
     
-    // Удаление дубликатов
-    Vector<int> result;
-    for (size_t i = 0; i < list.size(); ++i) {
-        bool found = false;
-        for (size_t j = 0; j < result.size(); ++j) {
-            if (result[j] == list[i]) {
-                found = true;
-                break;
-            }
-        }
-        if (!found) {
-            result.push_back(list[i]);
+    // Сегменты по очереди: время узлов складывается, как и счетчики
+    for (size_t i = 1; i < shards_.size(); ++i) {
+        QueryPlan shard_plan(*shards_[i]);
+        shard_plan.build(tokens);
+        Vector<int> shard_results = shard_plan.execute(true);
+        for (size_t j = 0; j < shard_results.size(); ++j) {
+            results.push_back(shard_results[j]);
         }
+        plan.merge(shard_plan);
     }
-    
-    Sort<int>::quicksort(result, compare_int);
-    return result;
+    return plan;
 }
 
 Vector<std::string> BooleanSearch::tokenize_query(const std::string& query) const {
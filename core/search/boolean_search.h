@@ -3,7 +3,11 @@
 
 #include <string>
 #include "../index/boolean_index.h"
+#include "../index/sharded_index.h"
 #include "../utils/vector.h"
+#include "query_plan.h"
+
+class ThreadPool;
 
 /**
  * Лабораторная работа 7: Булев поиск
@@ -15,8 +19,24 @@ public:
      * Конструктор
      * 
      * @param index ссылка на булев индекс
+     * @param pool потоки для параллельного выполнения тяжелых запросов
+     *        по диапазонам ID (nullptr - в вызывающем потоке)
+     */
+    BooleanSearch(const BooleanIndex& index, ThreadPool* pool = nullptr);
+    
+    /**
+     * Поиск по сегментированному индексу
+     * 
+     * Запрос рассылается всем сегментам (параллельно на пуле, если он
+     * задан), результаты склеиваются в порядке диапазонов ID - так же
+     * отсортированный список, как у одного индекса. С пулом тяжелые
+     * запросы (см. PARALLEL_MIN_POSTINGS) еще и делятся внутри сегмента
+     * на диапазоны ID, которые выполняются параллельно.
+     * 
+     * @param index сегменты индекса (или один индекс, загруженный ShardedIndex)
+     * @param pool потоки для сегментов и диапазонов (nullptr - в вызывающем потоке)
      */
-    BooleanSearch(const BooleanIndex& index);
+    BooleanSearch(const ShardedIndex& index, ThreadPool* pool = nullptr);
     
     /**
      * Поиск по запросу
@@ -38,32 +58,59 @@ public:
      * @return список ID документов
      */
     Vector<int> parse_and_search(const std::string& query) const;
+    
+    /**
+     * Поиск с профилированием (EXPLAIN)
+     * 
+     * @param query строка запроса
+     * @param results список ID документов (тот же, что у search)
+     * @return выполненный план: дерево операторов с ядрами, счетчиками
+     *         и временем каждого узла (to_text / to_json); для сегментов -
+     *         сумма счетчиков по сегментам (см. QueryPlan::merge)
+     */
+    QueryPlan explain(const std::string& query, Vector<int>& results) const;
 
-private:
-    const BooleanIndex& index_;
+    /**
+     * Минимальная суммарная длина списков термов, при которой запрос
+     * делится на диапазоны ID для параллельного выполнения (для коротких
+     * запросов раздача задач дороже самого поиска)
+     */
+    static const uint64_t PARALLEL_MIN_POSTINGS = 100000;
     
     /**
-     * Объединение двух списков (OR)
+     * Диапазонов на поток пула: с запасом, чтобы неравномерные по
+     * стоимости диапазоны выравнивались перехватом работы
      */
-    Vector<int> union_lists(const Vector<int>& list1, 
-                           const Vector<int>& list2) const;
+    static const size_t RANGES_PER_THREAD = 4;
+
+private:
+    /**
+     * Часть запроса: сегмент и диапазон ID [first_id, last_id]
+     */
+    struct RangeTask {
+        size_t shard;
+        int first_id;
+        int last_id;
+    };
     
     /**
-     * Пересечение двух списков (AND)
+     * Поиск одного слова во всех сегментах
      */
-    Vector<int> intersect_lists(const Vector<int>& list1, 
-                               const Vector<int>& list2) const;
+    Vector<int> search_term(const std::string& word) const;
     
     /**
-     * Разность списков (NOT)
+     * Деление ID сегмента на ranges диапазонов с равным числом документов
      */
-    Vector<int> difference_lists(const Vector<int>& list1, 
-                                const Vector<int>& list2) const;
+    static void split_ranges(const BooleanIndex& index, size_t shard, size_t ranges, Vector<RangeTask>& tasks);
     
     /**
-     * Сортировка и удаление дубликатов из списка
+     * Склейка результатов диапазонов, упорядоченных по ID
      */
-    Vector<int> normalize_list(const Vector<int>& list) const;
+    static Vector<int> concatenate(const Vector<Vector<int>>& parts);
+    
+    // Сегменты по возрастанию ID (один - для обычного индекса)
+    Vector<const BooleanIndex*> shards_;
+    ThreadPool* pool_;
     
     /**
      * Парсинг запроса на токены
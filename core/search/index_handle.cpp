@@ -0,0 +1,146 @@
+#include "index_handle.h"
+#include "../utils/file_utils.h"
+#include <chrono>
+#include <iostream>
+
+IndexHandle::IndexHandle(const std::string& index_path, const SnippetGenerator::Options& snippet_options,
+                         const std::string& corpus)
+    : index_path_(index_path), snippet_options_(snippet_options), corpus_(corpus), next_version_(1),
+      seen_index_modified_(-1), seen_corpus_modified_(-1), failed_index_modified_(-1),
+      failed_corpus_modified_(-1), stopping_(false) {
+}
+
+IndexHandle::~IndexHandle() {
+    stop_watch();
+}
+
+std::string IndexHandle::corpus_path() const {
+    if (!corpus_.empty()) {
+        return corpus_;
+    }
+    std::string store = DocStore::path_for_index(index_path_);
+    return DocStore::is_store(store) ? store : std::string();
+}
+
+bool IndexHandle::reload() {
+    std::lock_guard<std::mutex> lock(reload_mutex_);
+    typedef std::chrono::steady_clock Clock;
+    Clock::time_point start = Clock::now();
+
+    // Время изменения - до чтения: изменение во время загрузки
+    // заметит следующая проверка
+    std::shared_ptr<Snapshot> snapshot(new Snapshot(snippet_options_));
+    std::string corpus = corpus_path();
+    snapshot->index_modified = FileUtils::modified_time(index_path_);
+    snapshot->corpus_modified = corpus.empty() ? -1 : FileUtils::modified_time(corpus);
+
+    snapshot->index.load(index_path_);
+    for (size_t i = 0; i < snapshot->index.size(); ++i) {
+        snapshot->documents += snapshot->index.shard(i).get_document_table().size();
+    }
+
+    bool ok = true;
+    std::shared_ptr<const Snapshot> previous = acquire();
+    if (!corpus.empty() && !snapshot->snippets.set_corpus(corpus)) {
+        std::cerr << "Ошибка: не удалось открыть корпус " << corpus << std::endl;
+        ok = false;
+    } else if (previous && snapshot->documents == 0) {
+        // Пустой индекс - недописанный или не тот файл, рабочий не заменяется
+        std::cerr << "Ошибка: в индексе " << index_path_ << " нет документов" << std::endl;
+        ok = false;
+    }
+    if (!ok) {
+        failed_index_modified_ = snapshot->index_modified;
+        failed_corpus_modified_ = snapshot->corpus_modified;
+        return false;
+    }
+
+    snapshot->version = next_version_++;
+    snapshot->load_seconds = std::chrono::duration<double>(Clock::now() - start).count();
+    seen_index_modified_ = snapshot->index_modified;
+    seen_corpus_modified_ = snapshot->corpus_modified;
+
+    previous = std::atomic_exchange(&current_, std::shared_ptr<const Snapshot>(std::move(snapshot)));
+    if (previous) {
+        std::lock_guard<std::mutex> retired_lock(retired_mutex_);
+        retired_.push_back(std::move(previous));
+    }
+    collect();
+    return true;
+}
+
+bool IndexHandle::reload_if_changed() {
+    {
+        std::lock_guard<std::mutex> lock(reload_mutex_);
+        std::string corpus = corpus_path();
+        int64_t index_modified = FileUtils::modified_time(index_path_);
+        int64_t corpus_modified = corpus.empty() ? -1 : FileUtils::modified_time(corpus);
+
+        std::shared_ptr<const Snapshot> current = acquire();
+        bool changed = !current || index_modified != current->index_modified ||
+                       corpus_modified != current->corpus_modified;
+        // Индекс и хранилище пишутся по очереди: загрузка, только когда
+        // файлы не менялись между двумя проверками
+        bool stable = index_modified == seen_index_modified_ && corpus_modified == seen_corpus_modified_;
+        bool failed = index_modified == failed_index_modified_ && corpus_modified == failed_corpus_modified_;
+        seen_index_modified_ = index_modified;
+        seen_corpus_modified_ = corpus_modified;
+        if (!changed || !stable || failed || index_modified < 0) {
+            return false;
+        }
+    }
+    return reload();
+}
+
+size_t IndexHandle::collect() {
+    // Снимок, который держит только список, никто больше не получит
+    // (acquire возвращает текущий) - его можно освободить
+    Vector<std::shared_ptr<const Snapshot>> released;
+    size_t in_use = 0;
+    {
+        std::lock_guard<std::mutex> lock(retired_mutex_);
+        Vector<std::shared_ptr<const Snapshot>> kept;
+        for (size_t i = 0; i < retired_.size(); ++i) {
+            if (retired_[i].use_count() == 1) {
+                released.push_back(std::move(retired_[i]));
+            } else {
+                kept.push_back(std::move(retired_[i]));
+            }
+        }
+        retired_ = std::move(kept);
+        in_use = retired_.size();
+    }
+    // released освобождается здесь, вне блокировки
+    return in_use;
+}
+
+void IndexHandle::watch(double interval) {
+    stop_watch();
+    stopping_ = false;
+    std::chrono::duration<double> period(interval > 0.0 ? interval : 1.0);
+    watcher_ = std::thread([this, period]() {
+        std::unique_lock<std::mutex> lock(watch_mutex_);
+        while (!watch_wakeup_.wait_for(lock, period, [this]() { return stopping_; })) {
+            lock.unlock();
+            if (reload_if_changed()) {
+                std::shared_ptr<const Snapshot> after = acquire();
+                std::cerr << "Индекс перезагружен: версия " << after->version << ", документов "
+                          << after->documents << ", загрузка " << after->load_seconds << " с" << std::endl;
+            }
+            collect();
+            lock.lock();
+        }
+    });
+}
+
+void IndexHandle::stop_watch() {
+    if (!watcher_.joinable()) {
+        return;
+    }
+    {
+        std::lock_guard<std::mutex> lock(watch_mutex_);
+        stopping_ = true;
+    }
+    watch_wakeup_.notify_all();
+    watcher_.join();
+}
@@ -0,0 +1,136 @@
+#ifndef INDEX_HANDLE_H
+#define INDEX_HANDLE_H
+
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include "snippet_generator.h"
+#include "../index/sharded_index.h"
+#include "../utils/vector.h"
+
+/**
+ * Перезагружаемый индекс долго работающего процесса поиска
+ *
+ * Индекс (файл или манифест сегментов) вместе с генератором сниппетов
+ * по его корпусу - неизменяемый снимок. Запрос берет текущий снимок
+ * (acquire) и держит его до конца выполнения. Новый индекс загружается
+ * целиком в стороне (reload - в вызывающем потоке, watch - в фоновом
+ * потоке, когда файлы индекса изменились) и публикуется атомарной
+ * заменой shared_ptr: начатые запросы дорабатывают на старом снимке,
+ * следующие получают новый, ожидания загрузки у запросов нет.
+ *
+ * Старый снимок освобождается, когда его отпустит последний запрос:
+ * до этого он лежит в списке отработавших, а освобождает его collect
+ * (фоновый поток или следующая перезагрузка) - большой индекс не
+ * разрушается в потоке запроса.
+ *
+ * Если новый индекс не загрузился (корпус не открылся, в индексе нет
+ * документов) - остается прежний снимок. build_index заменяет файлы
+ * атомарно (запись во временный файл и rename), манифест - последним,
+ * поэтому недописанный индекс не загружается.
+ */
+class IndexHandle {
+public:
+    struct Snapshot {
+        ShardedIndex index;
+        SnippetGenerator snippets;
+        uint64_t version;        // номер загрузки (1 - первая)
+        size_t documents;
+        int64_t index_modified;  // время изменения файлов до загрузки
+        int64_t corpus_modified;
+        double load_seconds;
+
+        Snapshot(const SnippetGenerator::Options& snippet_options)
+            : snippets(index, snippet_options), version(0), documents(0),
+              index_modified(-1), corpus_modified(-1), load_seconds(0.0) {}
+    };
+
+    /**
+     * @param index_path файл индекса или манифест сегментов
+     * @param snippet_options параметры сниппетов снимков
+     * @param corpus корпус сниппетов (пусто - <index_path>.docs, если есть,
+     *        иначе пути из таблицы документов)
+     */
+    IndexHandle(const std::string& index_path,
+                const SnippetGenerator::Options& snippet_options = SnippetGenerator::Options(),
+                const std::string& corpus = std::string());
+
+    /**
+     * Останавливает фоновую проверку
+     */
+    ~IndexHandle();
+
+    IndexHandle(const IndexHandle&) = delete;
+    IndexHandle& operator=(const IndexHandle&) = delete;
+
+    /**
+     * Загрузка нового снимка и его публикация
+     *
+     * @return false, если снимок не загрузился (текущий не меняется)
+     */
+    bool reload();
+
+    /**
+     * Перезагрузка, если файлы индекса или корпуса изменились и не менялись
+     * с прошлой проверки (перестроение закончено)
+     *
+     * @return true, если опубликован новый снимок
+     */
+    bool reload_if_changed();
+
+    /**
+     * Текущий снимок (nullptr до первой загрузки); держать до конца запроса
+     */
+    std::shared_ptr<const Snapshot> acquire() const {
+        return std::atomic_load(&current_);
+    }
+
+    /**
+     * Фоновая проверка файлов раз в interval секунд (reload_if_changed и collect)
+     */
+    void watch(double interval);
+
+    void stop_watch();
+
+    /**
+     * Освобождение отработавших снимков, которые больше не используются
+     *
+     * @return число еще используемых отработавших снимков
+     */
+    size_t collect();
+
+    const std::string& index_path() const { return index_path_; }
+
+private:
+    /**
+     * Путь корпуса сниппетов для текущих файлов (пусто - пути из индекса)
+     */
+    std::string corpus_path() const;
+
+    std::string index_path_;
+    SnippetGenerator::Options snippet_options_;
+    std::string corpus_;
+
+    std::shared_ptr<const Snapshot> current_;  // только через atomic_load/atomic_store
+
+    // Перезагрузки по одной (команда и фоновая проверка)
+    std::mutex reload_mutex_;
+    uint64_t next_version_;
+    int64_t seen_index_modified_;   // при прошлой проверке
+    int64_t seen_corpus_modified_;
+    int64_t failed_index_modified_; // не загрузившиеся файлы повторно не загружаются
+    int64_t failed_corpus_modified_;
+
+    std::mutex retired_mutex_;
+    Vector<std::shared_ptr<const Snapshot>> retired_;
+
+    std::mutex watch_mutex_;
+    std::condition_variable watch_wakeup_;
+    bool stopping_;
+    std::thread watcher_;
+};
+
+#endif // INDEX_HANDLE_H
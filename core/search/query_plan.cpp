@@ -0,0 +1,644 @@
+#include "query_plan.h"
+#include "../utils/string_utils.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <limits>
+
+namespace {
+
+typedef std::chrono::steady_clock Clock;
+
+uint64_t nanoseconds_since(Clock::time_point start) {
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - start).count());
+}
+
+/**
+ * Первая позиция в [from, size) со значением >= value (экспоненциальный
+ * поиск от from, затем бинарный); probes - число сравнений
+ */
+template <typename List>
+size_t gallop(const List& list, size_t from, int value, uint64_t& probes) {
+    size_t size = list.size();
+    size_t bound = 1;
+    while (from + bound < size && list[from + bound] < value) {
+        bound *= 2;
+        ++probes;
+    }
+    size_t left = from + bound / 2;
+    size_t right = std::min(from + bound, size);
+    while (left < right) {
+        size_t mid = left + (right - left) / 2;
+        ++probes;
+        if (list[mid] < value) {
+            left = mid + 1;
+        } else {
+            right = mid;
+        }
+    }
+    return left;
+}
+
+void append_number(std::string& out, uint64_t value) {
+    out += std::to_string(value);
+}
+
+void append_microseconds(std::string& out, uint64_t ns) {
+    char buffer[32];
+    std::snprintf(buffer, sizeof(buffer), "%.1f", ns / 1000.0);
+    out += buffer;
+}
+
+
+}
+
+QueryPlan::Node::Node()
+    : type(NODE_TERM), term_id(TermDictionary::INVALID_ID), range(), estimate(0), executed(false),
+      scanned(0), skipped(0), result_size(0), time_ns(0) {
+}
+
+QueryPlan::QueryPlan(const BooleanIndex& index)
+    : index_(index), root_(0), total_ns_(0), shards_(1),
+      first_id_(std::numeric_limits<int>::min()), last_id_(std::numeric_limits<int>::max()) {
+}
+
+const char* QueryPlan::type_name(NodeType type) {
+    switch (type) {
+        case NODE_TERM: return "TERM";
+        case NODE_RANGE: return "RANGE";
+        case NODE_AND: return "AND";
+        case NODE_OR: return "OR";
+        case NODE_NOT: return "NOT";
+    }
+    return "";
+}
+
+const char* QueryPlan::kernel_name(Kernel kernel) {
+    switch (kernel) {
+        case KERNEL_POSTINGS: return "postings";
+        case KERNEL_RANGE: return "range";
+        case KERNEL_MERGE: return "merge";
+        case KERNEL_GALLOP: return "gallop";
+        case KERNEL_FILTER: return "filter";
+    }
+    return "";
+}
+
+size_t QueryPlan::add_term(const std::string& word) {
+    Node node;
+    node.term = word;
+    if (BooleanIndex::parse_range(word, node.range)) {
+        node.type = NODE_RANGE;
+        node.estimate = index_.count_range(node.range);
+        nodes_.push_back(std::move(node));
+        return nodes_.size() - 1;
+    }
+    node.type = NODE_TERM;
+    node.term_id = index_.find_term(word);
+    node.estimate = node.term_id == TermDictionary::INVALID_ID ? 0 : index_.get_postings(node.term_id).size();
+    nodes_.push_back(std::move(node));
+    return nodes_.size() - 1;
+}
+
+size_t QueryPlan::add_operator(NodeType type, size_t left, size_t right) {
+    // Цепочка одинаковых операторов - один n-арный узел
+    // ((a AND b) AND c) -> AND(a, b, c); ((a NOT b) NOT c) -> NOT(a, b, c)
+    if (nodes_[left].type == type) {
+        Node& chain = nodes_[left];
+        chain.children.push_back(right);
+        if (type == NODE_AND) {
+            chain.estimate = std::min(chain.estimate, nodes_[right].estimate);
+        } else if (type == NODE_OR) {
+            chain.estimate += nodes_[right].estimate;
+        }
+        return left;
+    }
+
+    Node node;
+    node.type = type;
+    node.children.push_back(left);
+    node.children.push_back(right);
+    if (type == NODE_AND) {
+        node.estimate = std::min(nodes_[left].estimate, nodes_[right].estimate);
+    } else if (type == NODE_OR) {
+        node.estimate = nodes_[left].estimate + nodes_[right].estimate;
+    } else {
+        node.estimate = nodes_[left].estimate;
+    }
+    nodes_.push_back(std::move(node));
+    return nodes_.size() - 1;
+}
+
+void QueryPlan::build(const Vector<std::string>& tokens) {
+    nodes_.clear();
+    parsed_.clear();
+    root_ = 0;
+
+    // Один токен - всегда слово (даже если совпадает с оператором)
+    if (tokens.size() == 1) {
+        root_ = add_term(tokens[0]);
+        parsed_ = tokens[0];
+        return;
+    }
+
+    // Слева направо; оператор действует до следующего оператора,
+    // по умолчанию OR
+    NodeType current = NODE_OR;
+    bool is_first = true;
+    for (size_t i = 0; i < tokens.size(); ++i) {
+        const std::string& token = tokens[i];
+        if (token == "AND") {
+            current = NODE_AND;
+            continue;
+        }
+        if (token == "OR") {
+            current = NODE_OR;
+            continue;
+        }
+        if (token == "NOT") {
+            current = NODE_NOT;
+            continue;
+        }
+
+        size_t term = add_term(token);
+        if (is_first) {
+            root_ = term;
+            parsed_ = token;
+            is_first = false;
+        } else {
+            root_ = add_operator(current, root_, term);
+            parsed_ = "(" + parsed_ + " " + type_name(current) + " " + token + ")";
+        }
+    }
+
+    // Порядок выполнения: AND и OR - от меньшей оценки к большей,
+    // у NOT вычитаемые - от больших (быстрее опустошают результат)
+    for (size_t i = 0; i < nodes_.size(); ++i) {
+        Node& node = nodes_[i];
+        if (node.type == NODE_TERM || node.type == NODE_RANGE) {
+            continue;
+        }
+        const Vector<Node>& all = nodes_;
+        size_t* first = node.children.begin();
+        if (node.type == NODE_NOT) {
+            std::stable_sort(first + 1, node.children.end(), [&all](size_t a, size_t b) {
+                return all[a].estimate > all[b].estimate;
+            });
+        } else {
+            std::stable_sort(first, node.children.end(), [&all](size_t a, size_t b) {
+                return all[a].estimate < all[b].estimate;
+            });
+        }
+    }
+}
+
+Vector<int> QueryPlan::execute(bool profile) {
+    return execute_range(std::numeric_limits<int>::min(), std::numeric_limits<int>::max(), profile);
+}
+
+Vector<int> QueryPlan::execute_range(int first_id, int last_id, bool profile) {
+    total_ns_ = 0;
+    first_id_ = first_id;
+    last_id_ = last_id;
+    if (nodes_.empty()) {
+        return Vector<int>();
+    }
+
+    results_.clear();
+    results_.resize(nodes_.size());
+    for (size_t i = 0; i < nodes_.size(); ++i) {
+        Node& node = nodes_[i];
+        node.executed = false;
+        node.kernels.clear();
+        node.scanned = 0;
+        node.skipped = 0;
+        node.result_size = 0;
+        node.time_ns = 0;
+        results_[i].clear();
+    }
+
+    Clock::time_point start = Clock::now();
+    Span span = execute_node(root_, profile);
+    Vector<int> result;
+    result.reserve(span.size());
+    for (size_t i = 0; i < span.size(); ++i) {
+        result.push_back(span[i]);
+    }
+    if (profile) {
+        total_ns_ = nanoseconds_since(start);
+    }
+    return result;
+}
+
+uint64_t QueryPlan::input_postings() const {
+    uint64_t total = 0;
+    for (size_t i = 0; i < nodes_.size(); ++i) {
+        if (nodes_[i].type == NODE_TERM || nodes_[i].type == NODE_RANGE) {
+            total += nodes_[i].estimate;
+        }
+    }
+    return total;
+}
+
+QueryPlan::Span QueryPlan::execute_node(size_t index, bool profile) {
+    Clock::time_point start;
+    if (profile) {
+        start = Clock::now();
+    }
+
+    Node& node = nodes_[index];
+    node.executed = true;
+    Span current = {nullptr, 0};
+
+    if (node.type == NODE_TERM) {
+        if (node.term_id != TermDictionary::INVALID_ID) {
+            const Vector<int>& postings = index_.get_postings(node.term_id);
+            const int* begin = postings.begin();
+            const int* end = postings.end();
+            // Весь список - без поиска границ
+            if (postings.empty() || (*begin >= first_id_ && *(end - 1) <= last_id_)) {
+                current.data = begin;
+                current.length = postings.size();
+            } else {
+                const int* from = std::lower_bound(begin, end, first_id_);
+                const int* to = last_id_ == std::numeric_limits<int>::max() ? end : std::upper_bound(from, end, last_id_);
+                current.data = from;
+                current.length = static_cast<size_t>(to - from);
+            }
+        }
+        node.kernels.push_back(KERNEL_POSTINGS);
+    } else if (node.type == NODE_RANGE) {
+        Vector<int>& out = results_[index];
+        out = index_.find_range(node.range, first_id_, last_id_);
+        current.data = out.begin();
+        current.length = out.size();
+        node.kernels.push_back(KERNEL_RANGE);
+    } else {
+        Vector<int>& out = results_[index];
+        current = execute_node(node.children[0], profile);
+
+        for (size_t c = 1; c < node.children.size(); ++c) {
+            // Пустое пересечение или разность не изменятся - остальные не выполняются
+            if (current.empty() && node.type != NODE_OR) {
+                break;
+            }
+
+            // Кандидатов намного меньше, чем документов условия, -
+            // проверка значений вместо построения списка условия
+            Node& child = nodes_[node.children[c]];
+            if (child.type == NODE_RANGE && node.type != NODE_OR &&
+                current.size() * GALLOP_RATIO < child.estimate) {
+                Vector<int> step;
+                filter(current, index_.get_attribute_column(child.range.attribute), child.range,
+                       node.type == NODE_AND, step, node);
+                child.executed = true;
+                child.kernels.push_back(KERNEL_FILTER);
+                child.result_size = node.type == NODE_AND ? step.size() : current.size() - step.size();
+                out = std::move(step);
+                current.data = out.begin();
+                current.length = out.size();
+                continue;
+            }
+
+            Span next = execute_node(node.children[c], profile);
+            Vector<int> step;
+            if (node.type == NODE_AND) {
+                if (current.size() <= next.size()) {
+                    intersect(current, next, step, node);
+                } else {
+                    intersect(next, current, step, node);
+                }
+            } else if (node.type == NODE_OR) {
+                unite(current, next, step, node);
+            } else {
+                subtract(current, next, step, node);
+            }
+            out = std::move(step);
+            current.data = out.begin();
+            current.length = out.size();
+        }
+    }
+
+    node.result_size = current.size();
+    if (profile) {
+        node.time_ns = nanoseconds_since(start);
+    }
+    return current;
+}
+
+void QueryPlan::intersect(Span smaller, Span larger, Vector<int>& out, Node& node) {
+    out.reserve(smaller.size());
+
+    if (!smaller.empty() && larger.size() >= GALLOP_RATIO * smaller.size()) {
+        // Для каждого элемента короткого списка - поиск в длинном
+        node.kernels.push_back(KERNEL_GALLOP);
+        size_t pos = 0;
+        for (size_t i = 0; i < smaller.size(); ++i) {
+            if (pos >= larger.size()) {
+                node.skipped += smaller.size() - i;
+                break;
+            }
+            uint64_t probes = 1;
+            size_t found = gallop(larger, pos, smaller[i], probes);
+            node.scanned += probes;
+            node.skipped += found - pos > probes ? found - pos - probes : 0;
+            pos = found;
+            if (pos < larger.size() && larger[pos] == smaller[i]) {
+                out.push_back(smaller[i]);
+                ++pos;
+            }
+        }
+        return;
+    }
+
+    node.kernels.push_back(KERNEL_MERGE);
+    size_t i = 0;
+    size_t j = 0;
+    while (i < smaller.size() && j < larger.size()) {
+        if (smaller[i] < larger[j]) {
+            ++i;
+        } else if (larger[j] < smaller[i]) {
+            ++j;
+        } else {
+            out.push_back(smaller[i]);
+            ++i;
+            ++j;
+        }
+    }
+    node.scanned += i + j;
+    node.skipped += (smaller.size() - i) + (larger.size() - j);
+}
+
+void QueryPlan::unite(Span a, Span b, Vector<int>& out, Node& node) {
+    node.kernels.push_back(KERNEL_MERGE);
+    out.reserve(a.size() + b.size());
+
+    size_t i = 0;
+    size_t j = 0;
+    while (i < a.size() && j < b.size()) {
+        if (a[i] < b[j]) {
+            out.push_back(a[i++]);
+        } else if (b[j] < a[i]) {
+            out.push_back(b[j++]);
+        } else {
+            out.push_back(a[i]);
+            ++i;
+            ++j;
+        }
+    }
+    while (i < a.size()) {
+        out.push_back(a[i++]);
+    }
+    while (j < b.size()) {
+        out.push_back(b[j++]);
+    }
+    node.scanned += a.size() + b.size();
+}
+
+void QueryPlan::subtract(Span a, Span b, Vector<int>& out, Node& node) {
+    out.reserve(a.size());
+
+    if (!a.empty() && b.size() >= GALLOP_RATIO * a.size()) {
+        // Короткое уменьшаемое - поиск каждого элемента в вычитаемом
+        node.kernels.push_back(KERNEL_GALLOP);
+        size_t pos = 0;
+        for (size_t i = 0; i < a.size(); ++i) {
+            if (pos >= b.size()) {
+                out.push_back(a[i]);
+                continue;
+            }
+            uint64_t probes = 1;
+            size_t found = gallop(b, pos, a[i], probes);
+            node.scanned += probes;
+            node.skipped += found - pos > probes ? found - pos - probes : 0;
+            pos = found;
+            if (pos < b.size() && b[pos] == a[i]) {
+                ++pos;
+            } else {
+                out.push_back(a[i]);
+            }
+        }
+        return;
+    }
+
+    node.kernels.push_back(KERNEL_MERGE);
+    size_t i = 0;
+    size_t j = 0;
+    while (i < a.size() && j < b.size()) {
+        if (a[i] < b[j]) {
+            out.push_back(a[i++]);
+        } else if (b[j] < a[i]) {
+            ++j;
+        } else {
+            ++i;
+            ++j;
+        }
+    }
+    node.scanned += i + j;
+    node.skipped += b.size() - j;
+    while (i < a.size()) {
+        out.push_back(a[i++]);
+    }
+}
+
+void QueryPlan::filter(Span candidates, const BooleanIndex::AttributeColumn& column,
+                       const BooleanIndex::Range& range, bool matching, Vector<int>& out, Node& node) {
+    node.kernels.push_back(KERNEL_FILTER);
+    out.reserve(candidates.size());
+
+    // Кандидаты и столбец отсортированы по ID - поиск от предыдущей позиции
+    const Vector<int>& doc_ids = column.doc_ids;
+    size_t pos = 0;
+    for (size_t i = 0; i < candidates.size(); ++i) {
+        int doc_id = candidates[i];
+        bool in_range = false;
+        if (pos < doc_ids.size()) {
+            uint64_t probes = 1;
+            size_t found = gallop(doc_ids, pos, doc_id, probes);
+            node.scanned += probes;
+            node.skipped += found - pos > probes ? found - pos - probes : 0;
+            pos = found;
+            if (pos < doc_ids.size() && doc_ids[pos] == doc_id) {
+                int64_t value = column.values[pos];
+                in_range = value >= range.low && value <= range.high;
+                ++pos;
+            }
+        }
+        if (in_range == matching) {
+            out.push_back(doc_id);
+        }
+    }
+}
+
+void QueryPlan::append_text(size_t index, int depth, std::string& out) const {
+    const Node& node = nodes_[index];
+    out.append(static_cast<size_t>(depth) * 2 + 2, ' ');
+    out += type_name(node.type);
+
+    if (node.type == NODE_TERM) {
+        out += " " + node.term + ": постингов ";
+        append_number(out, node.estimate);
+    } else if (node.type == NODE_RANGE) {
+        out += " " + node.term + ": документов ";
+        append_number(out, node.estimate);
+        if (node.executed) {
+            out += " [";
+            out += kernel_name(node.kernels[0]);
+            out += "]; результат ";
+            append_number(out, node.result_size);
+        }
+    } else {
+        out += " [";
+        for (size_t k = 0; k < node.kernels.size(); ++k) {
+            out += k > 0 ? "," : "";
+            out += kernel_name(node.kernels[k]);
+        }
+        out += "] вход:";
+        for (size_t c = 0; c < node.children.size(); ++c) {
+            const Node& child = nodes_[node.children[c]];
+            out += c > 0 ? ", " : " ";
+            if (child.executed) {
+                append_number(out, child.result_size);
+            } else {
+                out += "-";
+            }
+        }
+        if (node.executed) {
+            out += "; просмотрено ";
+            append_number(out, node.scanned);
+            out += ", пропущено ";
+            append_number(out, node.skipped);
+            out += "; результат ";
+            append_number(out, node.result_size);
+        }
+    }
+
+    if (!node.executed) {
+        out += " (не выполнялся)";
+    } else if (node.time_ns > 0) {
+        out += "; ";
+        append_microseconds(out, node.time_ns);
+        out += " мкс";
+    }
+    out += "\n";
+
+    for (size_t c = 0; c < node.children.size(); ++c) {
+        append_text(node.children[c], depth + 1, out);
+    }
+}
+
+void QueryPlan::merge(const QueryPlan& other) {
+    if (other.nodes_.size() != nodes_.size()) {
+        return;
+    }
+    for (size_t i = 0; i < nodes_.size(); ++i) {
+        Node& node = nodes_[i];
+        const Node& shard = other.nodes_[i];
+        node.estimate += shard.estimate;
+        if (!node.executed && shard.executed) {
+            node.kernels = shard.kernels;
+        }
+        node.executed = node.executed || shard.executed;
+        node.scanned += shard.scanned;
+        node.skipped += shard.skipped;
+        node.result_size += shard.result_size;
+        node.time_ns += shard.time_ns;
+    }
+    total_ns_ += other.total_ns_;
+    shards_ += other.shards_;
+}
+
+std::string QueryPlan::to_text() const {
+    std::string out;
+    if (nodes_.empty()) {
+        out += "Пустой запрос\n";
+        return out;
+    }
+    out += "Разбор: " + parsed_ + "\n";
+    if (shards_ > 1) {
+        out += "Сегментов: ";
+        append_number(out, shards_);
+        out += " (счетчики и время - суммы по сегментам)\n";
+    }
+    out += "План:\n";
+    append_text(root_, 0, out);
+    out += "Документов: ";
+    append_number(out, nodes_[root_].result_size);
+    if (total_ns_ > 0) {
+        out += ", время: ";
+        append_microseconds(out, total_ns_);
+        out += " мкс";
+    }
+    out += "\n";
+    return out;
+}
+
+void QueryPlan::append_json(size_t index, std::string& out) const {
+    const Node& node = nodes_[index];
+    out += "{\"type\": \"";
+    out += type_name(node.type);
+    out += "\"";
+    if (node.type == NODE_TERM) {
+        out += ", \"term\": ";
+        out += StringUtils::json_quote(node.term);
+        out += ", \"postings\": ";
+        append_number(out, node.estimate);
+    } else if (node.type == NODE_RANGE) {
+        out += ", \"condition\": ";
+        out += StringUtils::json_quote(node.term);
+        out += ", \"attribute\": \"";
+        out += BooleanIndex::attribute_name(node.range.attribute);
+        out += "\", \"documents\": ";
+        append_number(out, node.estimate);
+    } else {
+        out += ", \"estimate\": ";
+        append_number(out, node.estimate);
+    }
+    out += ", \"executed\": ";
+    out += node.executed ? "true" : "false";
+    out += ", \"kernels\": [";
+    for (size_t k = 0; k < node.kernels.size(); ++k) {
+        out += k > 0 ? ", \"" : "\"";
+        out += kernel_name(node.kernels[k]);
+        out += "\"";
+    }
+    out += "], \"scanned\": ";
+    append_number(out, node.scanned);
+    out += ", \"skipped\": ";
+    append_number(out, node.skipped);
+    out += ", \"result_size\": ";
+    append_number(out, node.result_size);
+    out += ", \"time_us\": ";
+    append_microseconds(out, node.time_ns);
+
+    if (!node.children.empty()) {
+        out += ", \"children\": [";
+        for (size_t c = 0; c < node.children.size(); ++c) {
+            if (c > 0) {
+                out += ", ";
+            }
+            append_json(node.children[c], out);
+        }
+        out += "]";
+    }
+    out += "}";
+}
+
+std::string QueryPlan::to_json() const {
+    std::string out = "{\"parsed\": ";
+    out += StringUtils::json_quote(parsed_);
+    out += ", \"result_size\": ";
+    append_number(out, nodes_.empty() ? 0 : nodes_[root_].result_size);
+    out += ", \"shards\": ";
+    append_number(out, shards_);
+    out += ", \"time_us\": ";
+    append_microseconds(out, total_ns_);
+    out += ", \"plan\": ";
+    if (nodes_.empty()) {
+        out += "null";
+    } else {
+        append_json(root_, out);
+    }
+    out += "}";
+    return out;
+}
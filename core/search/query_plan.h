@@ -0,0 +1,200 @@
+#ifndef QUERY_PLAN_H
+#define QUERY_PLAN_H
+
+#include <cstdint>
+#include <string>
+#include "../index/boolean_index.h"
+#include "../utils/vector.h"
+
+/**
+ * План выполнения булева запроса
+ *
+ * Запрос разбирается слева направо, как и раньше: "a OR b AND c" - это
+ * "(a OR b) AND c", между словами без оператора подразумевается OR,
+ * NOT - разность ("a NOT b" - документы с a, но без b). Цепочки
+ * одинаковых операторов объединяются в n-арные узлы: списки AND
+ * пересекаются от самого короткого, NOT вычитает все правые операнды
+ * из левого. Для пересечения и разности выбирается ядро: слияние
+ * (merge) для списков сравнимой длины или галопирующий поиск (gallop),
+ * когда один список намного короче другого.
+ *
+ * При выполнении с профилированием для каждого узла сохраняются длины
+ * входных списков, ядро, просмотренные и пропущенные элементы, размер
+ * результата и время - план выводится текстом или в JSON (EXPLAIN).
+ *
+ * План можно выполнить на части пространства ID (execute_range):
+ * списки термов отсортированы и обрезаются бинарным поиском, а булевы
+ * операции проверяют каждый документ отдельно, поэтому результаты
+ * непересекающихся диапазонов, склеенные по порядку, совпадают
+ * с результатом по всему индексу (см. BooleanSearch).
+ *
+ * Условие на атрибут (words:>5000) - такой же операнд, как терм: его
+ * размер известен точно по порядку значений атрибута. В AND и NOT, где
+ * кандидатов уже намного меньше, чем документов условия, оно не
+ * строится списком - значение каждого кандидата проверяется по столбцу
+ * (filter), иначе документы условия собираются из столбца (range)
+ * и пересекаются или вычитаются обычными ядрами.
+ */
+class QueryPlan {
+public:
+    enum NodeType {
+        NODE_TERM,
+        NODE_RANGE,   // условие на атрибут документа (words:>5000)
+        NODE_AND,
+        NODE_OR,
+        NODE_NOT
+    };
+
+    enum Kernel {
+        KERNEL_POSTINGS,  // список документов терма
+        KERNEL_RANGE,     // документы условия из столбца атрибута
+        KERNEL_MERGE,
+        KERNEL_GALLOP,
+        KERNEL_FILTER     // проверка значения атрибута у каждого кандидата
+    };
+
+    struct Node {
+        NodeType type;
+        std::string term;         // NODE_TERM: слово из запроса
+        uint32_t term_id;         // NODE_TERM: терм индекса (INVALID_ID - нет в индексе)
+        BooleanIndex::Range range;  // NODE_RANGE: условие (term - текст из запроса)
+        Vector<size_t> children;  // индексы узлов; для NOT первый - уменьшаемое
+        size_t estimate;          // оценка размера результата (для порядка AND)
+
+        // Заполняется при выполнении (узлы после пустого промежуточного
+        // результата не выполняются)
+        bool executed;
+        Vector<Kernel> kernels;   // ядро каждого шага (n-арный узел - n-1 шагов)
+        uint64_t scanned;         // просмотрено элементов входных списков
+        uint64_t skipped;         // пропущено без сравнения (галопирующий поиск)
+        size_t result_size;
+        uint64_t time_ns;         // только при профилировании
+
+        Node();
+    };
+
+    /**
+     * Длина списка должна быть больше во столько раз, чтобы
+     * вместо слияния использовался галопирующий поиск
+     */
+    static const size_t GALLOP_RATIO = 8;
+
+    explicit QueryPlan(const BooleanIndex& index);
+
+    /**
+     * Построение плана по токенам запроса (операторы AND/OR/NOT
+     * в верхнем регистре, как их выдает BooleanSearch)
+     */
+    void build(const Vector<std::string>& tokens);
+
+    /**
+     * Выполнение плана
+     *
+     * @param profile замерять время каждого узла
+     * @return отсортированный список ID документов без повторов
+     */
+    Vector<int> execute(bool profile);
+
+    /**
+     * Выполнение плана на документах с ID в [first_id, last_id]
+     *
+     * План после build можно копировать и выполнять копии на разных
+     * диапазонах параллельно (индекс только читается).
+     */
+    Vector<int> execute_range(int first_id, int last_id, bool profile);
+
+    /**
+     * Суммарная длина списков термов запроса - оценка стоимости выполнения
+     */
+    uint64_t input_postings() const;
+
+    bool empty() const { return nodes_.empty(); }
+    size_t root() const { return root_; }
+    const Node& node(size_t index) const { return nodes_[index]; }
+
+    /**
+     * Разобранный запрос со скобками (до объединения цепочек)
+     */
+    const std::string& parsed() const { return parsed_; }
+
+    /**
+     * Время выполнения всего плана (только при профилировании)
+     */
+    uint64_t total_ns() const { return total_ns_; }
+
+    /**
+     * Сложение результатов выполнения того же запроса в другом сегменте
+     * индекса (см. ShardedIndex): счетчики, размеры и время узлов
+     * суммируются, ядра берутся из первого сегмента, где узел выполнялся.
+     * Структура узлов зависит только от токенов и совпадает.
+     */
+    void merge(const QueryPlan& other);
+
+    /**
+     * Число сегментов, сложенных в план (1 - обычный индекс)
+     */
+    size_t shards() const { return shards_; }
+
+    /**
+     * План с результатами выполнения: дерево с отступами или JSON
+     */
+    std::string to_text() const;
+    std::string to_json() const;
+
+    static const char* type_name(NodeType type);
+    static const char* kernel_name(Kernel kernel);
+
+private:
+    /**
+     * Часть отсортированного списка: список терма, обрезанный по диапазону
+     * ID, или промежуточный результат
+     */
+    struct Span {
+        const int* data;
+        size_t length;
+
+        size_t size() const { return length; }
+        bool empty() const { return length == 0; }
+        int operator[](size_t i) const { return data[i]; }
+    };
+
+    size_t add_term(const std::string& word);
+    size_t add_operator(NodeType type, size_t left, size_t right);
+
+    /**
+     * Выполнение узла: результат - часть списка терма в индексе
+     * или results_[index]
+     */
+    Span execute_node(size_t index, bool profile);
+
+    /**
+     * Ядра операций над отсортированными списками (счетчики - в node)
+     */
+    static void intersect(Span smaller, Span larger, Vector<int>& out, Node& node);
+    static void unite(Span a, Span b, Vector<int>& out, Node& node);
+    static void subtract(Span a, Span b, Vector<int>& out, Node& node);
+
+    /**
+     * Кандидаты, значение атрибута которых удовлетворяет условию
+     * (matching = false - не удовлетворяет или значения нет)
+     */
+    static void filter(Span candidates, const BooleanIndex::AttributeColumn& column,
+                       const BooleanIndex::Range& range, bool matching, Vector<int>& out, Node& node);
+
+    void append_text(size_t index, int depth, std::string& out) const;
+    void append_json(size_t index, std::string& out) const;
+
+    const BooleanIndex& index_;
+    Vector<Node> nodes_;
+    Vector<Vector<int>> results_;
+    size_t root_;
+    std::string parsed_;
+    uint64_t total_ns_;
+    size_t shards_;
+
+    // Диапазон ID текущего выполнения
+    int first_id_;
+    int last_id_;
+};
+
+#endif // QUERY_PLAN_H
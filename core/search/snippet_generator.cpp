@@ -0,0 +1,356 @@
+#include "snippet_generator.h"
+#include "../stemmer/stem_cache.h"
+#include "../tokenizer/tokenizer.h"
+#include "../utils/file_utils.h"
+#include <algorithm>
+#include <cctype>
+#include <sstream>
+
+namespace {
+
+std::string file_name_of(const std::string& path) {
+    size_t slash = path.find_last_of('/');
+    return slash == std::string::npos ? path : path.substr(slash + 1);
+}
+
+}
+
+SnippetGenerator::SnippetGenerator(const ShardedIndex& index, const Options& options)
+    : index_(index), options_(options), source_(SOURCE_FILES) {
+    if (options_.window_tokens == 0) {
+        options_.window_tokens = 1;
+    }
+}
+
+bool SnippetGenerator::set_corpus(const std::string& corpus) {
+    corpus_dir_.clear();
+    if (DocStore::is_store(corpus)) {
+        source_ = SOURCE_STORE;
+        return store_.open(corpus);
+    }
+    if (CorpusPack::is_pack(corpus)) {
+        source_ = SOURCE_PACK;
+        return pack_.open(corpus);
+    }
+    source_ = SOURCE_FILES;
+    corpus_dir_ = corpus;
+    return true;
+}
+
+Vector<std::string> SnippetGenerator::query_terms(const std::string& query) {
+    Vector<std::string> words;
+    std::stringstream ss(query);
+    std::string word;
+    while (ss >> word) {
+        words.push_back(word);
+    }
+
+    // Как в QueryPlan: оператор действует до следующего, по умолчанию OR;
+    // единственный токен - всегда слово
+    Vector<std::string> terms;
+    bool negated = false;
+    bool is_first = true;
+    for (size_t i = 0; i < words.size(); ++i) {
+        std::string upper = words[i];
+        for (size_t k = 0; k < upper.length(); ++k) {
+            upper[k] = static_cast<char>(std::toupper(static_cast<unsigned char>(upper[k])));
+        }
+        if (words.size() > 1 && (upper == "AND" || upper == "OR" || upper == "NOT")) {
+            negated = upper == "NOT";
+            continue;
+        }
+        if (negated && !is_first) {
+            continue;
+        }
+        is_first = false;
+
+        // Условие на атрибут (words:>5000) в тексте не подсвечивается
+        BooleanIndex::Range range;
+        if (BooleanIndex::parse_range(words[i], range)) {
+            continue;
+        }
+
+        // Слово поля (title:слово) подсвечивается и в тексте
+        std::string rest;
+        std::string stem = StemCache::local().stem(BooleanIndex::parse_field(words[i], rest) < 0 ? words[i] : rest);
+        if (!stem.empty() && std::find(terms.begin(), terms.end(), stem) == terms.end()) {
+            terms.push_back(stem);
+        }
+    }
+    return terms;
+}
+
+Vector<SnippetGenerator::Snippet> SnippetGenerator::generate(const std::string& query,
+                                                             const Vector<int>& doc_ids) const {
+    Vector<std::string> terms = query_terms(query);
+    Vector<Snippet> snippets;
+    snippets.reserve(doc_ids.size());
+
+    // Хранилище: страница одним обращением, каждый блок распаковывается один раз
+    Vector<DocStore::Document> stored;
+    if (source_ == SOURCE_STORE) {
+        stored = store_.fetch(doc_ids);
+    }
+
+    for (size_t i = 0; i < doc_ids.size(); ++i) {
+        int doc_id = doc_ids[i];
+        if (source_ == SOURCE_STORE) {
+            const DocStore::Document& doc = stored[i];
+            if (doc.found) {
+                DocStore::Metadata metadata;
+                metadata.title = doc.title;
+                metadata.url = doc.url;
+                metadata.word_count = doc.word_count;
+                snippets.push_back(make_snippet(doc_id, metadata, doc.text, terms));
+                continue;
+            }
+        } else if (source_ == SOURCE_PACK) {
+            CorpusPack::Document doc;
+            if (pack_.find(doc_id, doc)) {
+                snippets.push_back(make_snippet(doc_id, doc.content, terms));
+                continue;
+            }
+        } else {
+            std::string path = index_.get_document_path(doc_id);
+            if (!corpus_dir_.empty() && !path.empty()) {
+                path = corpus_dir_ + "/" + file_name_of(path);
+            }
+            FileUtils::MappedFile file;
+            if (!path.empty() && file.open(path)) {
+                snippets.push_back(make_snippet(doc_id, std::string_view(file.data(), file.size()), terms));
+                continue;
+            }
+        }
+
+        Snippet missing;
+        missing.doc_id = doc_id;
+        missing.found = false;
+        missing.matches = 0;
+        missing.word_count = 0;
+        snippets.push_back(missing);
+    }
+    return snippets;
+}
+
+SnippetGenerator::Snippet SnippetGenerator::make_snippet(int doc_id, std::string_view content,
+                                                         const Vector<std::string>& terms) const {
+    DocStore::Metadata metadata;
+    std::string_view body = DocStore::parse_header(content, metadata);
+    return make_snippet(doc_id, metadata, body, terms);
+}
+
+SnippetGenerator::Snippet SnippetGenerator::make_snippet(int doc_id, const DocStore::Metadata& metadata,
+                                                         std::string_view body,
+                                                         const Vector<std::string>& terms) const {
+    Snippet snippet;
+    snippet.doc_id = doc_id;
+    snippet.found = true;
+    snippet.matches = 0;
+    append_text(metadata.title, snippet.title);
+    snippet.url = std::string(metadata.url);
+    snippet.word_count = metadata.word_count;
+
+    // Длинный текст - только начало (по границе пробела)
+    bool truncated = false;
+    if (body.length() > options_.max_scan_bytes) {
+        size_t cut = options_.max_scan_bytes;
+        while (cut > 0 && !std::isspace(static_cast<unsigned char>(body[cut - 1]))) {
+            --cut;
+        }
+        body = body.substr(0, cut > 0 ? cut : options_.max_scan_bytes);
+        truncated = true;
+    }
+
+    // Токены с позициями; совпадение - основа токена равна терму запроса
+    // (основа - префикс слова, поэтому стемминг только при совпадении префикса)
+    Vector<size_t> token_begin;
+    Vector<size_t> token_end;
+    Vector<Match> matches;
+    StemCache& stem_cache = StemCache::local();
+    Tokenizer::for_each_token_at(body.data(), body.length(),
+                                 [&](std::string_view token, size_t offset) {
+        for (size_t t = 0; t < terms.size(); ++t) {
+            const std::string& term = terms[t];
+            if (token.length() >= term.length() && token.compare(0, term.length(), term) == 0 &&
+                stem_cache.stem_length(token) == term.length()) {
+                Match match;
+                match.token = token_begin.size();
+                match.offset = offset;
+                match.length = token.length();
+                match.term = t;
+                matches.push_back(match);
+                break;
+            }
+        }
+        token_begin.push_back(offset);
+        token_end.push_back(offset + token.length());
+    });
+    snippet.matches = matches.size();
+
+    size_t tokens = token_begin.size();
+    if (tokens == 0) {
+        return snippet;
+    }
+    size_t window = std::min(options_.window_tokens, tokens);
+
+    // Окна [первый токен, конец) в порядке выбора
+    Vector<size_t> window_first;
+    Vector<size_t> window_last;
+    Vector<bool> used;
+    used.resize(matches.size());
+    for (size_t i = 0; i < used.size(); ++i) {
+        used[i] = false;
+    }
+    Vector<size_t> term_counts;
+    term_counts.resize(terms.size());
+
+    while (window_first.size() < std::max<size_t>(options_.max_fragments, 1)) {
+        // Лучшее окно, начинающееся с совпадения: два указателя по совпадениям
+        size_t best_begin = matches.size();
+        size_t best_end = 0;
+        size_t best_distinct = 0;
+        size_t best_total = 0;
+        for (size_t t = 0; t < term_counts.size(); ++t) {
+            term_counts[t] = 0;
+        }
+        size_t distinct = 0;
+        size_t end = 0;
+        for (size_t begin = 0; begin < matches.size(); ++begin) {
+            if (end < begin) {
+                end = begin;
+            }
+            while (end < matches.size() && !used[end] &&
+                   matches[end].token < matches[begin].token + window) {
+                if (term_counts[matches[end].term]++ == 0) {
+                    ++distinct;
+                }
+                ++end;
+            }
+            if (!used[begin] && end > begin &&
+                (distinct > best_distinct || (distinct == best_distinct && end - begin > best_total))) {
+                best_begin = begin;
+                best_end = end;
+                best_distinct = distinct;
+                best_total = end - begin;
+            }
+            if (end > begin && --term_counts[matches[begin].term] == 0) {
+                --distinct;
+            }
+        }
+
+        size_t first;
+        if (best_begin == matches.size()) {
+            if (!window_first.empty()) {
+                break;
+            }
+            first = 0;  // совпадений нет - начало текста
+        } else {
+            // Совпадения окна - по центру фрагмента
+            size_t low = matches[best_begin].token;
+            size_t high = matches[best_end - 1].token;
+            size_t center = low + (high - low) / 2;
+            first = center > window / 2 ? center - window / 2 : 0;
+            first = std::min(first, low);
+            if (first + window > tokens) {
+                first = tokens - window;
+            }
+        }
+        size_t last = first + window;
+
+        bool overlaps = false;
+        for (size_t w = 0; w < window_first.size(); ++w) {
+            if (first < window_last[w] && window_first[w] < last) {
+                overlaps = true;
+            }
+        }
+        for (size_t m = best_begin; m < best_end; ++m) {
+            used[m] = true;
+        }
+        if (overlaps) {
+            continue;
+        }
+        window_first.push_back(first);
+        window_last.push_back(last);
+    }
+
+    // Фрагменты в порядке текста
+    Vector<size_t> order;
+    for (size_t w = 0; w < window_first.size(); ++w) {
+        order.push_back(w);
+    }
+    std::sort(order.begin(), order.end(), [&window_first](size_t a, size_t b) {
+        return window_first[a] < window_first[b];
+    });
+
+    size_t match = 0;
+    for (size_t k = 0; k < order.size(); ++k) {
+        size_t first = window_first[order[k]];
+        size_t last = window_last[order[k]];
+        if (k == 0 && first > 0) {
+            snippet.text += "... ";
+        } else if (k > 0) {
+            snippet.text += " ... ";
+        }
+        while (match < matches.size() && matches[match].token < first) {
+            ++match;
+        }
+        size_t match_end = match;
+        while (match_end < matches.size() && matches[match_end].token < last) {
+            ++match_end;
+        }
+        append_fragment(body, token_begin[first], token_end[last - 1], matches, match, match_end, snippet.text);
+        match = match_end;
+    }
+    if (!order.empty() && (window_last[order.back()] < tokens || truncated)) {
+        snippet.text += " ...";
+    }
+    return snippet;
+}
+
+void SnippetGenerator::append_fragment(std::string_view body, size_t begin, size_t end,
+                                       const Vector<Match>& matches, size_t first, size_t last,
+                                       std::string& out) const {
+    size_t pos = begin;
+    for (size_t m = first; m < last; ++m) {
+        const Match& match = matches[m];
+        append_text(body.substr(pos, match.offset - pos), out);
+        out += options_.open_tag;
+        append_text(body.substr(match.offset, match.length), out);
+        out += options_.close_tag;
+        pos = match.offset + match.length;
+    }
+    append_text(body.substr(pos, end - pos), out);
+}
+
+void SnippetGenerator::append_text(std::string_view text, std::string& out) const {
+    // Переводы строк и повторные пробелы - один пробел
+    bool space = false;
+    for (size_t i = 0; i < text.length(); ++i) {
+        char c = text[i];
+        if (c == ' ' || c == '\n' || c == '\r' || c == '\t') {
+            space = true;
+            continue;
+        }
+        if (space) {
+            if (!out.empty() && out.back() != ' ') {
+                out += ' ';
+            }
+            space = false;
+        }
+        if (!options_.html) {
+            out += c;
+            continue;
+        }
+        switch (c) {
+            case '&': out += "&amp;"; break;
+            case '<': out += "&lt;"; break;
+            case '>': out += "&gt;"; break;
+            case '"': out += "&quot;"; break;
+            case '\'': out += "&#39;"; break;
+            default: out += c;
+        }
+    }
+    if (space && !out.empty() && out.back() != ' ') {
+        out += ' ';
+    }
+}
@@ -0,0 +1,119 @@
+#ifndef SNIPPET_GENERATOR_H
+#define SNIPPET_GENERATOR_H
+
+#include <string>
+#include <string_view>
+#include "../index/doc_store.h"
+#include "../index/sharded_index.h"
+#include "../utils/corpus_pack.h"
+#include "../utils/vector.h"
+
+/**
+ * Сниппеты результатов поиска с подсветкой термов запроса
+ *
+ * Текст документа (после заголовка краулера) токенизируется тем же
+ * токенизатором и стеммером, что и при индексации, с позициями токенов
+ * в исходном тексте. Совпадения - токены, основа которых совпадает
+ * с основой слова запроса (слова под NOT не подсвечиваются). Окно из
+ * window_tokens токенов сдвигается по тексту, лучшее окно - с наибольшим
+ * числом разных термов запроса, затем с наибольшим числом совпадений
+ * (при равенстве - более раннее). Берется до max_fragments
+ * непересекающихся окон в порядке текста, совпадения в них обрамляются
+ * тегами, а исходные байты копируются без изменений (регистр
+ * и пунктуация сохраняются).
+ *
+ * Документ читается по пути из таблицы документов индекса; для индекса,
+ * построенного из пакета, или перенесенного корпуса задается корпус
+ * (set_corpus), в том числе хранилище документов (DocStore) - тогда
+ * файлы корпуса не читаются.
+ */
+class SnippetGenerator {
+public:
+    struct Options {
+        size_t window_tokens;    // длина фрагмента в токенах
+        size_t max_fragments;    // фрагментов в сниппете
+        size_t max_scan_bytes;   // просматривается только начало длинного текста
+        std::string open_tag;    // обрамление совпадения
+        std::string close_tag;
+        bool html;               // экранировать текст для HTML
+
+        Options()
+            : window_tokens(30), max_fragments(2), max_scan_bytes(256 * 1024),
+              open_tag("<mark>"), close_tag("</mark>"), html(true) {}
+    };
+
+    struct Snippet {
+        int doc_id;
+        bool found;          // документ удалось прочитать
+        std::string title;   // из заголовка (TITLE:), экранирован как текст
+        std::string url;
+        size_t word_count;   // из заголовка (WORDS:), 0 - нет поля
+        std::string text;    // фрагменты с подсветкой, через " ... "
+        size_t matches;      // совпадений в просмотренном тексте
+    };
+
+    SnippetGenerator(const ShardedIndex& index, const Options& options = Options());
+
+    /**
+     * Корпус для чтения документов: директория (файл берется по имени
+     * из таблицы документов), пакет или хранилище документов (по ID)
+     *
+     * @return false, если пакет или хранилище не удалось открыть
+     */
+    bool set_corpus(const std::string& corpus);
+
+    /**
+     * Сниппеты для страницы результатов (в порядке doc_ids)
+     */
+    Vector<Snippet> generate(const std::string& query, const Vector<int>& doc_ids) const;
+
+    /**
+     * Основы слов запроса для подсветки (без операторов и слов под NOT)
+     */
+    static Vector<std::string> query_terms(const std::string& query);
+
+    /**
+     * Сниппет по тексту документа (с заголовком краулера или без)
+     */
+    Snippet make_snippet(int doc_id, std::string_view content, const Vector<std::string>& terms) const;
+
+    /**
+     * Сниппет по уже разобранному заголовку и тексту
+     */
+    Snippet make_snippet(int doc_id, const DocStore::Metadata& metadata, std::string_view body,
+                         const Vector<std::string>& terms) const;
+
+private:
+    enum Source {
+        SOURCE_FILES,
+        SOURCE_PACK,
+        SOURCE_STORE
+    };
+
+    /**
+     * Совпадение: токен текста и номер терма запроса
+     */
+    struct Match {
+        size_t token;   // номер токена в тексте
+        size_t offset;  // байты в тексте
+        size_t length;
+        size_t term;
+    };
+
+    /**
+     * Фрагмент текста [begin, end) с подсветкой совпадений [first, last)
+     */
+    void append_fragment(std::string_view body, size_t begin, size_t end,
+                         const Vector<Match>& matches, size_t first, size_t last, std::string& out) const;
+
+    void append_text(std::string_view text, std::string& out) const;
+
+    const ShardedIndex& index_;
+    Options options_;
+    std::string corpus_dir_;
+    CorpusPack pack_;
+    DocStore store_;
+    Source source_;
+};
+
+#endif // SNIPPET_GENERATOR_H
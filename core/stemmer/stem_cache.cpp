@@ -0,0 +1,143 @@
+#include "stem_cache.h"
+#include "stemmer.h"
+#include <atomic>
+#include <cstring>
+
+namespace {
+
+std::atomic<size_t> default_capacity(StemCache::DEFAULT_CAPACITY);
+
+// Счетчики кешей, уже уничтоженных (например, при завершении потоков)
+std::atomic<uint64_t> retired_hits(0);
+std::atomic<uint64_t> retired_misses(0);
+std::atomic<uint64_t> retired_evictions(0);
+std::atomic<uint64_t> retired_bypassed(0);
+
+// Память таблиц существующих кешей и ее максимум
+std::atomic<size_t> live_memory(0);
+std::atomic<size_t> peak_memory(0);
+
+void add_memory(size_t bytes) {
+    size_t live = live_memory.fetch_add(bytes) + bytes;
+    size_t peak = peak_memory.load();
+    while (live > peak && !peak_memory.compare_exchange_weak(peak, live)) {
+    }
+}
+
+size_t round_up_pow2(size_t value) {
+    size_t result = 1;
+    while (result < value) {
+        result <<= 1;
+    }
+    return result;
+}
+
+uint32_t hash_word(std::string_view word) {
+    // FNV-1a
+    uint32_t h = 2166136261u;
+    for (size_t i = 0; i < word.length(); ++i) {
+        h ^= static_cast<unsigned char>(word[i]);
+        h *= 16777619u;
+    }
+    return h;
+}
+
+}  // namespace
+
+StemCache::StemCache(size_t capacity) : entries_(nullptr), mask_(0) {
+    resize(capacity);
+}
+
+StemCache::~StemCache() {
+    retired_hits += stats_.hits;
+    retired_misses += stats_.misses;
+    retired_evictions += stats_.evictions;
+    retired_bypassed += stats_.bypassed;
+    live_memory -= memory_bytes();
+    delete[] entries_;
+}
+
+void StemCache::resize(size_t capacity) {
+    size_t count = round_up_pow2(capacity < PROBE_LIMIT ? PROBE_LIMIT : capacity);
+    if (entries_ != nullptr) {
+        live_memory -= memory_bytes();
+        delete[] entries_;
+    }
+    entries_ = new Entry[count]();
+    mask_ = count - 1;
+    add_memory(memory_bytes());
+}
+
+void StemCache::clear() {
+    std::memset(static_cast<void*>(entries_), 0, (mask_ + 1) * sizeof(Entry));
+}
+
+size_t StemCache::stem_length(std::string_view word) {
+    // Короткие слова стеммер не меняет, длинные не помещаются в запись
+    if (word.length() < 4 || word.length() > MAX_KEY_LENGTH) {
+        ++stats_.bypassed;
+        return Stemmer::stem_length(word);
+    }
+
+    uint32_t h = hash_word(word);
+    size_t home = h & mask_;
+
+    for (size_t probe = 0; probe < PROBE_LIMIT; ++probe) {
+        Entry& entry = entries_[(home + probe) & mask_];
+
+        if (entry.length == 0) {
+            // Свободная запись - вычислить и запомнить
+            ++stats_.misses;
+            size_t result = Stemmer::stem_length(word);
+            entry.hash = h;
+            entry.length = static_cast<uint8_t>(word.length());
+            entry.stem_length = static_cast<uint8_t>(result);
+            std::memcpy(entry.key, word.data(), word.length());
+            return result;
+        }
+
+        if (entry.hash == h && entry.length == word.length() &&
+            std::memcmp(entry.key, word.data(), word.length()) == 0) {
+            ++stats_.hits;
+            return entry.stem_length;
+        }
+    }
+
+    // Группа проб заполнена - вытеснить запись в домашней позиции
+    ++stats_.misses;
+    ++stats_.evictions;
+    size_t result = Stemmer::stem_length(word);
+    Entry& victim = entries_[home];
+    victim.hash = h;
+    victim.length = static_cast<uint8_t>(word.length());
+    victim.stem_length = static_cast<uint8_t>(result);
+    std::memcpy(victim.key, word.data(), word.length());
+    return result;
+}
+
+StemCache& StemCache::local() {
+    thread_local StemCache cache(default_capacity.load());
+    return cache;
+}
+
+void StemCache::set_default_capacity(size_t capacity) {
+    default_capacity = capacity;
+    local().resize(capacity);
+}
+
+StemCache::Stats StemCache::total_stats() {
+    Stats total = local().stats();
+    total.hits += retired_hits;
+    total.misses += retired_misses;
+    total.evictions += retired_evictions;
+    total.bypassed += retired_bypassed;
+    return total;
+}
+
+size_t StemCache::total_memory_bytes() {
+    return live_memory.load();
+}
+
+size_t StemCache::peak_memory_bytes() {
+    return peak_memory.load();
+}
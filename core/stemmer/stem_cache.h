@@ -0,0 +1,117 @@
+#ifndef STEM_CACHE_H
+#define STEM_CACHE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+/**
+ * Кеш результатов стемминга
+ *
+ * По закону Ципфа небольшая доля словоформ дает большую часть токенов,
+ * поэтому основа запоминается для словоформы при первом вычислении.
+ * Таблица фиксированного размера с открытой адресацией: при переполнении
+ * группы проб запись вытесняется, память не растет.
+ * Хранится только длина основы (основа - префикс словоформы).
+ *
+ * Обычно используется экземпляр потока: StemCache::local().
+ */
+class StemCache {
+public:
+    static const size_t DEFAULT_CAPACITY = 64 * 1024;
+
+    /**
+     * Счетчики обращений (для подбора размера кеша)
+     */
+    struct Stats {
+        uint64_t hits;       // найдено в кеше
+        uint64_t misses;     // вычислено и добавлено
+        uint64_t evictions;  // вытеснено записей при добавлении
+        uint64_t bypassed;   // слово слишком длинное или короткое для кеша
+
+        Stats() : hits(0), misses(0), evictions(0), bypassed(0) {}
+
+        double hit_rate() const {
+            uint64_t lookups = hits + misses;
+            return lookups == 0 ? 0.0 : static_cast<double>(hits) / static_cast<double>(lookups);
+        }
+    };
+
+    /**
+     * @param capacity число записей (округляется вверх до степени двойки)
+     */
+    explicit StemCache(size_t capacity = DEFAULT_CAPACITY);
+    ~StemCache();
+
+    StemCache(const StemCache&) = delete;
+    StemCache& operator=(const StemCache&) = delete;
+
+    /**
+     * Длина основы (как Stemmer::stem_length, но с кешированием)
+     */
+    size_t stem_length(std::string_view word);
+
+    /**
+     * Основа слова (как Stemmer::stem, но с кешированием)
+     */
+    std::string stem(const std::string& word) {
+        return word.substr(0, stem_length(word));
+    }
+
+    /**
+     * Изменение размера (содержимое сбрасывается, счетчики сохраняются)
+     */
+    void resize(size_t capacity);
+
+    void clear();
+
+    size_t capacity() const { return mask_ + 1; }
+    const Stats& stats() const { return stats_; }
+    size_t memory_bytes() const { return (mask_ + 1) * sizeof(Entry); }
+
+    /**
+     * Кеш текущего потока (создается при первом обращении)
+     */
+    static StemCache& local();
+
+    /**
+     * Размер кешей потоков: применяется к кешу текущего потока
+     * и ко всем кешам, созданным позже
+     */
+    static void set_default_capacity(size_t capacity);
+
+    /**
+     * Сумма счетчиков всех кешей: завершившихся потоков и текущего
+     */
+    static Stats total_stats();
+
+    /**
+     * Память таблиц всех существующих кешей (всех потоков)
+     */
+    static size_t total_memory_bytes();
+
+    /**
+     * Наибольшая память таблиц кешей, существовавших одновременно
+     * (например, всех потоков параллельного построения)
+     */
+    static size_t peak_memory_bytes();
+
+private:
+    // Длина ключа подобрана так, чтобы запись занимала 32 байта
+    static const size_t MAX_KEY_LENGTH = 26;
+    static const size_t PROBE_LIMIT = 4;
+
+    struct Entry {
+        uint32_t hash;
+        uint8_t length;       // 0 - пустая запись
+        uint8_t stem_length;
+        char key[MAX_KEY_LENGTH];
+    };
+
+    Entry* entries_;
+    size_t mask_;
+    Stats stats_;
+};
+
+#endif // STEM_CACHE_H
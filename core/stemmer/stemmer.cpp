@@ -1,148 +1,182 @@
 #include "stemmer.h"
-#include <cstring>
+#include <cstdint>
 
-std::string Stemmer::stem(const std::string& word) {
-    if (word.empty()) {
-        return word;
-    }
-    
-    char lang = detect_language(word);
-    
-    if (lang == 'r') {
-        return stem_russian(word);
-    } else if (lang == 'e') {
-        return stem_english(word);
+// ============================================================
+// Правила стемминга (собираются в автомат при компиляции)
+// ============================================================
+
+namespace {
+
+struct SuffixRule {
+    const char* text;
+    char language;  // 'r' или 'e'
+};
+
+// Порядок не важен: автомат выбирает самое длинное подходящее окончание
+constexpr SuffixRule SUFFIX_RULES[] = {
+    // Русские окончания
+    {"\xD0\xB0\xD0\xBC\xD0\xB8", 'r'},  // "ами"
+    {"\xD1\x8F\xD0\xBC\xD0\xB8", 'r'},  // "ями"
+    {"\xD0\xBE\xD0\xB2", 'r'},          // "ов"
+    {"\xD0\xB5\xD0\xB2", 'r'},          // "ев"
+    {"\xD0\xB5\xD0\xB9", 'r'},          // "ей"
+    {"\xD0\xBE\xD0\xB9", 'r'},          // "ой"
+    {"\xD0\xBE\xD0\xBC", 'r'},          // "ом"
+    {"\xD0\xB5\xD0\xBC", 'r'},          // "ем"
+    {"\xD0\xB0\xD1\x8F", 'r'},          // "ая"
+    {"\xD0\xBE\xD0\xB5", 'r'},          // "ое"
+    {"\xD1\x8B\xD0\xB5", 'r'},          // "ые"
+    {"\xD0\xB8\xD0\xB5", 'r'},          // "ие"
+
+    // Английские окончания
+    {"ization", 'e'}, {"ation", 'e'}, {"sion", 'e'}, {"tion", 'e'},
+    {"ness", 'e'}, {"ment", 'e'}, {"ing", 'e'}, {"est", 'e'},
+    {"ed", 'e'}, {"er", 'e'}, {"ly", 'e'}, {"es", 'e'}, {"s", 'e'},
+};
+
+constexpr size_t RULE_COUNT = sizeof(SUFFIX_RULES) / sizeof(SUFFIX_RULES[0]);
+
+constexpr size_t const_length(const char* text) {
+    size_t length = 0;
+    while (text[length] != '\0') {
+        ++length;
     }
-    
-    return word;
+    return length;
 }
 
-char Stemmer::detect_language(const std::string& word) {
-    bool has_cyrillic = false;
-    bool has_latin = false;
-    
-    for (size_t i = 0; i < word.length(); ++i) {
-        unsigned char c = static_cast<unsigned char>(word[i]);
-        
-        // Проверка на кириллицу (UTF-8: 0xD0-0xD1 для русских букв)
-        if ((c >= 0xD0 && c <= 0xD1) || (c >= 0xD2 && c <= 0xD3)) {
-            has_cyrillic = true;
-        } else if ((c >= 'A' && c <= 'Z') || (c >= 'a' && c <= 'z')) {
-            has_latin = true;
-        }
-    }
-    
-    if (has_cyrillic) {
-        return 'r';
-    } else if (has_latin) {
-        return 'e';
+// Верхняя граница числа состояний: корень + по состоянию на каждый байт правил
+constexpr size_t count_max_states() {
+    size_t states = 1;
+    for (size_t i = 0; i < RULE_COUNT; ++i) {
+        states += const_length(SUFFIX_RULES[i].text);
     }
-    
-    return 'u';
+    return states;
 }
 
-std::string Stemmer::stem_russian(const std::string& word) {
-    if (word.length() < 4) {
-        return word;
-    }
-    
-    std::string result = word;
-    size_t len = result.length();
-    
-    // Список окончаний (от более длинных к коротким)
-    // Обработка UTF-8 строк требует аккуратности
-    const char* suffixes[] = {
-        "\xD0\xB0\xD0\xBC\xD0\xB8",  // "ами" (3 байта UTF-8)
-        "\xD1\x8F\xD0\xBC\xD0\xB8",  // "ями"
-        "\xD0\xBE\xD0\xB2",          // "ов"
-        "\xD0\xB5\xD0\xB2",          // "ев"
-        "\xD0\xB5\xD0\xB9",          // "ей"
-        "\xD0\xBE\xD0\xB9",          // "ой"
-        "\xD0\xBE\xD0\xBC",          // "ом"
-        "\xD0\xB5\xD0\xBC",          // "ем"
-        "\xD0\xB0\xD1\x8F",          // "ая"
-        "\xD0\xBE\xD0\xB9",          // "ой"
-        "\xD0\xBE\xD0\xB5",          // "ое"
-        "\xD1\x8B\xD0\xB5",          // "ые"
-        "\xD0\xB8\xD0\xB5",          // "ие"
-    };
-    
-    size_t suffix_lengths[] = {6, 6, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4};
-    size_t num_suffixes = sizeof(suffixes) / sizeof(suffixes[0]);
-    
-    // Попытка удалить окончания
-    for (size_t i = 0; i < num_suffixes; ++i) {
-        size_t suffix_len = suffix_lengths[i];
-        if (len > suffix_len + 2) {
-            // Проверка на совпадение окончания
-            bool matches = true;
-            for (size_t j = 0; j < suffix_len; ++j) {
-                if (result[len - suffix_len + j] != suffixes[i][j]) {
-                    matches = false;
-                    break;
+constexpr size_t MAX_STATES = count_max_states();
+static_assert(MAX_STATES <= 256, "Состояния автомата должны помещаться в uint8_t");
+
+/**
+ * Автомат для чтения слова справа налево (обратный trie окончаний)
+ *
+ * next[s][c] - переход по байту c (0 - тупик, в корень переходов нет),
+ * suffix_length[s] - длина окончания, заканчивающегося в состоянии s (0 - нет).
+ */
+struct SuffixAutomaton {
+    uint8_t next[MAX_STATES][256];
+    uint8_t suffix_length[MAX_STATES];
+    char language[MAX_STATES];
+    size_t state_count;
+
+    constexpr SuffixAutomaton() : next(), suffix_length(), language(), state_count(1) {
+        for (size_t i = 0; i < RULE_COUNT; ++i) {
+            const char* text = SUFFIX_RULES[i].text;
+            size_t length = const_length(text);
+
+            size_t state = 0;
+            for (size_t j = length; j > 0; --j) {
+                unsigned char c = static_cast<unsigned char>(text[j - 1]);
+                if (next[state][c] == 0) {
+                    next[state][c] = static_cast<uint8_t>(state_count++);
                 }
+                state = next[state][c];
             }
-            
-            if (matches) {
-                result.erase(len - suffix_len);
-                break;
-            }
+
+            suffix_length[state] = static_cast<uint8_t>(length);
+            language[state] = SUFFIX_RULES[i].language;
         }
     }
-    
-    return result;
-}
+};
 
-std::string Stemmer::stem_english(const std::string& word) {
-    if (word.length() < 4) {
-        return word;
-    }
-    
-    std::string result = word;
-    size_t len = result.length();
-    
-    // Список окончаний (от более длинных к коротким)
-    const char* suffixes[] = {
-        "ization", "ation", "sion", "tion", "ness", "ment",
-        "ing", "ed", "er", "est", "ly", "s", "es"
-    };
-    
-    size_t suffix_lengths[] = {7, 5, 4, 4, 4, 4, 3, 2, 2, 3, 2, 1, 2};
-    size_t num_suffixes = sizeof(suffixes) / sizeof(suffixes[0]);
-    
-    // Попытка удалить окончания
-    for (size_t i = 0; i < num_suffixes; ++i) {
-        size_t suffix_len = suffix_lengths[i];
-        if (len > suffix_len + 2) {
-            if (ends_with(result, suffixes[i])) {
-                result.erase(len - suffix_len);
-                break;
-            }
+constexpr SuffixAutomaton AUTOMATON;
+
+// Классы байтов для определения языка
+const uint8_t LANG_CYRILLIC = 1;
+const uint8_t LANG_LATIN = 2;
+
+struct LanguageTable {
+    uint8_t value[256];
+
+    constexpr LanguageTable() : value() {
+        // Ведущие байты кириллицы в UTF-8
+        for (int c = 0xD0; c <= 0xD3; ++c) {
+            value[c] = LANG_CYRILLIC;
+        }
+        for (int c = 'A'; c <= 'Z'; ++c) {
+            value[c] = LANG_LATIN;
+            value[c + 0x20] = LANG_LATIN;
         }
     }
-    
-    return result;
+};
+
+constexpr LanguageTable LANGUAGE;
+
+inline uint8_t language_flags(const char* data, size_t length) {
+    uint8_t flags = 0;
+    for (size_t i = 0; i < length; ++i) {
+        flags |= LANGUAGE.value[static_cast<unsigned char>(data[i])];
+    }
+    return flags;
+}
+
+}  // namespace
+
+// ============================================================
+// Stemmer
+// ============================================================
+
+std::string Stemmer::stem(const std::string& word) {
+    return word.substr(0, stem_length(word));
 }
 
-bool Stemmer::ends_with(const std::string& word, const std::string& suffix) {
-    if (word.length() < suffix.length()) {
-        return false;
+size_t Stemmer::stem_length(std::string_view word) {
+    size_t length = word.length();
+    if (length < 4) {
+        return length;
     }
-    
-    size_t start = word.length() - suffix.length();
-    for (size_t i = 0; i < suffix.length(); ++i) {
-        if (word[start + i] != suffix[i]) {
-            return false;
+
+    // Переходы автомата справа налево, пока есть путь: собираются самые
+    // длинные допустимые окончания для каждого языка. Окончание снимается,
+    // только если от слова остается больше 2 байт.
+    size_t best_russian = 0;
+    size_t best_english = 0;
+    size_t state = 0;
+
+    for (size_t i = length; i > 0; --i) {
+        state = AUTOMATON.next[state][static_cast<unsigned char>(word[i - 1])];
+        if (state == 0) {
+            break;
+        }
+
+        size_t suffix_len = AUTOMATON.suffix_length[state];
+        if (suffix_len != 0 && length > suffix_len + 2) {
+            if (AUTOMATON.language[state] == 'r') {
+                best_russian = suffix_len;
+            } else {
+                best_english = suffix_len;
+            }
         }
     }
-    
-    return true;
+
+    // Язык: без ветвлений, OR классов байтов
+    uint8_t flags = language_flags(word.data(), length);
+    if (flags & LANG_CYRILLIC) {
+        return length - best_russian;
+    } else if (flags & LANG_LATIN) {
+        return length - best_english;
+    }
+
+    return length;
 }
 
-std::string Stemmer::remove_suffix(const std::string& word, const std::string& suffix) {
-    if (!ends_with(word, suffix)) {
-        return word;
+char Stemmer::detect_language(const std::string& word) {
+    uint8_t flags = language_flags(word.data(), word.length());
+
+    if (flags & LANG_CYRILLIC) {
+        return 'r';
+    } else if (flags & LANG_LATIN) {
+        return 'e';
     }
-    
-    return word.substr(0, word.length() - suffix.length());
+
+    return 'u';
 }
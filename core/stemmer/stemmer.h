@@ -2,6 +2,7 @@
 #define STEMMER_H
 
 #include <string>
+#include <string_view>
 
 /**
  * Лабораторная работа 4: Стемминг
@@ -18,6 +19,19 @@ public:
      */
     static std::string stem(const std::string& word);
     
+    /**
+     * Длина основы слова без копирования
+     * 
+     * Стемминг только отсекает окончание, поэтому основа - это префикс
+     * word длиной stem_length(word). Язык и самое длинное подходящее
+     * окончание находятся за один проход справа налево по автомату,
+     * собранному из таблицы окончаний при компиляции.
+     * 
+     * @param word исходное слово
+     * @return длина основы в байтах
+     */
+    static size_t stem_length(std::string_view word);
+    
     /**
      * Определение языка слова (русский/английский)
      * 
@@ -25,30 +39,6 @@ public:
      * @return 'r' для русского, 'e' для английского, 'u' для неизвестного
      */
     static char detect_language(const std::string& word);
-
-private:
-    /**
-     * Стемминг русского слова
-     */
-    static std::string stem_russian(const std::string& word);
-    
-    /**
-     * Стемминг английского слова (упрощенный алгоритм Портера)
-     */
-    static std::string stem_english(const std::string& word);
-    
-    /**
-     * Проверка, заканчивается ли слово на суффикс
-     */
-    static bool ends_with(const std::string& word, const std::string& suffix);
-    
-    /**
-     * Удаление суффикса из слова
-     */
-    static std::string remove_suffix(const std::string& word, const std::string& suffix);
-    
-    // TODO: Добавить методы для обработки различных окончаний
 };
 
 #endif // STEMMER_H
-
@@ -0,0 +1,347 @@
+#include "text_kernels.h"
+
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#define TEXT_KERNELS_X86 1
+#include <immintrin.h>
+#endif
+
+// ============================================================
+// Таблицы
+// ============================================================
+
+constexpr TextKernels::CharClassTable::CharClassTable() : value() {
+    // Разделители (как isspace в локали "C")
+    value[static_cast<unsigned char>(' ')] |= CLASS_SPACE | CLASS_PUNCT;
+    value[static_cast<unsigned char>('\t')] |= CLASS_SPACE | CLASS_PUNCT;
+    value[static_cast<unsigned char>('\n')] |= CLASS_SPACE | CLASS_PUNCT;
+    value[static_cast<unsigned char>('\r')] |= CLASS_SPACE | CLASS_PUNCT;
+    value[static_cast<unsigned char>('\v')] |= CLASS_SPACE;
+    value[static_cast<unsigned char>('\f')] |= CLASS_SPACE;
+
+    // Знаки препинания (как ispunct в локали "C")
+    for (int c = 0x21; c <= 0x7E; ++c) {
+        bool alnum = (c >= '0' && c <= '9') || (c >= 'A' && c <= 'Z') || (c >= 'a' && c <= 'z');
+        if (!alnum) {
+            value[c] |= CLASS_PUNCT;
+        }
+    }
+
+    // Буквы: латиница и ведущие байты 2-байтовых символов кириллицы
+    for (int c = 'A'; c <= 'Z'; ++c) {
+        value[c] |= CLASS_LETTER;
+        value[c + 0x20] |= CLASS_LETTER;
+    }
+    for (int c = 0xD0; c <= 0xDF; ++c) {
+        value[c] |= CLASS_LETTER;
+    }
+}
+
+const TextKernels::CharClassTable TextKernels::CHAR_CLASS;
+
+namespace {
+
+// Нижний регистр для кодовой точки U+0000-U+07FF (все 2-байтовые символы UTF-8)
+constexpr uint16_t to_lower_code_point(uint16_t cp) {
+    // ASCII
+    if (cp >= 'A' && cp <= 'Z') return static_cast<uint16_t>(cp + 0x20);
+    // Latin-1 Supplement: À-Þ (кроме ×)
+    if (cp >= 0xC0 && cp <= 0xDE && cp != 0xD7) return static_cast<uint16_t>(cp + 0x20);
+    // Latin Extended-A (İ U+0130 пропускается: строчная форма 1-байтовая)
+    if (cp >= 0x100 && cp <= 0x12F && (cp & 1) == 0) return static_cast<uint16_t>(cp + 1);
+    if (cp >= 0x132 && cp <= 0x137 && (cp & 1) == 0) return static_cast<uint16_t>(cp + 1);
+    if (cp >= 0x139 && cp <= 0x148 && (cp & 1) == 1) return static_cast<uint16_t>(cp + 1);
+    if (cp >= 0x14A && cp <= 0x177 && (cp & 1) == 0) return static_cast<uint16_t>(cp + 1);
+    if (cp == 0x178) return 0xFF;
+    if (cp >= 0x179 && cp <= 0x17E && (cp & 1) == 1) return static_cast<uint16_t>(cp + 1);
+    // Греческий: Α-Ω
+    if (cp >= 0x391 && cp <= 0x3AB && cp != 0x3A2) return static_cast<uint16_t>(cp + 0x20);
+    // Кириллица: Ѐ-Џ (включая Ё), А-Я
+    if (cp >= 0x400 && cp <= 0x40F) return static_cast<uint16_t>(cp + 0x50);
+    if (cp >= 0x410 && cp <= 0x42F) return static_cast<uint16_t>(cp + 0x20);
+    // Кириллица: исторические и национальные буквы (пары заглавная/строчная)
+    if (cp >= 0x460 && cp <= 0x481 && (cp & 1) == 0) return static_cast<uint16_t>(cp + 1);
+    if (cp >= 0x48A && cp <= 0x4BF && (cp & 1) == 0) return static_cast<uint16_t>(cp + 1);
+    if (cp == 0x4C0) return 0x4CF;
+    if (cp >= 0x4C1 && cp <= 0x4CE && (cp & 1) == 1) return static_cast<uint16_t>(cp + 1);
+    if (cp >= 0x4D0 && cp <= 0x52F && (cp & 1) == 0) return static_cast<uint16_t>(cp + 1);
+    return cp;
+}
+
+struct CaseTable {
+    uint16_t lower[0x800];
+
+    constexpr CaseTable() : lower() {
+        for (uint16_t cp = 0; cp < 0x800; ++cp) {
+            lower[cp] = to_lower_code_point(cp);
+        }
+    }
+};
+
+constexpr CaseTable CASE_TABLE;
+
+inline bool is_continuation(unsigned char c) {
+    return (c & 0xC0) == 0x80;
+}
+
+/**
+ * Скалярная обработка с позиции i до stop (символ на границе может выйти за stop)
+ */
+size_t fold_scalar_range(const unsigned char* src, size_t i, size_t stop, size_t length, unsigned char* dst) {
+    while (i < stop) {
+        unsigned char c = src[i];
+        if (c < 0x80) {
+            dst[i] = static_cast<unsigned char>(CASE_TABLE.lower[c]);
+            ++i;
+        } else if (c >= 0xC2 && c <= 0xDF && i + 1 < length && is_continuation(src[i + 1])) {
+            uint16_t cp = static_cast<uint16_t>(((c & 0x1F) << 6) | (src[i + 1] & 0x3F));
+            uint16_t lower = CASE_TABLE.lower[cp];
+            dst[i] = static_cast<unsigned char>(0xC0 | (lower >> 6));
+            dst[i + 1] = static_cast<unsigned char>(0x80 | (lower & 0x3F));
+            i += 2;
+        } else {
+            dst[i] = c;
+            ++i;
+        }
+    }
+    return i;
+}
+
+#ifdef TEXT_KERNELS_X86
+
+// ------------------------------------------------------------
+// SSE2 (есть на любом x86-64)
+// ------------------------------------------------------------
+
+inline __m128i le_u8_sse2(__m128i x, __m128i limit) {
+    return _mm_cmpeq_epi8(_mm_min_epu8(x, limit), x);
+}
+
+inline __m128i space_mask_sse2(__m128i a) {
+    // ' ' или '\t'..'\r'
+    __m128i sp = _mm_cmpeq_epi8(a, _mm_set1_epi8(' '));
+    __m128i ctl = le_u8_sse2(_mm_sub_epi8(a, _mm_set1_epi8('\t')), _mm_set1_epi8(4));
+    return _mm_or_si128(sp, ctl);
+}
+
+/**
+ * Обработка 16 байт с позиции src (нужны src[-1] и src[16]).
+ * Поддерживает ASCII и основную кириллицу (ведущие байты D0/D1),
+ * для остальных символов возвращает false.
+ */
+inline bool fold_block_sse2(const unsigned char* src, unsigned char* dst) {
+    const __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src));
+    const __m128i p = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src - 1));
+    const __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + 1));
+
+    const __m128i d0 = _mm_set1_epi8(static_cast<char>(0xD0));
+    const __m128i d1 = _mm_set1_epi8(static_cast<char>(0xD1));
+    const __m128i range16 = _mm_set1_epi8(0x0F);
+
+    __m128i is_d0 = _mm_cmpeq_epi8(a, d0);
+    __m128i is_d1 = _mm_cmpeq_epi8(a, d1);
+
+    // Ведущие байты, кроме D0/D1, и D1 + (A0-BF) - в скалярный путь
+    __m128i lead = le_u8_sse2(_mm_sub_epi8(a, _mm_set1_epi8(static_cast<char>(0xC0))), _mm_set1_epi8(0x3F));
+    __m128i b_ext = le_u8_sse2(_mm_sub_epi8(b, _mm_set1_epi8(static_cast<char>(0xA0))), _mm_set1_epi8(0x1F));
+    __m128i bad = _mm_or_si128(_mm_andnot_si128(_mm_or_si128(is_d0, is_d1), lead),
+                               _mm_and_si128(is_d1, b_ext));
+    if (_mm_movemask_epi8(bad) != 0) {
+        return false;
+    }
+
+    // Ведущий байт: D0 + (80-8F | A0-AF) -> D1
+    __m128i b80 = le_u8_sse2(_mm_sub_epi8(b, _mm_set1_epi8(static_cast<char>(0x80))), range16);
+    __m128i ba0 = le_u8_sse2(_mm_sub_epi8(b, _mm_set1_epi8(static_cast<char>(0xA0))), range16);
+    __m128i lead_delta = _mm_and_si128(_mm_and_si128(is_d0, _mm_or_si128(b80, ba0)), _mm_set1_epi8(1));
+
+    // Второй байт после D0: 80-8F +0x10, 90-9F +0x20, A0-AF -0x20
+    __m128i a80 = le_u8_sse2(_mm_sub_epi8(a, _mm_set1_epi8(static_cast<char>(0x80))), range16);
+    __m128i a90 = le_u8_sse2(_mm_sub_epi8(a, _mm_set1_epi8(static_cast<char>(0x90))), range16);
+    __m128i aa0 = le_u8_sse2(_mm_sub_epi8(a, _mm_set1_epi8(static_cast<char>(0xA0))), range16);
+    __m128i cont_delta = _mm_or_si128(_mm_or_si128(_mm_and_si128(a80, _mm_set1_epi8(0x10)),
+                                                   _mm_and_si128(a90, _mm_set1_epi8(0x20))),
+                                      _mm_and_si128(aa0, _mm_set1_epi8(static_cast<char>(0xE0))));
+    cont_delta = _mm_and_si128(cont_delta, _mm_cmpeq_epi8(p, d0));
+
+    // Латиница A-Z
+    __m128i upper = le_u8_sse2(_mm_sub_epi8(a, _mm_set1_epi8('A')), _mm_set1_epi8(25));
+    __m128i ascii_delta = _mm_and_si128(upper, _mm_set1_epi8(0x20));
+
+    __m128i delta = _mm_or_si128(_mm_or_si128(lead_delta, cont_delta), ascii_delta);
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(dst), _mm_add_epi8(a, delta));
+    return true;
+}
+
+// ------------------------------------------------------------
+// AVX2 (выбирается во время выполнения)
+// ------------------------------------------------------------
+
+__attribute__((target("avx2")))
+inline __m256i le_u8_avx2(__m256i x, __m256i limit) {
+    return _mm256_cmpeq_epi8(_mm256_min_epu8(x, limit), x);
+}
+
+__attribute__((target("avx2")))
+inline __m256i space_mask_avx2(__m256i a) {
+    __m256i sp = _mm256_cmpeq_epi8(a, _mm256_set1_epi8(' '));
+    __m256i ctl = le_u8_avx2(_mm256_sub_epi8(a, _mm256_set1_epi8('\t')), _mm256_set1_epi8(4));
+    return _mm256_or_si256(sp, ctl);
+}
+
+__attribute__((target("avx2")))
+bool fold_block_avx2(const unsigned char* src, unsigned char* dst) {
+    const __m256i a = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src));
+    const __m256i p = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src - 1));
+    const __m256i b = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + 1));
+
+    const __m256i d0 = _mm256_set1_epi8(static_cast<char>(0xD0));
+    const __m256i d1 = _mm256_set1_epi8(static_cast<char>(0xD1));
+    const __m256i range16 = _mm256_set1_epi8(0x0F);
+
+    __m256i is_d0 = _mm256_cmpeq_epi8(a, d0);
+    __m256i is_d1 = _mm256_cmpeq_epi8(a, d1);
+
+    __m256i lead = le_u8_avx2(_mm256_sub_epi8(a, _mm256_set1_epi8(static_cast<char>(0xC0))), _mm256_set1_epi8(0x3F));
+    __m256i b_ext = le_u8_avx2(_mm256_sub_epi8(b, _mm256_set1_epi8(static_cast<char>(0xA0))), _mm256_set1_epi8(0x1F));
+    __m256i bad = _mm256_or_si256(_mm256_andnot_si256(_mm256_or_si256(is_d0, is_d1), lead),
+                                  _mm256_and_si256(is_d1, b_ext));
+    if (_mm256_movemask_epi8(bad) != 0) {
+        return false;
+    }
+
+    __m256i b80 = le_u8_avx2(_mm256_sub_epi8(b, _mm256_set1_epi8(static_cast<char>(0x80))), range16);
+    __m256i ba0 = le_u8_avx2(_mm256_sub_epi8(b, _mm256_set1_epi8(static_cast<char>(0xA0))), range16);
+    __m256i lead_delta = _mm256_and_si256(_mm256_and_si256(is_d0, _mm256_or_si256(b80, ba0)), _mm256_set1_epi8(1));
+
+    __m256i a80 = le_u8_avx2(_mm256_sub_epi8(a, _mm256_set1_epi8(static_cast<char>(0x80))), range16);
+    __m256i a90 = le_u8_avx2(_mm256_sub_epi8(a, _mm256_set1_epi8(static_cast<char>(0x90))), range16);
+    __m256i aa0 = le_u8_avx2(_mm256_sub_epi8(a, _mm256_set1_epi8(static_cast<char>(0xA0))), range16);
+    __m256i cont_delta = _mm256_or_si256(_mm256_or_si256(_mm256_and_si256(a80, _mm256_set1_epi8(0x10)),
+                                                         _mm256_and_si256(a90, _mm256_set1_epi8(0x20))),
+                                         _mm256_and_si256(aa0, _mm256_set1_epi8(static_cast<char>(0xE0))));
+    cont_delta = _mm256_and_si256(cont_delta, _mm256_cmpeq_epi8(p, d0));
+
+    __m256i upper = le_u8_avx2(_mm256_sub_epi8(a, _mm256_set1_epi8('A')), _mm256_set1_epi8(25));
+    __m256i ascii_delta = _mm256_and_si256(upper, _mm256_set1_epi8(0x20));
+
+    __m256i delta = _mm256_or_si256(_mm256_or_si256(lead_delta, cont_delta), ascii_delta);
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst), _mm256_add_epi8(a, delta));
+    return true;
+}
+
+__attribute__((target("avx2")))
+size_t find_space_avx2(const unsigned char* data, size_t pos, size_t length, bool want_space) {
+    while (pos + 32 <= length) {
+        __m256i a = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + pos));
+        uint32_t mask = static_cast<uint32_t>(_mm256_movemask_epi8(space_mask_avx2(a)));
+        if (!want_space) {
+            mask = ~mask;
+        }
+        if (mask != 0) {
+            return pos + static_cast<size_t>(__builtin_ctz(mask));
+        }
+        pos += 32;
+    }
+    return pos;
+}
+
+size_t find_space_sse2(const unsigned char* data, size_t pos, size_t length, bool want_space) {
+    while (pos + 16 <= length) {
+        __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + pos));
+        uint32_t mask = static_cast<uint32_t>(_mm_movemask_epi8(space_mask_sse2(a)));
+        if (!want_space) {
+            mask = ~mask & 0xFFFFu;
+        }
+        if (mask != 0) {
+            return pos + static_cast<size_t>(__builtin_ctz(mask));
+        }
+        pos += 16;
+    }
+    return pos;
+}
+
+const bool HAS_AVX2 = __builtin_cpu_supports("avx2");
+
+#endif // TEXT_KERNELS_X86
+
+}  // namespace
+
+// ============================================================
+// Поиск границ слов
+// ============================================================
+
+size_t TextKernels::skip_spaces(const char* data, size_t pos, size_t length) {
+    const unsigned char* bytes = reinterpret_cast<const unsigned char*>(data);
+#ifdef TEXT_KERNELS_X86
+    // Короткие пробелы между словами - проверить первый байт до векторного цикла
+    if (pos < length && !is_space(bytes[pos])) {
+        return pos;
+    }
+    pos = HAS_AVX2 ? find_space_avx2(bytes, pos, length, false)
+                   : find_space_sse2(bytes, pos, length, false);
+#endif
+    while (pos < length && is_space(bytes[pos])) {
+        ++pos;
+    }
+    return pos;
+}
+
+size_t TextKernels::find_space(const char* data, size_t pos, size_t length) {
+    const unsigned char* bytes = reinterpret_cast<const unsigned char*>(data);
+#ifdef TEXT_KERNELS_X86
+    pos = HAS_AVX2 ? find_space_avx2(bytes, pos, length, true)
+                   : find_space_sse2(bytes, pos, length, true);
+#endif
+    while (pos < length && !is_space(bytes[pos])) {
+        ++pos;
+    }
+    return pos;
+}
+
+// ============================================================
+// Приведение к нижнему регистру
+// ============================================================
+
+size_t TextKernels::fold_case_scalar(const char* src, size_t length, char* dst) {
+    fold_scalar_range(reinterpret_cast<const unsigned char*>(src), 0, length, length,
+                      reinterpret_cast<unsigned char*>(dst));
+    return length;
+}
+
+size_t TextKernels::fold_case(const char* src, size_t length, char* dst) {
+#ifdef TEXT_KERNELS_X86
+    if (length == 0) {
+        return 0;  // пустой токен или запрос: ни одного байта не читается
+    }
+    const unsigned char* in = reinterpret_cast<const unsigned char*>(src);
+    unsigned char* out = reinterpret_cast<unsigned char*>(dst);
+    const size_t width = HAS_AVX2 ? 32 : 16;
+
+    // Первый символ - скалярно (векторному блоку нужен байт слева)
+    size_t i = fold_scalar_range(in, 0, 1, length, out);
+
+    while (i + width + 1 <= length) {
+        bool done = HAS_AVX2 ? fold_block_avx2(in + i, out + i) : fold_block_sse2(in + i, out + i);
+        if (done) {
+            i += width;
+            continue;
+        }
+
+        // Блок с другими символами: начать с начала символа и обработать скалярно
+        if (is_continuation(in[i]) && in[i - 1] >= 0xC2 && in[i - 1] <= 0xDF) {
+            --i;
+        }
+        i = fold_scalar_range(in, i, i + width, length, out);
+    }
+
+    if (i < length) {
+        if (i > 0 && is_continuation(in[i]) && in[i - 1] >= 0xC2 && in[i - 1] <= 0xDF) {
+            --i;
+        }
+        fold_scalar_range(in, i, length, length, out);
+    }
+    return length;
+#else
+    return fold_case_scalar(src, length, dst);
+#endif
+}
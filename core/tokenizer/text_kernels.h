@@ -0,0 +1,72 @@
+#ifndef TEXT_KERNELS_H
+#define TEXT_KERNELS_H
+
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * Низкоуровневые функции обработки текста для токенизатора
+ *
+ * Внутренний цикл build_index и zipf_analysis: поиск границ слов
+ * и приведение к нижнему регистру. На x86-64 обрабатывается
+ * 16 (SSE2) или 32 (AVX2, выбирается при запуске) байта за шаг,
+ * на остальных платформах - скалярный вариант.
+ */
+class TextKernels {
+public:
+    // Классы символов (битовые флаги в таблице CHAR_CLASS)
+    static const uint8_t CLASS_SPACE = 1;   // разделитель слов
+    static const uint8_t CLASS_PUNCT = 2;   // знак препинания (удаляется по краям токена)
+    static const uint8_t CLASS_LETTER = 4;  // латинская буква или ведущий байт кириллицы
+
+    /**
+     * Таблица классов для каждого байта (строится при компиляции)
+     */
+    struct CharClassTable {
+        uint8_t value[256];
+        constexpr CharClassTable();
+    };
+
+    static const CharClassTable CHAR_CLASS;
+
+    static bool is_space(unsigned char c) {
+        return (CHAR_CLASS.value[c] & CLASS_SPACE) != 0;
+    }
+
+    static bool is_punctuation(unsigned char c) {
+        return (CHAR_CLASS.value[c] & CLASS_PUNCT) != 0;
+    }
+
+    static bool is_letter(unsigned char c) {
+        return (CHAR_CLASS.value[c] & CLASS_LETTER) != 0;
+    }
+
+    /**
+     * Позиция первого байта-не-разделителя в [pos, length) или length
+     */
+    static size_t skip_spaces(const char* data, size_t pos, size_t length);
+
+    /**
+     * Позиция первого разделителя в [pos, length) или length
+     */
+    static size_t find_space(const char* data, size_t pos, size_t length);
+
+    /**
+     * Приведение к нижнему регистру (UTF-8)
+     *
+     * Латиница (ASCII, Latin-1, Latin Extended-A), греческий и вся
+     * кириллица (U+0400-U+052F, включая Ё). Двухбайтовые последовательности
+     * обрабатываются по таблице, длина в байтах не меняется.
+     * Буферы src и dst не должны перекрываться.
+     *
+     * @return количество записанных байт (равно length)
+     */
+    static size_t fold_case(const char* src, size_t length, char* dst);
+
+    /**
+     * Скалярный вариант fold_case (используется на краях и как эталон)
+     */
+    static size_t fold_case_scalar(const char* src, size_t length, char* dst);
+};
+
+#endif // TEXT_KERNELS_H
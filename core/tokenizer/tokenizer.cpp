@@ -1,9 +1,4 @@
 #include "tokenizer.h"
-#include <cctype>
-#include <sstream>
-#include <algorithm>
-
-// STL разрешен только для токенизации (sstream, algorithm)
 
 std::vector<std::string> Tokenizer::tokenize(const std::string& text) {
     return tokenize(text, true);
@@ -16,28 +11,9 @@ std::vector<std::string> Tokenizer::tokenize(const std::string& text, bool remov
         return tokens;
     }
     
-    std::stringstream ss(text);
-    std::string word;
-    
-    // Используем STL для разбиения на слова (разрешено по требованиям)
-    while (ss >> word) {
-        if (remove_punctuation) {
-            // Удаление знаков препинания в начале и конце
-            while (!word.empty() && is_punctuation(static_cast<unsigned char>(word[0]))) {
-                word.erase(0, 1);
-            }
-            while (!word.empty() && is_punctuation(static_cast<unsigned char>(word[word.length() - 1]))) {
-                word.erase(word.length() - 1, 1);
-            }
-        }
-        
-        if (!word.empty()) {
-            std::string normalized = normalize(word);
-            if (!normalized.empty()) {
-                tokens.push_back(normalized);
-            }
-        }
-    }
+    for_each_token(text.data(), text.length(), [&tokens](std::string_view token) {
+        tokens.push_back(std::string(token));
+    }, remove_punctuation);
     
     return tokens;
 }
@@ -48,62 +24,21 @@ std::string Tokenizer::normalize(const std::string& token) {
     }
     
     std::string result;
-    result.reserve(token.length());
-    
-    for (size_t i = 0; i < token.length(); ++i) {
-        unsigned char c = static_cast<unsigned char>(token[i]);
-        
-        // Преобразование к нижнему регистру для латиницы
-        if (c >= 'A' && c <= 'Z') {
-            result += static_cast<char>(c - 'A' + 'a');
-        } else if (c >= 0xC0 && c <= 0xDF) {
-            // Русские заглавные буквы (А-Я в UTF-8, начало 2-байтового символа)
-            if (i + 1 < token.length()) {
-                unsigned char c2 = static_cast<unsigned char>(token[i + 1]);
-                // Упрощенная обработка: А (0xD0 0x90) -> а (0xD0 0xB0)
-                if (c == 0xD0 && c2 >= 0x90 && c2 <= 0xAF) {
-                    result += static_cast<char>(0xD0);
-                    result += static_cast<char>(c2 + 0x20);  // Смещение к строчным
-                    ++i;
-                } else {
-                    result += token[i];
-                }
-            } else {
-                result += token[i];
-            }
-        } else {
-            result += token[i];
-        }
-    }
-    
+    result.resize(token.length());
+    result.resize(normalize_into(token.data(), token.length(), &result[0]));
     return result;
 }
 
+size_t Tokenizer::normalize_into(const char* src, size_t length, char* dst) {
+    return TextKernels::fold_case(src, length, dst);
+}
+
 bool Tokenizer::is_letter(unsigned char c) {
-    // Английские буквы
-    if ((c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z')) {
-        return true;
-    }
-    
-    // Русские буквы (UTF-8): А-Я, а-я
-    // Это начало 2-байтового символа UTF-8
-    if (c >= 0xD0 && c <= 0xDF) {
-        return true;
-    }
-    
-    return false;
+    // Английские буквы и ведущие байты русских букв (UTF-8)
+    return TextKernels::is_letter(c);
 }
 
 bool Tokenizer::is_punctuation(unsigned char c) {
-    // Стандартные знаки препинания
-    if (std::ispunct(c) != 0) {
-        return true;
-    }
-    
-    // Пробелы и переносы строк
-    if (c == ' ' || c == '\n' || c == '\t' || c == '\r') {
-        return true;
-    }
-    
-    return false;
+    // Знаки препинания, пробелы и переносы строк
+    return TextKernels::is_punctuation(c);
 }
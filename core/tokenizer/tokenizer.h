@@ -2,10 +2,12 @@
 #define TOKENIZER_H
 
 #include <string>
+#include <string_view>
+#include <vector>
+#include "text_kernels.h"
+#include "../utils/file_utils.h"
 #include "../utils/vector.h"
 
-// TODO: Можно использовать STL для токенизации согласно требованиям
-
 /**
  * Лабораторная работа 3: Токенизация
  * Разбиение текста на слова (токены)
@@ -29,6 +31,96 @@ public:
      */
     static std::vector<std::string> tokenize(const std::string& text, bool remove_punctuation);
     
+    /**
+     * Потоковая токенизация без копирования
+     * 
+     * Сканирует непрерывный буфер (например, FileUtils::MappedFile) и передает
+     * каждый нормализованный токен в callback как std::string_view.
+     * Текст обрабатывается окнами: окно целиком приводится к нижнему регистру
+     * векторным ядром (TextKernels::fold_case), затем в нем ищутся границы слов.
+     * Токен указывает во внутренний буфер и валиден только внутри вызова callback.
+     * 
+     * @param data исходный текст в UTF-8
+     * @param length длина текста в байтах
+     * @param callback функция вида void(std::string_view token)
+     * @param remove_punctuation удалять ли знаки препинания по краям токена
+     */
+    template<typename Callback>
+    static void for_each_token(const char* data, size_t length, Callback&& callback,
+                               bool remove_punctuation = true);
+    
+    /**
+     * Потоковая токенизация с позициями токенов
+     * 
+     * То же, что for_each_token, но callback вида
+     * void(std::string_view token, size_t offset) получает еще и смещение
+     * токена в исходном тексте: нормализация не меняет длину в байтах,
+     * поэтому токен занимает data[offset, offset + token.length()).
+     */
+    template<typename Callback>
+    static void for_each_token_at(const char* data, size_t length, Callback&& callback,
+                                  bool remove_punctuation = true);
+    
+    /**
+     * Токенизация текста, поступающего фрагментами
+     * 
+     * Незаконченный токен в конце фрагмента (вместе с незаконченной
+     * UTF-8 последовательностью) переносится в следующий фрагмент.
+     * Перенос ограничен MAX_CARRY байтами: более длинный "токен"
+     * режется по границе символа UTF-8. Память не зависит от размера текста.
+     */
+    class Stream {
+    public:
+        static const size_t MAX_CARRY = 64 * 1024;
+        
+        /**
+         * Обработка очередного фрагмента
+         */
+        template<typename Callback>
+        void feed(const char* data, size_t length, Callback&& callback);
+        
+        /**
+         * Завершение текста (выдает последний токен)
+         */
+        template<typename Callback>
+        void finish(Callback&& callback);
+        
+    private:
+        /**
+         * Дописывание незаконченного токена в перенос; перенос не растет
+         * больше MAX_CARRY - заполненный выдается токенами по частям
+         */
+        template<typename Callback>
+        void append_carry(const char* data, size_t length, Callback&& callback);
+        
+        std::string carry_;
+    };
+    
+    /**
+     * Токенизация файла
+     * 
+     * Файлы до STREAM_THRESHOLD байт отображаются в память целиком,
+     * более крупные читаются фрагментами по CHUNK_SIZE байт через Stream,
+     * так что память на документ постоянна.
+     * 
+     * @return false, если файл не удалось открыть
+     */
+    template<typename Callback>
+    static bool tokenize_file(const std::string& filepath, Callback&& callback);
+    
+    static const size_t STREAM_THRESHOLD = 4 * 1024 * 1024;
+    static const size_t CHUNK_SIZE = 256 * 1024;
+    
+    /**
+     * Нормализация токена в заранее выделенный буфер
+     * 
+     * Приведение к нижнему регистру не меняет длину в байтах,
+     * поэтому dst должен вмещать length байт (буферы не перекрываются).
+     * 
+     * @return длина нормализованного токена
+     */
+    static size_t normalize_into(const char* src, size_t length, char* dst);
+    
     /**
      * Нормализация токена (приведение к нижнему регистру)
      * 
@@ -54,8 +146,163 @@ public:
     static bool is_punctuation(unsigned char c);
 
 private:
-    // TODO: Добавить вспомогательные методы при необходимости
+    // Размер окна на стеке (окно с токеном длиннее - в куче)
+    static const size_t WINDOW_SIZE = 4096;
 };
 
+template<typename Callback>
+void Tokenizer::for_each_token(const char* data, size_t length, Callback&& callback,
+                               bool remove_punctuation) {
+    for_each_token_at(data, length, [&callback](std::string_view token, size_t) {
+        callback(token);
+    }, remove_punctuation);
+}
+
+template<typename Callback>
+void Tokenizer::for_each_token_at(const char* data, size_t length, Callback&& callback,
+                                  bool remove_punctuation) {
+    char window[WINDOW_SIZE];
+    std::string long_window;
+    
+    size_t pos = 0;
+    while (pos < length) {
+        // Окно заканчивается на разделителе: токены и символы UTF-8 не разрезаются
+        size_t end = length;
+        if (length - pos > WINDOW_SIZE) {
+            end = pos + WINDOW_SIZE;
+            while (end > pos && !TextKernels::is_space(static_cast<unsigned char>(data[end - 1]))) {
+                --end;
+            }
+            if (end == pos) {
+                // Токен длиннее окна
+                end = TextKernels::find_space(data, pos + WINDOW_SIZE, length);
+            }
+        }
+        
+        size_t window_length = end - pos;
+        char* folded = window;
+        if (window_length > WINDOW_SIZE) {
+            long_window.resize(window_length);
+            folded = &long_window[0];
+        }
+        TextKernels::fold_case(data + pos, window_length, folded);
+        
+        size_t i = 0;
+        while (true) {
+            i = TextKernels::skip_spaces(folded, i, window_length);
+            if (i >= window_length) {
+                break;
+            }
+            
+            size_t start = i;
+            size_t token_end = TextKernels::find_space(folded, i, window_length);
+            i = token_end;
+            
+            if (remove_punctuation) {
+                // Удаление знаков препинания в начале и конце (сдвигом границ)
+                while (start < token_end && TextKernels::is_punctuation(static_cast<unsigned char>(folded[start]))) {
+                    ++start;
+                }
+                while (token_end > start && TextKernels::is_punctuation(static_cast<unsigned char>(folded[token_end - 1]))) {
+                    --token_end;
+                }
+            }
+            
+            if (start < token_end) {
+                callback(std::string_view(folded + start, token_end - start), pos + start);
+            }
+        }
+        
+        pos = end;
+    }
+}
+
+template<typename Callback>
+void Tokenizer::Stream::feed(const char* data, size_t length, Callback&& callback) {
+    size_t pos = 0;
+    
+    if (!carry_.empty()) {
+        // Продолжение токена из предыдущего фрагмента
+        size_t end = TextKernels::find_space(data, 0, length);
+        append_carry(data, end, callback);
+        if (end == length) {
+            return;
+        }
+        for_each_token(carry_.data(), carry_.length(), callback);
+        carry_.clear();
+        pos = end;
+    }
+    
+    // Хвост без завершающего разделителя переносится
+    size_t last = length;
+    while (last > pos && !TextKernels::is_space(static_cast<unsigned char>(data[last - 1]))) {
+        --last;
+    }
+    
+    for_each_token(data + pos, last - pos, callback);
+    append_carry(data + last, length - last, callback);
+}
+
+template<typename Callback>
+void Tokenizer::Stream::finish(Callback&& callback) {
+    if (!carry_.empty()) {
+        for_each_token(carry_.data(), carry_.length(), callback);
+        carry_.clear();
+    }
+}
+
+template<typename Callback>
+void Tokenizer::Stream::append_carry(const char* data, size_t length, Callback&& callback) {
+    size_t pos = 0;
+    while (carry_.length() + (length - pos) > MAX_CARRY) {
+        size_t take = MAX_CARRY - carry_.length();
+        carry_.append(data + pos, take);
+        pos += take;
+        
+        // Разрез по началу символа UTF-8 (не по байту продолжения);
+        // байт за заполненным переносом - data[pos]
+        size_t cut = MAX_CARRY;
+        while (cut > 0 && (static_cast<unsigned char>(cut < MAX_CARRY ? carry_[cut] : data[pos]) & 0xC0) == 0x80) {
+            --cut;
+        }
+        if (cut == 0) {
+            cut = MAX_CARRY;  // Не UTF-8 - резать по байту
+        }
+        for_each_token(carry_.data(), cut, callback);
+        carry_.erase(0, cut);
+    }
+    carry_.append(data + pos, length - pos);
+}
+
+template<typename Callback>
+bool Tokenizer::tokenize_file(const std::string& filepath, Callback&& callback) {
+    {
+        FileUtils::MappedFile file;
+        if (!file.open(filepath)) {
+            return false;
+        }
+        if (file.size() <= STREAM_THRESHOLD) {
+            for_each_token(file.data(), file.size(), callback);
+            return true;
+        }
+    }
+    
+    FileUtils::ChunkReader reader;
+    if (!reader.open(filepath)) {
+        return false;
+    }
+    
+    std::string buffer;
+    buffer.resize(CHUNK_SIZE);
+    Stream stream;
+    
+    size_t n;
+    while ((n = reader.read(&buffer[0], buffer.length())) > 0) {
+        stream.feed(buffer.data(), n, callback);
+    }
+    stream.finish(callback);
+    return true;
+}
+
 #endif // TOKENIZER_H
 
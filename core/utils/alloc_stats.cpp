@@ -0,0 +1,117 @@
+#include "alloc_stats.h"
+#include <atomic>
+#include <cstdlib>
+#include <malloc.h>
+#include <new>
+
+namespace {
+
+std::atomic<uint64_t> g_allocations(0);
+std::atomic<uint64_t> g_deallocations(0);
+std::atomic<uint64_t> g_bytes(0);
+std::atomic<int64_t> g_live_bytes(0);
+std::atomic<int64_t> g_peak_live_bytes(0);
+
+void track_live(void* ptr) {
+    if (ptr == nullptr) {
+        return;
+    }
+    int64_t size = static_cast<int64_t>(malloc_usable_size(ptr));
+    int64_t live = g_live_bytes.fetch_add(size, std::memory_order_relaxed) + size;
+    int64_t peak = g_peak_live_bytes.load(std::memory_order_relaxed);
+    while (live > peak && !g_peak_live_bytes.compare_exchange_weak(peak, live, std::memory_order_relaxed)) {
+    }
+}
+
+void* counted_alloc(size_t size) {
+    g_allocations.fetch_add(1, std::memory_order_relaxed);
+    g_bytes.fetch_add(size, std::memory_order_relaxed);
+    void* ptr = std::malloc(size == 0 ? 1 : size);
+    track_live(ptr);
+    return ptr;
+}
+
+void* counted_aligned_alloc(size_t size, size_t alignment) {
+    g_allocations.fetch_add(1, std::memory_order_relaxed);
+    g_bytes.fetch_add(size, std::memory_order_relaxed);
+    
+    // aligned_alloc требует размер, кратный выравниванию
+    size_t rounded = (size + alignment - 1) / alignment * alignment;
+    void* ptr = std::aligned_alloc(alignment, rounded == 0 ? alignment : rounded);
+    track_live(ptr);
+    return ptr;
+}
+
+void counted_free(void* ptr) {
+    if (ptr != nullptr) {
+        g_deallocations.fetch_add(1, std::memory_order_relaxed);
+        g_live_bytes.fetch_sub(static_cast<int64_t>(malloc_usable_size(ptr)), std::memory_order_relaxed);
+        std::free(ptr);
+    }
+}
+
+}
+
+AllocStats::Snapshot AllocStats::snapshot() {
+    Snapshot s;
+    s.allocations = g_allocations.load(std::memory_order_relaxed);
+    s.deallocations = g_deallocations.load(std::memory_order_relaxed);
+    s.bytes = g_bytes.load(std::memory_order_relaxed);
+    s.live_bytes = g_live_bytes.load(std::memory_order_relaxed);
+    return s;
+}
+
+uint64_t AllocStats::peak_live_bytes() {
+    return static_cast<uint64_t>(g_peak_live_bytes.load(std::memory_order_relaxed));
+}
+
+void* operator new(size_t size) {
+    void* ptr = counted_alloc(size);
+    if (ptr == nullptr) {
+        throw std::bad_alloc();
+    }
+    return ptr;
+}
+
+void* operator new[](size_t size) {
+    void* ptr = counted_alloc(size);
+    if (ptr == nullptr) {
+        throw std::bad_alloc();
+    }
+    return ptr;
+}
+
+void* operator new(size_t size, const std::nothrow_t&) noexcept {
+    return counted_alloc(size);
+}
+
+void* operator new[](size_t size, const std::nothrow_t&) noexcept {
+    return counted_alloc(size);
+}
+
+void* operator new(size_t size, std::align_val_t alignment) {
+    void* ptr = counted_aligned_alloc(size, static_cast<size_t>(alignment));
+    if (ptr == nullptr) {
+        throw std::bad_alloc();
+    }
+    return ptr;
+}
+
+void* operator new[](size_t size, std::align_val_t alignment) {
+    void* ptr = counted_aligned_alloc(size, static_cast<size_t>(alignment));
+    if (ptr == nullptr) {
+        throw std::bad_alloc();
+    }
+    return ptr;
+}
+
+void operator delete(void* ptr) noexcept { counted_free(ptr); }
+void operator delete[](void* ptr) noexcept { counted_free(ptr); }
+void operator delete(void* ptr, size_t) noexcept { counted_free(ptr); }
+void operator delete[](void* ptr, size_t) noexcept { counted_free(ptr); }
+void operator delete(void* ptr, const std::nothrow_t&) noexcept { counted_free(ptr); }
+void operator delete[](void* ptr, const std::nothrow_t&) noexcept { counted_free(ptr); }
+void operator delete(void* ptr, std::align_val_t) noexcept { counted_free(ptr); }
+void operator delete[](void* ptr, std::align_val_t) noexcept { counted_free(ptr); }
+void operator delete(void* ptr, size_t, std::align_val_t) noexcept { counted_free(ptr); }
+void operator delete[](void* ptr, size_t, std::align_val_t) noexcept { counted_free(ptr); }
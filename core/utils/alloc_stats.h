@@ -0,0 +1,48 @@
+#ifndef ALLOC_STATS_H
+#define ALLOC_STATS_H
+
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * Счетчики выделений динамической памяти
+ *
+ * alloc_stats.cpp заменяет глобальные operator new/delete и считает
+ * вызовы и запрошенные байты (атомарно, без блокировок), а также
+ * текущий объем занятой кучи - по malloc_usable_size, то есть с учетом
+ * округления блоков аллокатором. Библиотека
+ * mai_ir_alloc_stats подключается только к программам, которым нужны
+ * эти счетчики (бенчмарки, build_index) - в ядро она не входит.
+ */
+class AllocStats {
+public:
+    struct Snapshot {
+        uint64_t allocations;    // вызовов operator new
+        uint64_t deallocations;  // вызовов operator delete (не nullptr)
+        uint64_t bytes;          // запрошено байт всего
+        int64_t live_bytes;      // занято в куче сейчас (в разности - прирост)
+
+        Snapshot() : allocations(0), deallocations(0), bytes(0), live_bytes(0) {}
+
+        Snapshot operator-(const Snapshot& other) const {
+            Snapshot s;
+            s.allocations = allocations - other.allocations;
+            s.deallocations = deallocations - other.deallocations;
+            s.bytes = bytes - other.bytes;
+            s.live_bytes = live_bytes - other.live_bytes;
+            return s;
+        }
+    };
+
+    /**
+     * Текущие значения счетчиков (с начала работы программы)
+     */
+    static Snapshot snapshot();
+
+    /**
+     * Наибольший объем занятой кучи с начала работы программы
+     */
+    static uint64_t peak_live_bytes();
+};
+
+#endif // ALLOC_STATS_H
@@ -0,0 +1,163 @@
+#include "block_codec.h"
+#include <cstdint>
+#include <cstring>
+#include "vector.h"
+
+namespace {
+
+// Хеш-таблица последних позиций 4-байтовых префиксов
+const size_t HASH_BITS = 14;
+// Совпадение не начинается в последних байтах блока (там только литералы)
+const size_t LAST_LITERALS = 5;
+// Короткие копии при распаковке - словами фиксированной длины с запасом
+const size_t WILD_COPY = 16;
+
+uint32_t read32(const char* p) {
+    uint32_t value;
+    std::memcpy(&value, p, sizeof(value));
+    return value;
+}
+
+size_t hash32(uint32_t value) {
+    return (value * 2654435761u) >> (32 - HASH_BITS);
+}
+
+void write_length(size_t length, std::string& out) {
+    while (length >= 255) {
+        out += static_cast<char>(255);
+        length -= 255;
+    }
+    out += static_cast<char>(length);
+}
+
+void write_sequence(const char* literals, size_t literal_length, size_t offset, size_t match_length,
+                    std::string& out) {
+    size_t match_code = match_length > 0 ? match_length - BlockCodec::MIN_MATCH : 0;
+    unsigned char token = static_cast<unsigned char>(
+        ((literal_length < 15 ? literal_length : 15) << 4) | (match_code < 15 ? match_code : 15));
+    out += static_cast<char>(token);
+    if (literal_length >= 15) {
+        write_length(literal_length - 15, out);
+    }
+    out.append(literals, literal_length);
+    if (match_length == 0) {
+        return;
+    }
+    out += static_cast<char>(offset & 0xFF);
+    out += static_cast<char>(offset >> 8);
+    if (match_code >= 15) {
+        write_length(match_code - 15, out);
+    }
+}
+
+bool read_length(const unsigned char*& in, const unsigned char* end, size_t& length) {
+    while (true) {
+        if (in == end) {
+            return false;
+        }
+        unsigned char byte = *in++;
+        length += byte;
+        if (byte != 255) {
+            return true;
+        }
+    }
+}
+
+}
+
+void BlockCodec::compress(const char* data, size_t length, std::string& out) {
+    out.reserve(out.size() + length / 2 + 16);
+    if (length < MIN_MATCH + LAST_LITERALS) {
+        write_sequence(data, length, 0, 0, out);
+        return;
+    }
+
+    // Позиция + 1 (0 - пусто)
+    Vector<uint32_t> table;
+    table.resize(size_t(1) << HASH_BITS);
+    std::memset(table.begin(), 0, table.size() * sizeof(uint32_t));
+
+    size_t anchor = 0;
+    size_t pos = 0;
+    size_t limit = length - LAST_LITERALS;
+    while (pos + MIN_MATCH <= limit) {
+        uint32_t value = read32(data + pos);
+        size_t slot = hash32(value);
+        size_t candidate = table[slot];
+        table[slot] = static_cast<uint32_t>(pos + 1);
+
+        if (candidate == 0 || pos - (candidate - 1) > MAX_OFFSET || read32(data + candidate - 1) != value) {
+            // Несжимаемые участки проходятся с ускорением
+            pos += 1 + ((pos - anchor) >> 6);
+            continue;
+        }
+
+        size_t match = candidate - 1;
+        size_t match_length = MIN_MATCH;
+        while (pos + match_length < limit && data[match + match_length] == data[pos + match_length]) {
+            ++match_length;
+        }
+        write_sequence(data + anchor, pos - anchor, pos - match, match_length, out);
+        pos += match_length;
+        anchor = pos;
+    }
+    write_sequence(data + anchor, length - anchor, 0, 0, out);
+}
+
+bool BlockCodec::decompress(const char* data, size_t length, char* out, size_t raw_length) {
+    const unsigned char* in = reinterpret_cast<const unsigned char*>(data);
+    const unsigned char* in_end = in + length;
+    size_t written = 0;
+
+    while (in < in_end) {
+        unsigned char token = *in++;
+        size_t literal_length = token >> 4;
+        if (literal_length == 15 && !read_length(in, in_end, literal_length)) {
+            return false;
+        }
+        if (literal_length > static_cast<size_t>(in_end - in) || literal_length > raw_length - written) {
+            return false;
+        }
+        // Большинство последовательностей короткие: копия постоянной длины
+        // (лишние байты перезапишутся дальше) быстрее memcpy переменной длины
+        if (literal_length <= WILD_COPY && static_cast<size_t>(in_end - in) >= WILD_COPY &&
+            raw_length - written >= WILD_COPY) {
+            std::memcpy(out + written, in, WILD_COPY);
+        } else {
+            std::memcpy(out + written, in, literal_length);
+        }
+        in += literal_length;
+        written += literal_length;
+
+        if (in == in_end) {
+            break;  // последняя последовательность - только литералы
+        }
+        if (in_end - in < 2) {
+            return false;
+        }
+        size_t offset = static_cast<size_t>(in[0]) | (static_cast<size_t>(in[1]) << 8);
+        in += 2;
+        size_t match_length = token & 0x0F;
+        if (match_length == 15 && !read_length(in, in_end, match_length)) {
+            return false;
+        }
+        match_length += MIN_MATCH;
+        if (offset == 0 || offset > written || match_length > raw_length - written) {
+            return false;
+        }
+
+        // Совпадение может перекрывать само себя (повторы) - побайтно
+        const char* from = out + written - offset;
+        if (offset >= WILD_COPY && match_length <= WILD_COPY && raw_length - written >= WILD_COPY) {
+            std::memcpy(out + written, from, WILD_COPY);
+        } else if (offset >= match_length) {
+            std::memcpy(out + written, from, match_length);
+        } else {
+            for (size_t i = 0; i < match_length; ++i) {
+                out[written + i] = from[i];
+            }
+        }
+        written += match_length;
+    }
+    return written == raw_length;
+}
@@ -0,0 +1,39 @@
+#ifndef BLOCK_CODEC_H
+#define BLOCK_CODEC_H
+
+#include <cstddef>
+#include <string>
+
+/**
+ * Сжатие блоков байт (LZ77, формат последовательностей в духе LZ4)
+ *
+ * Блок - последовательности "литералы + совпадение":
+ *   токен        старшие 4 бита - длина литералов, младшие - длина
+ *                совпадения минус MIN_MATCH (15 - продолжение байтами
+ *                по 255 и остатком)
+ *   литералы     байты как есть
+ *   смещение     2 байта (little-endian), назад от текущей позиции
+ * Последняя последовательность - только литералы (блок кончается после них).
+ *
+ * Для текста корпуса - быстрая распаковка без внешних библиотек;
+ * сжатие хуже zlib, но один блок распаковывается за микросекунды.
+ */
+class BlockCodec {
+public:
+    static const size_t MIN_MATCH = 4;
+    static const size_t MAX_OFFSET = 65535;
+
+    /**
+     * Сжатие [data, data + length), результат дописывается в out
+     */
+    static void compress(const char* data, size_t length, std::string& out);
+
+    /**
+     * Распаковка блока ровно в raw_length байт
+     *
+     * @return false, если блок поврежден (выход за границы, не та длина)
+     */
+    static bool decompress(const char* data, size_t length, char* out, size_t raw_length);
+};
+
+#endif // BLOCK_CODEC_H
@@ -0,0 +1,187 @@
+#include "corpus_generator.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+
+namespace {
+
+// Слоги: согласная + гласная (16 x 5 = 80 на алфавит)
+const char* const LATIN_CONSONANTS[] = {
+    "b", "c", "d", "f", "g", "h", "l", "m", "n", "p", "r", "s", "t", "v", "w", "z"
+};
+const char* const LATIN_VOWELS[] = {"a", "e", "i", "o", "u"};
+const char* const CYRILLIC_CONSONANTS[] = {
+    "б", "в", "г", "д", "ж", "з", "л", "м", "н", "п", "р", "с", "т", "ф", "х", "ш"
+};
+const char* const CYRILLIC_VOWELS[] = {"а", "е", "и", "о", "у"};
+
+const size_t CONSONANTS = 16;
+const size_t VOWELS = 5;
+const size_t SYLLABLES = CONSONANTS * VOWELS;
+
+// Слова заканчиваются на "к": это не окончание ни для одного из стеммеров,
+// поэтому разные ранги не сливаются после стемминга
+const char* const LATIN_FINAL = "k";
+const char* const CYRILLIC_FINAL = "к";
+
+uint64_t mix(uint64_t value) {
+    value += 0x9E3779B97F4A7C15ull;
+    value = (value ^ (value >> 30)) * 0xBF58476D1CE4E5B9ull;
+    value = (value ^ (value >> 27)) * 0x94D049BB133111EBull;
+    return value ^ (value >> 31);
+}
+
+}
+
+uint64_t CorpusGenerator::Random::next() {
+    state_ += 0x9E3779B97F4A7C15ull;
+    uint64_t z = state_;
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+    return z ^ (z >> 31);
+}
+
+double CorpusGenerator::Random::uniform() {
+    return static_cast<double>(next() >> 11) * (1.0 / 9007199254740992.0);
+}
+
+double CorpusGenerator::Random::normal() {
+    double u1 = uniform();
+    double u2 = uniform();
+    if (u1 < 1e-300) {
+        u1 = 1e-300;
+    }
+    return std::sqrt(-2.0 * std::log(u1)) * std::cos(2.0 * M_PI * u2);
+}
+
+CorpusGenerator::CorpusGenerator(const Options& options) : options_(options) {
+    if (options_.vocabulary == 0) {
+        options_.vocabulary = 1;
+    }
+    if (options_.max_words < options_.min_words) {
+        options_.max_words = options_.min_words;
+    }
+
+    cumulative_.reserve(options_.vocabulary);
+    double total = 0.0;
+    for (size_t rank = 0; rank < options_.vocabulary; ++rank) {
+        total += 1.0 / std::pow(static_cast<double>(rank + 1), options_.zipf_exponent);
+        cumulative_.push_back(total);
+    }
+}
+
+std::string CorpusGenerator::word(size_t rank) const {
+    bool cyrillic = static_cast<double>(mix(rank ^ options_.seed) >> 11) * (1.0 / 9007199254740992.0) <
+                    options_.cyrillic_share;
+    const char* const* consonants = cyrillic ? CYRILLIC_CONSONANTS : LATIN_CONSONANTS;
+    const char* const* vowels = cyrillic ? CYRILLIC_VOWELS : LATIN_VOWELS;
+
+    // Биективная запись ранга по основанию SYLLABLES: все длины используются,
+    // разные ранги дают разные слова
+    std::string result;
+    uint64_t value = static_cast<uint64_t>(rank) + 1;
+    while (value > 0) {
+        --value;
+        size_t syllable = static_cast<size_t>(value % SYLLABLES);
+        value /= SYLLABLES;
+        result += consonants[syllable / VOWELS];
+        result += vowels[syllable % VOWELS];
+    }
+    result += cyrillic ? CYRILLIC_FINAL : LATIN_FINAL;
+    return result;
+}
+
+size_t CorpusGenerator::sample_rank(Random& random) const {
+    double target = random.uniform() * cumulative_.back();
+    const double* pos = std::upper_bound(cumulative_.begin(), cumulative_.end(), target);
+    size_t rank = static_cast<size_t>(pos - cumulative_.begin());
+    return rank < cumulative_.size() ? rank : cumulative_.size() - 1;
+}
+
+void CorpusGenerator::append_words(Random& random, size_t count, std::string& out) const {
+    // Предложения по 8-20 слов, абзацы по 4-8 предложений
+    size_t sentence_left = 8 + random.next() % 13;
+    size_t paragraph_left = 4 + random.next() % 5;
+    for (size_t i = 0; i < count; ++i) {
+        out += word(sample_rank(random));
+        if (i + 1 == count) {
+            out += ".\n";
+            break;
+        }
+        if (--sentence_left > 0) {
+            out += random.next() % 12 == 0 ? ", " : " ";
+            continue;
+        }
+        sentence_left = 8 + random.next() % 13;
+        if (--paragraph_left > 0) {
+            out += ". ";
+        } else {
+            out += ".\n\n";
+            paragraph_left = 4 + random.next() % 5;
+        }
+    }
+}
+
+std::string CorpusGenerator::file_name(int doc_id) {
+    char buffer[32];
+    std::snprintf(buffer, sizeof(buffer), "doc_%05d.txt", doc_id);
+    return buffer;
+}
+
+std::string CorpusGenerator::document(int doc_id) const {
+    Random random(mix(options_.seed) ^ mix(static_cast<uint64_t>(doc_id)));
+
+    // Длина текста: логнормальная с заданной медианой
+    double length = static_cast<double>(options_.median_words) * std::exp(options_.length_sigma * random.normal());
+    size_t words = static_cast<size_t>(length + 0.5);
+    words = std::max(options_.min_words, std::min(options_.max_words, words));
+
+    std::string title;
+    size_t title_words = 4 + random.next() % 9;
+    for (size_t i = 0; i < title_words; ++i) {
+        if (i > 0) {
+            title += ' ';
+        }
+        title += word(sample_rank(random));
+    }
+
+    std::string authors;
+    size_t author_count = 1 + random.next() % 4;
+    for (size_t i = 0; i < author_count; ++i) {
+        if (i > 0) {
+            authors += ", ";
+        }
+        // Имя и фамилия - латиница с заглавной буквы
+        for (int part = 0; part < 2; ++part) {
+            std::string name;
+            size_t syllables = 2 + random.next() % 2;
+            for (size_t s = 0; s < syllables; ++s) {
+                name += LATIN_CONSONANTS[random.next() % CONSONANTS];
+                name += LATIN_VOWELS[random.next() % VOWELS];
+            }
+            name[0] = static_cast<char>(name[0] - 'a' + 'A');
+            authors += part == 0 ? name + " " : name;
+        }
+    }
+
+    char published[32];
+    std::snprintf(published, sizeof(published), "%04d-%02d-%02dT00:00:00Z",
+                  2000 + static_cast<int>(random.next() % 25),
+                  1 + static_cast<int>(random.next() % 12),
+                  1 + static_cast<int>(random.next() % 28));
+
+    char id[32];
+    std::snprintf(id, sizeof(id), "synthetic.%07d", doc_id);
+
+    std::string out;
+    out.reserve(words * 8 + 512);
+    out += "TITLE: " + title + "\n";
+    out += "ARXIV_ID: " + std::string(id) + "\n";
+    out += "URL: https://example.org/" + std::string(id) + "\n";
+    out += "AUTHORS: " + authors + "\n";
+    out += "PUBLISHED: " + std::string(published) + "\n";
+    out += "WORDS: " + std::to_string(words) + "\n";
+    out += "\n" + std::string(80, '=') + "\n\n";
+    append_words(random, words, out);
+    return out;
+}
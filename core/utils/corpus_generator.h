@@ -0,0 +1,88 @@
+#ifndef CORPUS_GENERATOR_H
+#define CORPUS_GENERATOR_H
+
+#include <cstdint>
+#include <string>
+#include "vector.h"
+
+/**
+ * Генератор синтетического корпуса с распределением Ципфа
+ *
+ * Документы в формате краулера (TITLE/ARXIV_ID/URL/AUTHORS/PUBLISHED/WORDS,
+ * разделитель, текст) для проверки построения индекса и поиска на
+ * корпусах любого размера без сети. Слово ранга r встречается
+ * с вероятностью ~ 1/r^s; длины документов - логнормальные.
+ *
+ * Словарь детерминирован: слово ранга r - запись r слогами латиницы
+ * или кириллицы (алфавит выбирается хешем ранга), поэтому слова не
+ * повторяются, а частые слова короче. Каждый документ генерируется
+ * из собственного seed (seed корпуса + ID), так что результат не
+ * зависит от порядка и диапазона генерации.
+ */
+class CorpusGenerator {
+public:
+    struct Options {
+        size_t vocabulary;      // размер словаря (рангов)
+        double zipf_exponent;   // показатель s
+        size_t median_words;    // медиана длины документа, слов
+        double length_sigma;    // разброс логнормального распределения длины
+        size_t min_words;
+        size_t max_words;
+        double cyrillic_share;  // доля кириллических слов в словаре (0..1)
+        uint64_t seed;
+
+        Options()
+            : vocabulary(100000), zipf_exponent(1.0), median_words(2000), length_sigma(0.6),
+              min_words(200), max_words(50000), cyrillic_share(0.5), seed(42) {}
+    };
+
+    /**
+     * Детерминированный генератор (splitmix64): стандартные распределения
+     * <random> зависят от реализации библиотеки, этот - нет
+     */
+    class Random {
+    public:
+        explicit Random(uint64_t seed) : state_(seed) {}
+
+        uint64_t next();
+
+        // [0, 1)
+        double uniform();
+
+        // Стандартное нормальное (Бокс-Мюллер)
+        double normal();
+
+    private:
+        uint64_t state_;
+    };
+
+    explicit CorpusGenerator(const Options& options);
+
+    /**
+     * Слово словаря по рангу (0 - самое частое)
+     */
+    std::string word(size_t rank) const;
+
+    /**
+     * Текст документа с заголовком в формате краулера
+     */
+    std::string document(int doc_id) const;
+
+    /**
+     * Имя файла документа: doc_00001.txt
+     */
+    static std::string file_name(int doc_id);
+
+    const Options& options() const { return options_; }
+
+private:
+    size_t sample_rank(Random& random) const;
+    void append_words(Random& random, size_t count, std::string& out) const;
+
+    Options options_;
+
+    // Накопленные вероятности рангов (для выбора слова бинарным поиском)
+    Vector<double> cumulative_;
+};
+
+#endif // CORPUS_GENERATOR_H
@@ -0,0 +1,197 @@
+#include "corpus_pack.h"
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+
+const char CorpusPack::MAGIC[8] = {'M', 'A', 'I', 'P', 'A', 'C', 'K', '1'};
+
+CorpusPack::Writer::Writer() : file_(nullptr), offset_(0) {
+}
+
+CorpusPack::Writer::~Writer() {
+    if (file_ != nullptr) {
+        fclose(file_);
+    }
+}
+
+bool CorpusPack::Writer::write(const void* data, size_t length) {
+    if (length > 0 && fwrite(data, 1, length, file_) != length) {
+        return false;
+    }
+    offset_ += length;
+    return true;
+}
+
+bool CorpusPack::Writer::open(const std::string& pack_path) {
+    file_ = fopen(pack_path.c_str(), "wb");
+    if (file_ == nullptr) {
+        return false;
+    }
+    
+    // Заголовок перезаписывается в finish(), когда известна таблица
+    Header header;
+    std::memset(&header, 0, sizeof(header));
+    offset_ = 0;
+    return write(&header, sizeof(header));
+}
+
+bool CorpusPack::Writer::add(int doc_id, const std::string& name, std::string_view content) {
+    Entry entry;
+    entry.offset = offset_;
+    entry.length = content.length();
+    entry.doc_id = doc_id;
+    entry.name_length = static_cast<uint32_t>(name.length());
+    entry.name_offset = names_.length();
+    
+    if (!write(content.data(), content.length())) {
+        return false;
+    }
+    
+    names_ += name;
+    entries_.push_back(entry);
+    return true;
+}
+
+bool CorpusPack::Writer::finish() {
+    if (file_ == nullptr) {
+        return false;
+    }
+    
+    std::sort(entries_.begin(), entries_.end(),
+              [](const Entry& a, const Entry& b) { return a.doc_id < b.doc_id; });
+    
+    // Таблица выравнивается на 8 байт
+    static const char padding[8] = {0};
+    bool ok = write(padding, (8 - offset_ % 8) % 8);
+    
+    Header header;
+    std::memset(&header, 0, sizeof(header));
+    std::memcpy(header.magic, MAGIC, sizeof(MAGIC));
+    header.version = VERSION;
+    header.document_count = entries_.size();
+    header.table_offset = offset_;
+    
+    ok = ok && write(entries_.begin(), entries_.size() * sizeof(Entry));
+    header.names_offset = offset_;
+    ok = ok && write(names_.data(), names_.length());
+    
+    ok = ok && fseek(file_, 0, SEEK_SET) == 0 &&
+         fwrite(&header, 1, sizeof(header), file_) == sizeof(header);
+    
+    ok = (fclose(file_) == 0) && ok;
+    file_ = nullptr;
+    return ok;
+}
+
+CorpusPack::CorpusPack() : entries_(nullptr), names_(nullptr), names_size_(0), count_(0) {
+}
+
+bool CorpusPack::is_pack(const std::string& path) {
+    std::ifstream in(path, std::ios::binary);
+    if (!in.is_open()) {
+        return false;
+    }
+    
+    char magic[sizeof(MAGIC)];
+    if (!in.read(magic, sizeof(magic))) {
+        return false;
+    }
+    return std::memcmp(magic, MAGIC, sizeof(MAGIC)) == 0;
+}
+
+bool CorpusPack::open(const std::string& pack_path) {
+    close();
+    
+    if (!file_.open(pack_path) || file_.size() < sizeof(Header)) {
+        file_.close();
+        return false;
+    }
+    
+    Header header;
+    std::memcpy(&header, file_.data(), sizeof(header));
+    
+    uint64_t size = file_.size();
+    if (std::memcmp(header.magic, MAGIC, sizeof(MAGIC)) != 0 || header.version != VERSION ||
+        header.table_offset % 8 != 0 || header.table_offset > size ||
+        header.document_count > (size - header.table_offset) / sizeof(Entry) ||
+        header.names_offset != header.table_offset + header.document_count * sizeof(Entry)) {
+        file_.close();
+        return false;
+    }
+    
+    entries_ = reinterpret_cast<const Entry*>(file_.data() + header.table_offset);
+    names_ = file_.data() + header.names_offset;
+    names_size_ = size - header.names_offset;
+    count_ = header.document_count;
+    
+    // Проверка границ, чтобы document() мог обходиться без проверок
+    for (size_t i = 0; i < count_; ++i) {
+        const Entry& entry = entries_[i];
+        if (entry.offset > header.table_offset || entry.length > header.table_offset - entry.offset ||
+            entry.name_offset > names_size_ || entry.name_length > names_size_ - entry.name_offset ||
+            (i > 0 && entries_[i - 1].doc_id >= entry.doc_id)) {
+            close();
+            return false;
+        }
+    }
+    
+    // Таблица нужна целиком сразу
+    file_.prefetch(header.table_offset, size - header.table_offset);
+    return true;
+}
+
+void CorpusPack::close() {
+    file_.close();
+    entries_ = nullptr;
+    names_ = nullptr;
+    names_size_ = 0;
+    count_ = 0;
+}
+
+CorpusPack::Document CorpusPack::document(size_t index) const {
+    const Entry& entry = entries_[index];
+    Document doc;
+    doc.id = entry.doc_id;
+    doc.name = std::string_view(names_ + entry.name_offset, entry.name_length);
+    doc.content = std::string_view(file_.data() + entry.offset, entry.length);
+    return doc;
+}
+
+bool CorpusPack::find(int doc_id, Document& doc) const {
+    if (count_ == 0) {
+        return false;
+    }
+    
+    // Плотная нумерация: позиция вычисляется напрямую
+    int64_t guess = static_cast<int64_t>(doc_id) - entries_[0].doc_id;
+    size_t pos;
+    if (guess >= 0 && static_cast<uint64_t>(guess) < count_ && entries_[guess].doc_id == doc_id) {
+        pos = static_cast<size_t>(guess);
+    } else {
+        const Entry* it = std::lower_bound(entries_, entries_ + count_, doc_id,
+                                           [](const Entry& e, int id) { return e.doc_id < id; });
+        if (it == entries_ + count_ || it->doc_id != doc_id) {
+            return false;
+        }
+        pos = static_cast<size_t>(it - entries_);
+    }
+    
+    doc = document(pos);
+    return true;
+}
+
+void CorpusPack::prefetch(size_t first, size_t count) const {
+    if (first >= count_ || count == 0) {
+        return;
+    }
+    size_t last = std::min(first + count, count_) - 1;
+    
+    // Документы лежат в файле в порядке добавления - берем охватывающий диапазон
+    uint64_t begin = entries_[first].offset;
+    uint64_t end = entries_[first].offset + entries_[first].length;
+    for (size_t i = first + 1; i <= last; ++i) {
+        begin = std::min(begin, entries_[i].offset);
+        end = std::max(end, entries_[i].offset + entries_[i].length);
+    }
+    file_.prefetch(static_cast<size_t>(begin), static_cast<size_t>(end - begin));
+}
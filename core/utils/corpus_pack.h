@@ -0,0 +1,139 @@
+#ifndef CORPUS_PACK_H
+#define CORPUS_PACK_H
+
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <string_view>
+#include "vector.h"
+#include "file_utils.h"
+
+/**
+ * Упакованный корпус: все документы в одном файле
+ *
+ * Вместо десятков тысяч doc_*.txt - один файл, который читается
+ * последовательно через mmap и копируется по сети одним потоком.
+ *
+ * Формат (порядок байт - как на машине, где создан пакет):
+ *   заголовок    Header
+ *   данные       содержимое документов подряд
+ *   таблица      Entry[document_count], отсортирована по ID документа
+ *   имена        имена исходных файлов подряд
+ *
+ * По таблице смещений документ доступен за O(1) по позиции
+ * и по ID (для плотной нумерации, иначе - бинарный поиск).
+ */
+class CorpusPack {
+public:
+    static const char MAGIC[8];
+    static const uint32_t VERSION = 1;
+    
+    // Шаг упреждающего чтения при последовательном обходе (документов)
+    static const size_t PREFETCH_DOCUMENTS = 32;
+
+    struct Header {
+        char magic[8];
+        uint32_t version;
+        uint32_t reserved;
+        uint64_t document_count;
+        uint64_t table_offset;
+        uint64_t names_offset;
+    };
+
+    struct Entry {
+        uint64_t offset;       // начало содержимого в файле
+        uint64_t length;       // длина содержимого
+        int32_t doc_id;
+        uint32_t name_length;
+        uint64_t name_offset;  // смещение имени внутри блока имен
+    };
+
+    struct Document {
+        int id;
+        std::string_view name;     // имя исходного файла
+        std::string_view content;  // указывает в отображенный файл
+    };
+
+    /**
+     * Запись пакета (документы добавляются по одному, таблица - в finish)
+     */
+    class Writer {
+    public:
+        Writer();
+        ~Writer();
+
+        Writer(const Writer&) = delete;
+        Writer& operator=(const Writer&) = delete;
+
+        bool open(const std::string& pack_path);
+
+        /**
+         * Добавление документа (ID должны быть уникальны)
+         */
+        bool add(int doc_id, const std::string& name, std::string_view content);
+
+        /**
+         * Запись таблицы смещений и заголовка, закрытие файла
+         */
+        bool finish();
+
+        size_t document_count() const { return entries_.size(); }
+        uint64_t bytes_written() const { return offset_; }
+
+    private:
+        bool write(const void* data, size_t length);
+
+        FILE* file_;
+        uint64_t offset_;
+        Vector<Entry> entries_;
+        std::string names_;
+    };
+
+    CorpusPack();
+
+    CorpusPack(const CorpusPack&) = delete;
+    CorpusPack& operator=(const CorpusPack&) = delete;
+
+    /**
+     * Является ли файл пакетом (проверка сигнатуры)
+     */
+    static bool is_pack(const std::string& path);
+
+    /**
+     * Открытие пакета (отображение в память и проверка таблицы)
+     */
+    bool open(const std::string& pack_path);
+
+    void close();
+
+    /**
+     * Количество документов
+     */
+    size_t size() const { return count_; }
+
+    /**
+     * Документ по позиции в таблице (по возрастанию ID), O(1)
+     */
+    Document document(size_t index) const;
+
+    /**
+     * Документ по ID
+     *
+     * @return false, если документа нет
+     */
+    bool find(int doc_id, Document& doc) const;
+
+    /**
+     * Упреждающее чтение документов [first, first + count)
+     */
+    void prefetch(size_t first, size_t count) const;
+
+private:
+    FileUtils::MappedFile file_;
+    const Entry* entries_;
+    const char* names_;
+    size_t names_size_;
+    size_t count_;
+};
+
+#endif // CORPUS_PACK_H
@@ -1,24 +1,142 @@
 #include "file_utils.h"
+#include <algorithm>
+#include <atomic>
 #include <fstream>
-#include <sstream>
 #include <dirent.h>
 #include <sys/stat.h>
+#include <sys/mman.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <cerrno>
+#include <cstdio>
 #include <cstring>
 
-// Для токенизации разрешен STL
-#include <sstream>
-#include <algorithm>
+FileUtils::MappedFile::MappedFile() : data_(nullptr), size_(0) {
+}
+
+FileUtils::MappedFile::~MappedFile() {
+    close();
+}
+
+bool FileUtils::MappedFile::open(const std::string& filepath) {
+    close();
+    
+    int fd = ::open(filepath.c_str(), O_RDONLY);
+    if (fd < 0) {
+        return false;
+    }
+    
+    struct stat file_stat;
+    if (fstat(fd, &file_stat) != 0) {
+        ::close(fd);
+        return false;
+    }
+    
+    if (file_stat.st_size == 0) {
+        ::close(fd);
+        return true;
+    }
+    
+    size_t size = static_cast<size_t>(file_stat.st_size);
+    void* addr = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);  // Отображение остается валидным после закрытия дескриптора
+    
+    if (addr == MAP_FAILED) {
+        return false;
+    }
+    
+    madvise(addr, size, MADV_SEQUENTIAL);
+    
+    data_ = static_cast<const char*>(addr);
+    size_ = size;
+    return true;
+}
+
+void FileUtils::MappedFile::prefetch(size_t offset, size_t length) const {
+    if (data_ == nullptr || offset >= size_) {
+        return;
+    }
+    if (length > size_ - offset) {
+        length = size_ - offset;
+    }
+    
+    // madvise требует адрес, выровненный по странице
+    size_t page = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+    size_t begin = offset & ~(page - 1);
+    madvise(const_cast<char*>(data_) + begin, offset + length - begin, MADV_WILLNEED);
+}
+
+void FileUtils::MappedFile::close() {
+    if (data_ != nullptr) {
+        munmap(const_cast<char*>(data_), size_);
+        data_ = nullptr;
+        size_ = 0;
+    }
+}
+
+FileUtils::ChunkReader::ChunkReader() : fd_(-1) {
+}
+
+FileUtils::ChunkReader::~ChunkReader() {
+    close();
+}
+
+bool FileUtils::ChunkReader::open(const std::string& filepath) {
+    close();
+    fd_ = ::open(filepath.c_str(), O_RDONLY);
+    if (fd_ < 0) {
+        return false;
+    }
+#ifdef POSIX_FADV_SEQUENTIAL
+    posix_fadvise(fd_, 0, 0, POSIX_FADV_SEQUENTIAL);
+#endif
+    return true;
+}
+
+void FileUtils::ChunkReader::close() {
+    if (fd_ >= 0) {
+        ::close(fd_);
+        fd_ = -1;
+    }
+}
+
+size_t FileUtils::ChunkReader::read(char* buffer, size_t buffer_size) {
+    if (fd_ < 0) {
+        return 0;
+    }
+    
+    size_t total = 0;
+    while (total < buffer_size) {
+        ssize_t n = ::read(fd_, buffer + total, buffer_size - total);
+        if (n < 0 && errno == EINTR) {
+            continue;
+        }
+        if (n <= 0) {
+            break;
+        }
+        total += static_cast<size_t>(n);
+    }
+    return total;
+}
 
 std::string FileUtils::read_file(const std::string& filepath) {
-    // TODO: Чтение файла в UTF-8
-    std::ifstream file(filepath, std::ios::binary);
+    // Чтение сразу в строку нужного размера (без промежуточного буфера)
+    std::ifstream file(filepath, std::ios::binary | std::ios::ate);
     if (!file.is_open()) {
         return "";
     }
     
-    std::stringstream buffer;
-    buffer << file.rdbuf();
-    return buffer.str();
+    std::streamoff size = file.tellg();
+    if (size <= 0) {
+        return "";
+    }
+    
+    std::string content;
+    content.resize(static_cast<size_t>(size));
+    file.seekg(0);
+    file.read(&content[0], size);
+    content.resize(static_cast<size_t>(file.gcount()));
+    return content;
 }
 
 bool FileUtils::write_file(const std::string& filepath, const std::string& content) {
@@ -34,11 +152,11 @@ bool FileUtils::write_file(const std::string& filepath, const std::string& conte
 }
 
 Vector<std::string> FileUtils::list_files(const std::string& dir_path) {
-    Vector<std::string> files;
+    Vector<std::string> names;
     
     DIR* dir = opendir(dir_path.c_str());
     if (!dir) {
-        return files;
+        return names;
     }
     
     struct dirent* entry;
@@ -47,24 +165,102 @@ Vector<std::string> FileUtils::list_files(const std::string& dir_path) {
             continue;  // Пропустить скрытые файлы
         }
         
-        std::string filepath = dir_path + "/" + std::string(entry->d_name);
+        // Проверить, что это файл (stat - только если тип неизвестен)
+        bool regular = entry->d_type == DT_REG;
+        if (entry->d_type == DT_UNKNOWN || entry->d_type == DT_LNK) {
+            std::string filepath = dir_path + "/" + entry->d_name;
+            struct stat file_stat;
+            regular = stat(filepath.c_str(), &file_stat) == 0 && S_ISREG(file_stat.st_mode);
+        }
         
-        // Проверить, что это файл
-        struct stat file_stat;
-        if (stat(filepath.c_str(), &file_stat) == 0 && S_ISREG(file_stat.st_mode)) {
-            files.push_back(filepath);
+        if (regular) {
+            names.push_back(std::string(entry->d_name));
         }
     }
     
     closedir(dir);
+    
+    std::sort(names.begin(), names.end());
+    
+    Vector<std::string> files;
+    files.reserve(names.size());
+    for (size_t i = 0; i < names.size(); ++i) {
+        files.push_back(dir_path + "/" + names[i]);
+    }
     return files;
 }
 
+int FileUtils::parse_doc_id(const std::string& filepath) {
+    std::string name = get_filename(filepath);
+    
+    const char* prefix = "doc_";
+    const char* suffix = ".txt";
+    if (name.length() <= 8 || name.compare(0, 4, prefix) != 0 ||
+        name.compare(name.length() - 4, 4, suffix) != 0) {
+        return -1;
+    }
+    
+    long id = 0;
+    for (size_t i = 4; i < name.length() - 4; ++i) {
+        char c = name[i];
+        if (c < '0' || c > '9') {
+            return -1;
+        }
+        id = id * 10 + (c - '0');
+        if (id > 0x7FFFFFFF) {
+            return -1;
+        }
+    }
+    
+    // ID 0 зарезервирован (нумерация документов с 1)
+    return id > 0 ? static_cast<int>(id) : -1;
+}
+
 bool FileUtils::file_exists(const std::string& filepath) {
     struct stat buffer;
     return (stat(filepath.c_str(), &buffer) == 0);
 }
 
+bool FileUtils::create_directories(const std::string& dir_path) {
+    if (dir_path.empty()) {
+        return false;
+    }
+    // Каждый префикс до '/' - по очереди, без вызова оболочки
+    for (size_t pos = dir_path.find('/', 1); ; pos = dir_path.find('/', pos + 1)) {
+        std::string prefix = dir_path.substr(0, pos);
+        if (mkdir(prefix.c_str(), 0755) != 0 && errno != EEXIST) {
+            return false;
+        }
+        if (pos == std::string::npos) {
+            break;
+        }
+    }
+    struct stat buffer;
+    return stat(dir_path.c_str(), &buffer) == 0 && S_ISDIR(buffer.st_mode);
+}
+
+int64_t FileUtils::modified_time(const std::string& filepath) {
+    struct stat buffer;
+    if (stat(filepath.c_str(), &buffer) != 0) {
+        return -1;
+    }
+    return static_cast<int64_t>(buffer.st_mtim.tv_sec) * 1000000000 + buffer.st_mtim.tv_nsec;
+}
+
+std::string FileUtils::temporary_path(const std::string& filepath) {
+    static std::atomic<uint64_t> counter(0);
+    return filepath + ".tmp." + std::to_string(getpid()) + "." +
+           std::to_string(counter.fetch_add(1, std::memory_order_relaxed));
+}
+
+bool FileUtils::replace_file(const std::string& temporary, const std::string& filepath) {
+    if (std::rename(temporary.c_str(), filepath.c_str()) != 0) {
+        std::remove(temporary.c_str());
+        return false;
+    }
+    return true;
+}
+
 std::string FileUtils::get_filename(const std::string& filepath) {
     size_t pos = filepath.find_last_of("/\\");
     if (pos != std::string::npos) {
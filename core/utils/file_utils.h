@@ -1,6 +1,7 @@
 #ifndef FILE_UTILS_H
 #define FILE_UTILS_H
 
+#include <cstdint>
 #include <string>
 #include "../utils/vector.h"
 
@@ -9,6 +10,73 @@
  */
 class FileUtils {
 public:
+    /**
+     * Файл, отображенный в память (только чтение)
+     * 
+     * Позволяет токенизировать документ прямо из страничного кеша,
+     * без копирования в std::string.
+     */
+    class MappedFile {
+    public:
+        MappedFile();
+        ~MappedFile();
+        
+        MappedFile(const MappedFile&) = delete;
+        MappedFile& operator=(const MappedFile&) = delete;
+        
+        /**
+         * Отображение файла в память
+         * 
+         * @param filepath путь к файлу
+         * @return true при успехе (пустой файл - тоже успех, size() == 0)
+         */
+        bool open(const std::string& filepath);
+        
+        /**
+         * Снятие отображения
+         */
+        void close();
+        
+        const char* data() const { return data_; }
+        size_t size() const { return size_; }
+        
+        /**
+         * Подсказка ядру: диапазон [offset, offset + length) скоро понадобится
+         * (асинхронное чтение страниц, MADV_WILLNEED)
+         */
+        void prefetch(size_t offset, size_t length) const;
+        
+    private:
+        const char* data_;
+        size_t size_;
+    };
+    
+
+    /**
+     * Последовательное чтение файла фрагментами фиксированного размера
+     */
+    class ChunkReader {
+    public:
+        ChunkReader();
+        ~ChunkReader();
+        
+        ChunkReader(const ChunkReader&) = delete;
+        ChunkReader& operator=(const ChunkReader&) = delete;
+        
+        bool open(const std::string& filepath);
+        void close();
+        
+        /**
+         * Чтение следующего фрагмента
+         * 
+         * @return число прочитанных байт (0 - конец файла или ошибка)
+         */
+        size_t read(char* buffer, size_t buffer_size);
+        
+    private:
+        int fd_;
+    };
+    
     /**
      * Чтение файла в строку (UTF-8)
      */
@@ -21,14 +89,54 @@ public:
     
     /**
      * Получение списка всех файлов в директории
+     * 
+     * Тип записи берется из d_type (stat только для DT_UNKNOWN и ссылок),
+     * список отсортирован по имени - порядок не зависит от файловой системы.
      */
     static Vector<std::string> list_files(const std::string& dir_path);
     
+    /**
+     * ID документа из имени файла вида doc_NNNNN.txt (путь допускается)
+     * 
+     * @return ID документа или -1, если имя не соответствует шаблону
+     */
+    static int parse_doc_id(const std::string& filepath);
+    
     /**
      * Проверка существования файла
      */
     static bool file_exists(const std::string& filepath);
     
+    /**
+     * Создание директории вместе с недостающими родительскими (как mkdir -p)
+     * 
+     * @return true, если директория создана или уже существует
+     */
+    static bool create_directories(const std::string& dir_path);
+    
+    /**
+     * Время изменения файла (наносекунды от эпохи, -1 - файла нет)
+     */
+    static int64_t modified_time(const std::string& filepath);
+    
+    /**
+     * Временный файл для записи вместо filepath (рядом, в той же директории)
+     * 
+     * Имя уникально для каждого вызова (PID и номер вызова): параллельные
+     * писатели одного filepath не пишут в общий временный файл. Полученное
+     * имя нужно сохранить до replace_file.
+     */
+    static std::string temporary_path(const std::string& filepath);
+    
+    /**
+     * Атомарная замена filepath записанным временным файлом (rename)
+     * 
+     * Процессы, открывшие или отобразившие старый файл, продолжают
+     * читать его содержимое, новые открытия видят только готовый файл.
+     * При ошибке временный файл удаляется.
+     */
+    static bool replace_file(const std::string& temporary, const std::string& filepath);
+    
     /**
      * Получение имени файла без пути
      */
@@ -0,0 +1,111 @@
+#include "latency_histogram.h"
+#include <cmath>
+
+namespace {
+
+const uint64_t SUB_BUCKETS = 1ull << LatencyHistogram::SUB_BUCKET_BITS;
+const uint64_t HALF_BUCKETS = SUB_BUCKETS / 2;
+
+int highest_bit(uint64_t value) {
+    return 63 - __builtin_clzll(value);
+}
+
+}
+
+LatencyHistogram::LatencyHistogram() {
+    counts_.resize(bucket_index(UINT64_MAX) + 1);
+    reset();
+}
+
+void LatencyHistogram::reset() {
+    for (size_t i = 0; i < counts_.size(); ++i) {
+        counts_[i] = 0;
+    }
+    count_ = 0;
+    min_ = UINT64_MAX;
+    max_ = 0;
+    sum_ = 0.0;
+}
+
+size_t LatencyHistogram::bucket_index(uint64_t value) {
+    if (value < SUB_BUCKETS) {
+        return static_cast<size_t>(value);
+    }
+    // value = top << shift, top в [HALF_BUCKETS, SUB_BUCKETS)
+    int shift = highest_bit(value) - (SUB_BUCKET_BITS - 1);
+    uint64_t top = value >> shift;
+    return static_cast<size_t>(shift * HALF_BUCKETS + top);
+}
+
+uint64_t LatencyHistogram::bucket_upper_bound(size_t index) {
+    if (index < SUB_BUCKETS) {
+        return index;
+    }
+    uint64_t shift = index / HALF_BUCKETS - 1;
+    uint64_t top = index - shift * HALF_BUCKETS;
+    if (top + 1 > (UINT64_MAX >> shift)) {
+        return UINT64_MAX;
+    }
+    return ((top + 1) << shift) - 1;
+}
+
+void LatencyHistogram::record(uint64_t value) {
+    ++counts_[bucket_index(value)];
+    ++count_;
+    sum_ += static_cast<double>(value);
+    if (value < min_) {
+        min_ = value;
+    }
+    if (value > max_) {
+        max_ = value;
+    }
+}
+
+void LatencyHistogram::merge(const LatencyHistogram& other) {
+    for (size_t i = 0; i < counts_.size(); ++i) {
+        counts_[i] += other.counts_[i];
+    }
+    count_ += other.count_;
+    sum_ += other.sum_;
+    if (other.min_ < min_) {
+        min_ = other.min_;
+    }
+    if (other.max_ > max_) {
+        max_ = other.max_;
+    }
+}
+
+double LatencyHistogram::mean() const {
+    return count_ == 0 ? 0.0 : sum_ / static_cast<double>(count_);
+}
+
+uint64_t LatencyHistogram::percentile(double p) const {
+    if (count_ == 0) {
+        return 0;
+    }
+    if (p <= 0.0) {
+        return min_;
+    }
+    
+    uint64_t rank = static_cast<uint64_t>(std::ceil(p / 100.0 * static_cast<double>(count_)));
+    if (rank < 1) {
+        rank = 1;
+    }
+    if (rank >= count_) {
+        return max_;
+    }
+    
+    uint64_t seen = 0;
+    for (size_t i = 0; i < counts_.size(); ++i) {
+        seen += counts_[i];
+        if (seen >= rank) {
+            uint64_t bound = bucket_upper_bound(i);
+            // Граница корзины не должна выходить за наблюдаемый диапазон
+            if (bound > max_) {
+                return max_;
+            }
+            return bound < min_ ? min_ : bound;
+        }
+    }
+    return max_;
+}
@@ -0,0 +1,56 @@
+#ifndef LATENCY_HISTOGRAM_H
+#define LATENCY_HISTOGRAM_H
+
+#include <cstdint>
+#include "vector.h"
+
+/**
+ * Гистограмма задержек с логарифмически-линейными корзинами (как HDR Histogram)
+ *
+ * Значения до 2^SUB_BUCKET_BITS хранятся точно, дальше каждый интервал
+ * [2^k, 2^(k+1)) делится на 2^(SUB_BUCKET_BITS-1) равных корзин -
+ * относительная ошибка перцентилей не больше 2^-(SUB_BUCKET_BITS-1)
+ * (0.8%) во всем диапазоне uint64. Память фиксирована (~60 КБ),
+ * запись - O(1) без выделений. Гистограммы потоков объединяются merge().
+ */
+class LatencyHistogram {
+public:
+    static const int SUB_BUCKET_BITS = 8;
+
+    LatencyHistogram();
+
+    /**
+     * Запись значения (например, задержки в наносекундах)
+     */
+    void record(uint64_t value);
+
+    /**
+     * Добавление всех значений другой гистограммы
+     */
+    void merge(const LatencyHistogram& other);
+
+    void reset();
+
+    uint64_t count() const { return count_; }
+    uint64_t min() const { return count_ == 0 ? 0 : min_; }
+    uint64_t max() const { return max_; }
+    double mean() const;
+
+    /**
+     * Значение перцентиля (0..100): верхняя граница корзины,
+     * в которую попадает значение с рангом ceil(p/100 * count)
+     */
+    uint64_t percentile(double p) const;
+
+private:
+    static size_t bucket_index(uint64_t value);
+    static uint64_t bucket_upper_bound(size_t index);
+
+    Vector<uint64_t> counts_;
+    uint64_t count_;
+    uint64_t min_;
+    uint64_t max_;
+    double sum_;
+};
+
+#endif // LATENCY_HISTOGRAM_H
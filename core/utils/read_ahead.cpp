@@ -0,0 +1,144 @@
+#include "read_ahead.h"
+#include <cerrno>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+ReadAheadReader::ReadAheadReader(const Vector<std::string>& files, const Options& options)
+    : files_(files), options_(options), next_to_read_(0), next_to_return_(0), released_(0),
+      stopping_(false), bytes_read_(0) {
+    size_t slot_count = options_.depth == 0 ? 1 : options_.depth;
+    slots_.resize(slot_count);
+    for (size_t i = 0; i < slot_count; ++i) {
+        slots_[i].ready = false;
+    }
+
+    if (options_.depth > 0) {
+        size_t thread_count = options_.threads == 0 ? 1 : options_.threads;
+        if (thread_count > options_.depth) {
+            thread_count = options_.depth;
+        }
+        for (size_t i = 0; i < thread_count; ++i) {
+            threads_.push_back(std::thread(&ReadAheadReader::worker, this));
+        }
+    }
+}
+
+ReadAheadReader::~ReadAheadReader() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopping_ = true;
+    }
+    slot_free_.notify_all();
+    for (size_t i = 0; i < threads_.size(); ++i) {
+        threads_[i].join();
+    }
+}
+
+void ReadAheadReader::read_file(size_t index, Slot& slot) {
+    Item& item = slot.item;
+    item.index = index;
+    item.path = &files_[index];
+    item.status = READ_ERROR;
+    item.data = std::string_view();
+    item.file_size = 0;
+
+    int fd = ::open(files_[index].c_str(), O_RDONLY);
+    if (fd < 0) {
+        return;
+    }
+
+    struct stat file_stat;
+    if (fstat(fd, &file_stat) != 0) {
+        ::close(fd);
+        return;
+    }
+
+    size_t size = static_cast<size_t>(file_stat.st_size);
+    item.file_size = size;
+    if (size > options_.max_file_size) {
+        ::close(fd);
+        item.status = READ_TOO_LARGE;
+        return;
+    }
+
+#ifdef POSIX_FADV_WILLNEED
+    posix_fadvise(fd, 0, 0, POSIX_FADV_WILLNEED);
+#endif
+
+    // Буфер ячейки переиспользуется: после прогрева выделений памяти нет
+    if (slot.buffer.size() < size) {
+        slot.buffer.resize(size);
+    }
+
+    size_t total = 0;
+    while (total < size) {
+        ssize_t n = pread(fd, &slot.buffer[0] + total, size - total, static_cast<off_t>(total));
+        if (n < 0 && errno == EINTR) {
+            continue;
+        }
+        if (n <= 0) {
+            break;
+        }
+        total += static_cast<size_t>(n);
+    }
+    ::close(fd);
+
+    item.data = std::string_view(slot.buffer.data(), total);
+    item.status = READ_OK;
+}
+
+void ReadAheadReader::worker() {
+    std::unique_lock<std::mutex> lock(mutex_);
+
+    while (true) {
+        // Следующий файл можно читать, когда его ячейка освобождена потребителем
+        slot_free_.wait(lock, [this] {
+            return stopping_ || next_to_read_ >= files_.size() ||
+                   next_to_read_ < released_ + slots_.size();
+        });
+        if (stopping_ || next_to_read_ >= files_.size()) {
+            return;
+        }
+
+        size_t index = next_to_read_++;
+        Slot& slot = slots_[index % slots_.size()];
+
+        lock.unlock();
+        read_file(index, slot);
+        lock.lock();
+
+        bytes_read_.fetch_add(slot.item.status == READ_OK ? slot.item.data.size() : 0, std::memory_order_relaxed);
+        slot.ready = true;
+        slot_ready_.notify_all();
+    }
+}
+
+const ReadAheadReader::Item* ReadAheadReader::next() {
+    std::unique_lock<std::mutex> lock(mutex_);
+
+    // Освободить ячейку, выданную в прошлый раз
+    if (released_ < next_to_return_) {
+        slots_[released_ % slots_.size()].ready = false;
+        ++released_;
+        slot_free_.notify_all();
+    }
+
+    if (next_to_return_ >= files_.size()) {
+        return nullptr;
+    }
+
+    size_t index = next_to_return_++;
+    Slot& slot = slots_[index % slots_.size()];
+
+    if (threads_.empty()) {
+        // Синхронный режим
+        lock.unlock();
+        read_file(index, slot);
+        bytes_read_.fetch_add(slot.item.status == READ_OK ? slot.item.data.size() : 0, std::memory_order_relaxed);
+        return &slot.item;
+    }
+
+    slot_ready_.wait(lock, [&slot] { return slot.ready; });
+    return &slot.item;
+}
@@ -0,0 +1,94 @@
+#ifndef READ_AHEAD_H
+#define READ_AHEAD_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include "vector.h"
+
+/**
+ * Конвейер упреждающего чтения файлов корпуса
+ *
+ * Фоновые потоки читают файлы (open + posix_fadvise + pread) в буферы,
+ * пока основной поток обрабатывает уже прочитанные. Одновременно в работе
+ * не больше depth файлов: кольцо из depth ячеек служит ограниченной
+ * очередью между стадиями. Файлы выдаются строго в порядке списка.
+ */
+class ReadAheadReader {
+public:
+    struct Options {
+        size_t depth;          // файлов в работе одновременно (0 - синхронное чтение)
+        size_t threads;        // потоков чтения
+        size_t max_file_size;  // файлы крупнее не буферизуются (READ_TOO_LARGE)
+
+        Options() : depth(16), threads(4), max_file_size(4 * 1024 * 1024) {}
+    };
+
+    enum Status {
+        READ_OK,
+        READ_TOO_LARGE,  // читать самостоятельно (например, потоково)
+        READ_ERROR
+    };
+
+    struct Item {
+        size_t index;             // позиция в списке файлов
+        const std::string* path;
+        Status status;
+        std::string_view data;    // содержимое при READ_OK
+        size_t file_size;
+    };
+
+    ReadAheadReader(const Vector<std::string>& files, const Options& options = Options());
+    ~ReadAheadReader();
+
+    ReadAheadReader(const ReadAheadReader&) = delete;
+    ReadAheadReader& operator=(const ReadAheadReader&) = delete;
+
+    /**
+     * Следующий файл по порядку (ждет, пока он будет прочитан)
+     *
+     * Возвращенный элемент валиден до следующего вызова next().
+     *
+     * @return nullptr, если файлы закончились
+     */
+    const Item* next();
+
+    /**
+     * Всего прочитано байт (можно опрашивать, пока потоки читают)
+     */
+    uint64_t bytes_read() const { return bytes_read_.load(std::memory_order_relaxed); }
+
+private:
+    struct Slot {
+        std::string buffer;
+        Item item;
+        bool ready;
+    };
+
+    void worker();
+    void read_file(size_t index, Slot& slot);
+
+    const Vector<std::string>& files_;
+    Options options_;
+
+    Vector<Slot> slots_;
+    Vector<std::thread> threads_;
+
+    std::mutex mutex_;
+    std::condition_variable slot_ready_;  // ячейка заполнена
+    std::condition_variable slot_free_;   // ячейка освобождена
+
+    size_t next_to_read_;    // следующий файл для потоков чтения
+    size_t next_to_return_;  // следующий файл для потребителя
+    size_t released_;        // файлов, ячейки которых возвращены потребителем
+    bool stopping_;
+
+    // Пишется потоками чтения, читается потребителем без блокировки
+    std::atomic<uint64_t> bytes_read_;
+};
+
+#endif // READ_AHEAD_H
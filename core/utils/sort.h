@@ -2,7 +2,9 @@
 #define SORT_H
 
 #include "vector.h"
+#include <algorithm>
 #include <functional>
+#include <thread>
 
 /**
  * Алгоритмы сортировки (без STL)
@@ -28,7 +30,60 @@ public:
         }
     }
     
+    /**
+     * Параллельная сортировка: части сортируются в отдельных потоках,
+     * затем попарно сливаются (тоже параллельно, деревом)
+     * 
+     * Порядок равных элементов не гарантируется - компаратор должен
+     * задавать строгий полный порядок, если нужен детерминированный результат.
+     */
+    template<typename Compare>
+    static void parallel_sort(Vector<T>& arr, Compare compare, size_t threads) {
+        size_t n = arr.size();
+        if (threads <= 1 || n < threads * PARALLEL_MIN_PART) {
+            std::sort(arr.begin(), arr.end(), compare);
+            return;
+        }
+        
+        // Границы частей
+        Vector<size_t> bounds;
+        for (size_t i = 0; i <= threads; ++i) {
+            bounds.push_back(n * i / threads);
+        }
+        
+        Vector<std::thread> workers;
+        for (size_t i = 0; i < threads; ++i) {
+            T* first = arr.begin() + bounds[i];
+            T* last = arr.begin() + bounds[i + 1];
+            workers.push_back(std::thread([first, last, &compare] {
+                std::sort(first, last, compare);
+            }));
+        }
+        for (size_t i = 0; i < workers.size(); ++i) {
+            workers[i].join();
+        }
+        
+        // Слияние соседних частей: threads -> threads/2 -> ... -> 1
+        for (size_t step = 1; step < threads; step *= 2) {
+            Vector<std::thread> round;
+            for (size_t i = 0; i + step < threads; i += 2 * step) {
+                T* first = arr.begin() + bounds[i];
+                T* middle = arr.begin() + bounds[i + step];
+                T* last = arr.begin() + bounds[std::min(i + 2 * step, threads)];
+                round.push_back(std::thread([first, middle, last, &compare] {
+                    std::inplace_merge(first, middle, last, compare);
+                }));
+            }
+            for (size_t i = 0; i < round.size(); ++i) {
+                round[i].join();
+            }
+        }
+    }
+    
 private:
+    // Меньшие части сортируются в одном потоке
+    static const size_t PARALLEL_MIN_PART = 4096;
+    
     static int partition(Vector<T>& arr, int left, int right, 
                         bool (*compare)(const T&, const T&)) {
         T pivot = arr[right];
@@ -1,5 +1,6 @@
 #include "string_utils.h"
 #include <cctype>
+#include <cstdio>
 
 Vector<std::string> StringUtils::split(const std::string& str, char delimiter) {
     Vector<std::string> result;
@@ -81,3 +82,25 @@ bool StringUtils::ends_with(const std::string& str, const std::string& suffix) {
     return str.compare(str.length() - suffix.length(), suffix.length(), suffix) == 0;
 }
 
+std::string StringUtils::json_quote(const std::string& str) {
+    std::string out;
+    out.reserve(str.length() + 2);
+    out += '"';
+    for (size_t i = 0; i < str.length(); ++i) {
+        unsigned char c = static_cast<unsigned char>(str[i]);
+        if (c == '"' || c == '\\') {
+            out += '\\';
+            out += static_cast<char>(c);
+        } else if (c == '\n') {
+            out += "\\n";
+        } else if (c < 0x20) {
+            char buffer[8];
+            std::snprintf(buffer, sizeof(buffer), "\\u%04x", c);
+            out += buffer;
+        } else {
+            out += static_cast<char>(c);
+        }
+    }
+    out += '"';
+    return out;
+}
@@ -38,6 +38,11 @@ public:
      * Проверка, заканчивается ли строка на подстроку
      */
     static bool ends_with(const std::string& str, const std::string& suffix);
+    
+    /**
+     * Строка в кавычках для JSON (с экранированием)
+     */
+    static std::string json_quote(const std::string& str);
 };
 
 #endif // STRING_UTILS_H
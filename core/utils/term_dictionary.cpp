@@ -0,0 +1,132 @@
+#include "term_dictionary.h"
+#include <cstring>
+
+TermDictionary::TermDictionary() : current_chunk_(nullptr), chunk_used_(CHUNK_SIZE), arena_bytes_(0), slot_mask_(INITIAL_SLOTS - 1) {
+    slots_ = new uint32_t[INITIAL_SLOTS]();
+}
+
+TermDictionary::~TermDictionary() {
+    for (size_t i = 0; i < chunks_.size(); ++i) {
+        delete[] chunks_[i];
+    }
+    delete[] slots_;
+}
+
+uint32_t TermDictionary::hash_term(std::string_view term) {
+    // FNV-1a
+    uint32_t h = 2166136261u;
+    for (size_t i = 0; i < term.length(); ++i) {
+        h ^= static_cast<unsigned char>(term[i]);
+        h *= 16777619u;
+    }
+    return h;
+}
+
+const char* TermDictionary::store(std::string_view term) {
+    if (term.length() > CHUNK_SIZE) {
+        // Очень длинный терм - отдельный блок
+        char* block = new char[term.length()];
+        std::memcpy(block, term.data(), term.length());
+        chunks_.push_back(block);
+        arena_bytes_ += term.length();
+        return block;
+    }
+
+    if (current_chunk_ == nullptr || chunk_used_ + term.length() > CHUNK_SIZE) {
+        current_chunk_ = new char[CHUNK_SIZE];
+        chunks_.push_back(current_chunk_);
+        chunk_used_ = 0;
+        arena_bytes_ += CHUNK_SIZE;
+    }
+
+    char* dst = current_chunk_ + chunk_used_;
+    std::memcpy(dst, term.data(), term.length());
+    chunk_used_ += term.length();
+    return dst;
+}
+
+void TermDictionary::grow_table() {
+    size_t new_count = (slot_mask_ + 1) * 2;
+    uint32_t* new_slots = new uint32_t[new_count]();
+    size_t new_mask = new_count - 1;
+
+    for (size_t id = 0; id < terms_.size(); ++id) {
+        size_t pos = terms_[id].hash & new_mask;
+        while (new_slots[pos] != 0) {
+            pos = (pos + 1) & new_mask;
+        }
+        new_slots[pos] = static_cast<uint32_t>(id + 1);
+    }
+
+    delete[] slots_;
+    slots_ = new_slots;
+    slot_mask_ = new_mask;
+}
+
+uint32_t TermDictionary::find(std::string_view term) const {
+    uint32_t h = hash_term(term);
+    size_t pos = h & slot_mask_;
+
+    while (slots_[pos] != 0) {
+        const TermRef& ref = terms_[slots_[pos] - 1];
+        if (ref.hash == h && ref.length == term.length() &&
+            std::memcmp(ref.data, term.data(), term.length()) == 0) {
+            return slots_[pos] - 1;
+        }
+        pos = (pos + 1) & slot_mask_;
+    }
+
+    return INVALID_ID;
+}
+
+uint32_t TermDictionary::intern(std::string_view term) {
+    uint32_t h = hash_term(term);
+    size_t pos = h & slot_mask_;
+
+    while (slots_[pos] != 0) {
+        const TermRef& ref = terms_[slots_[pos] - 1];
+        if (ref.hash == h && ref.length == term.length() &&
+            std::memcmp(ref.data, term.data(), term.length()) == 0) {
+            return slots_[pos] - 1;
+        }
+        pos = (pos + 1) & slot_mask_;
+    }
+
+    // Новый терм
+    uint32_t id = static_cast<uint32_t>(terms_.size());
+    TermRef ref;
+    ref.data = store(term);
+    ref.length = static_cast<uint32_t>(term.length());
+    ref.hash = h;
+    terms_.push_back(ref);
+    slots_[pos] = id + 1;
+
+    // Коэффициент заполнения не выше 1/2
+    if (terms_.size() * 2 > slot_mask_ + 1) {
+        grow_table();
+    }
+
+    return id;
+}
+
+void TermDictionary::clear() {
+    for (size_t i = 0; i < chunks_.size(); ++i) {
+        delete[] chunks_[i];
+    }
+    chunks_.clear();
+    current_chunk_ = nullptr;
+    chunk_used_ = CHUNK_SIZE;
+    arena_bytes_ = 0;
+    terms_.clear();
+
+    delete[] slots_;
+    slots_ = new uint32_t[INITIAL_SLOTS]();
+    slot_mask_ = INITIAL_SLOTS - 1;
+}
+
+size_t TermDictionary::memory_bytes() const {
+    return arena_bytes_ +
+           terms_.capacity() * sizeof(TermRef) +
+           chunks_.capacity() * sizeof(char*) +
+           (slot_mask_ + 1) * sizeof(uint32_t);
+}
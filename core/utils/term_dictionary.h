@@ -0,0 +1,105 @@
+#ifndef TERM_DICTIONARY_H
+#define TERM_DICTIONARY_H
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include "vector.h"
+
+/**
+ * Словарь термов с интернированием строк
+ *
+ * Каждая уникальная строка хранится в арене ровно один раз и получает
+ * 32-битный идентификатор (0, 1, 2, ...). Дальше по конвейеру
+ * (индексатор, анализ Ципфа) передаются только идентификаторы,
+ * а постинги и таблицы частот становятся плотными массивами по term id.
+ *
+ * Поиск: открытая адресация с линейным пробированием.
+ */
+class TermDictionary {
+public:
+    static const uint32_t INVALID_ID = 0xFFFFFFFFu;
+
+    TermDictionary();
+    ~TermDictionary();
+
+    TermDictionary(const TermDictionary&) = delete;
+    TermDictionary& operator=(const TermDictionary&) = delete;
+
+    /**
+     * Получение идентификатора терма (терм добавляется, если его еще нет)
+     *
+     * @param term строка терма
+     * @return идентификатор терма
+     */
+    uint32_t intern(std::string_view term);
+
+    /**
+     * Поиск идентификатора без добавления
+     *
+     * @return идентификатор или INVALID_ID
+     */
+    uint32_t find(std::string_view term) const;
+
+    /**
+     * Строка терма по идентификатору (указывает в арену, валидна до clear())
+     */
+    std::string_view term(uint32_t id) const {
+        const TermRef& ref = terms_[id];
+        return std::string_view(ref.data, ref.length);
+    }
+
+    /**
+     * Количество термов
+     */
+    size_t size() const {
+        return terms_.size();
+    }
+
+    /**
+     * Удаление всех термов и освобождение арены
+     */
+    void clear();
+
+    /**
+     * Объем памяти, занимаемой словарем (арена + таблицы), в байтах
+     */
+    size_t memory_bytes() const;
+
+    /**
+     * Из них хеш-таблица слотов (накладные расходы поиска)
+     */
+    size_t hash_table_bytes() const {
+        return (slot_mask_ + 1) * sizeof(uint32_t);
+    }
+
+private:
+    struct TermRef {
+        const char* data;
+        uint32_t length;
+        uint32_t hash;
+    };
+
+    static const size_t CHUNK_SIZE = 64 * 1024;
+    static const size_t INITIAL_SLOTS = 1024;
+
+    static uint32_t hash_term(std::string_view term);
+
+    const char* store(std::string_view term);
+    void grow_table();
+
+    // Арена: список блоков, строки внутри блока не перемещаются
+    Vector<char*> chunks_;
+    char* current_chunk_;
+    size_t chunk_used_;
+    size_t arena_bytes_;
+
+    // id -> строка
+    Vector<TermRef> terms_;
+
+    // Хеш-таблица: (id + 1) или 0 для пустой ячейки
+    uint32_t* slots_;
+    size_t slot_mask_;
+};
+
+#endif // TERM_DICTIONARY_H
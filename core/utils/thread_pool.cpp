@@ -0,0 +1,176 @@
+#include "thread_pool.h"
+
+namespace {
+
+uint64_t pack_range(uint64_t begin, uint64_t end) {
+    return (begin << 32) | end;
+}
+
+uint64_t range_begin(uint64_t range) {
+    return range >> 32;
+}
+
+uint64_t range_end(uint64_t range) {
+    return range & 0xFFFFFFFFull;
+}
+
+}
+
+ThreadPool::ThreadPool(size_t threads) : stop_(false) {
+    for (size_t i = 0; i < threads; ++i) {
+        workers_.push_back(std::thread(&ThreadPool::worker_loop, this, i));
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stop_ = true;
+    }
+    work_available_.notify_all();
+    for (size_t i = 0; i < workers_.size(); ++i) {
+        workers_[i].join();
+    }
+}
+
+size_t ThreadPool::default_threads() {
+    size_t cores = std::thread::hardware_concurrency();
+    return cores == 0 ? 1 : cores;
+}
+
+bool ThreadPool::has_work(const Job& job) {
+    for (size_t i = 0; i < job.participants; ++i) {
+        uint64_t range = job.ranges[i].load(std::memory_order_acquire);
+        if (range_begin(range) < range_end(range)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+bool ThreadPool::steal(Job& job, size_t participant) {
+    while (true) {
+        // Жертва - участник с самой большой оставшейся частью
+        size_t victim = job.participants;
+        uint64_t victim_range = 0;
+        uint64_t largest = 0;
+        for (size_t i = 0; i < job.participants; ++i) {
+            if (i == participant) {
+                continue;
+            }
+            uint64_t range = job.ranges[i].load(std::memory_order_acquire);
+            uint64_t left = range_end(range) > range_begin(range) ? range_end(range) - range_begin(range) : 0;
+            if (left > largest) {
+                largest = left;
+                victim = i;
+                victim_range = range;
+            }
+        }
+        if (victim == job.participants) {
+            return false;
+        }
+
+        // Половина с конца (последний индекс - целиком)
+        uint64_t begin = range_begin(victim_range);
+        uint64_t end = range_end(victim_range);
+        uint64_t split = end - (largest + 1) / 2;
+        if (job.ranges[victim].compare_exchange_weak(victim_range, pack_range(begin, split),
+                                                     std::memory_order_acq_rel)) {
+            // Своя часть пуста, ее никто не меняет - достаточно записи
+            job.ranges[participant].store(pack_range(split, end), std::memory_order_release);
+            return true;
+        }
+    }
+}
+
+size_t ThreadPool::run(Job& job, size_t participant) {
+    std::atomic<uint64_t>& own = job.ranges[participant];
+    size_t executed = 0;
+    while (true) {
+        uint64_t range = own.load(std::memory_order_acquire);
+        uint64_t begin = range_begin(range);
+        if (begin >= range_end(range)) {
+            if (!steal(job, participant)) {
+                return executed;
+            }
+            continue;
+        }
+        if (own.compare_exchange_weak(range, pack_range(begin + 1, range_end(range)), std::memory_order_acq_rel)) {
+            (*job.fn)(static_cast<size_t>(begin));
+            ++executed;
+        }
+    }
+}
+
+void ThreadPool::parallel_for(size_t count, const std::function<void(size_t)>& fn) {
+    if (count == 0) {
+        return;
+    }
+    if (count == 1 || workers_.empty() || count > 0xFFFFFFFFull) {
+        for (size_t i = 0; i < count; ++i) {
+            fn(i);
+        }
+        return;
+    }
+
+    Job job;
+    job.fn = &fn;
+    job.count = count;
+    job.participants = workers_.size() + 1;
+    job.ranges.reset(new std::atomic<uint64_t>[job.participants]);
+    for (size_t i = 0; i < job.participants; ++i) {
+        uint64_t begin = static_cast<uint64_t>(i * count / job.participants);
+        uint64_t end = static_cast<uint64_t>((i + 1) * count / job.participants);
+        job.ranges[i].store(pack_range(begin, end), std::memory_order_relaxed);
+    }
+    job.done = 0;
+    job.helpers = 0;
+
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        queue_.push_back(&job);
+    }
+    work_available_.notify_all();
+
+    size_t executed = run(job, 0);
+
+    std::unique_lock<std::mutex> lock(mutex_);
+    // Вся работа разобрана - задание больше не нужно в очереди
+    for (size_t i = 0; i < queue_.size(); ++i) {
+        if (queue_[i] == &job) {
+            queue_.erase(queue_.begin() + static_cast<std::ptrdiff_t>(i));
+            break;
+        }
+    }
+    job.done += executed;
+    // Задание живет на стеке: ждать и завершения вызовов, и ухода помощников
+    job_finished_.wait(lock, [&job] { return job.done == job.count && job.helpers == 0; });
+}
+
+void ThreadPool::worker_loop(size_t worker) {
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (true) {
+        work_available_.wait(lock, [this] { return stop_ || !queue_.empty(); });
+        if (stop_) {
+            return;
+        }
+
+        Job* job = queue_.front();
+        if (!has_work(*job)) {
+            // Работа разобрана - убрать из очереди, завершит владелец
+            queue_.pop_front();
+            continue;
+        }
+        ++job->helpers;
+        lock.unlock();
+
+        size_t executed = run(*job, worker + 1);
+
+        lock.lock();
+        job->done += executed;
+        --job->helpers;
+        if (job->done == job->count && job->helpers == 0) {
+            job_finished_.notify_all();
+        }
+    }
+}
@@ -0,0 +1,89 @@
+#ifndef THREAD_POOL_H
+#define THREAD_POOL_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include "vector.h"
+
+/**
+ * Пул потоков с перехватом работы (work stealing) для параллельных циклов
+ *
+ * parallel_for(count, fn) выполняет fn(0) ... fn(count - 1) на потоках
+ * пула и в вызывающем потоке и возвращается, когда все вызовы
+ * завершились. Индексы заранее делятся на непрерывные части по числу
+ * участников (соседние индексы - например, соседние диапазоны ID -
+ * обрабатываются одним потоком); участник берет индексы с начала своей
+ * части, а закончив, перехватывает половину с конца самой большой
+ * оставшейся части другого участника. Поток, занятый другим заданием,
+ * свою часть не задерживает - ее разберут остальные.
+ *
+ * Можно вызывать одновременно из нескольких потоков (например, из
+ * потоков-клиентов query_bench): задания выполняются в порядке
+ * поступления, вызывающий поток всегда работает над своим.
+ */
+class ThreadPool {
+public:
+    /**
+     * @param threads число фоновых потоков (0 - задания выполняет
+     *        только вызывающий поток)
+     */
+    explicit ThreadPool(size_t threads);
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    size_t size() const { return workers_.size(); }
+
+    void parallel_for(size_t count, const std::function<void(size_t)>& fn);
+
+    /**
+     * Число потоков по умолчанию: по числу ядер
+     */
+    static size_t default_threads();
+
+private:
+    struct Job {
+        const std::function<void(size_t)>* fn;
+        size_t count;
+
+        // Часть каждого участника: [начало, конец) в одном слове, чтобы
+        // владелец (с начала) и перехватчик (с конца) менялись одним CAS.
+        // Участник 0 - вызывающий поток, i + 1 - фоновый поток i.
+        std::unique_ptr<std::atomic<uint64_t>[]> ranges;
+        size_t participants;
+
+        size_t done;     // завершено вызовов (под mutex_)
+        size_t helpers;  // фоновых потоков, работающих над заданием (под mutex_)
+    };
+
+    void worker_loop(size_t worker);
+
+    /**
+     * Выполнение своей части и перехват чужих, пока работа не кончится;
+     * возвращает число выполненных вызовов
+     */
+    static size_t run(Job& job, size_t participant);
+
+    /**
+     * Перехват половины самой большой чужой части в свою (пустую)
+     */
+    static bool steal(Job& job, size_t participant);
+
+    static bool has_work(const Job& job);
+
+    Vector<std::thread> workers_;
+    std::deque<Job*> queue_;
+    std::mutex mutex_;
+    std::condition_variable work_available_;
+    std::condition_variable job_finished_;
+    bool stop_;
+};
+
+#endif // THREAD_POOL_H
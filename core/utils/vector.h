@@ -3,6 +3,7 @@
 
 #include <cstdlib>
 #include <cstring>
+#include <utility>
 
 /**
  * Собственная реализация динамического массива (аналог std::vector)
@@ -23,7 +24,7 @@ private:
         T* new_data = new T[new_capacity];
         
         for (size_t i = 0; i < size_; ++i) {
-            new_data[i] = data_[i];
+            new_data[i] = std::move(data_[i]);
         }
         
         delete[] data_;
@@ -46,6 +47,26 @@ public:
         }
     }
     
+    // Перемещение (нужно для Vector<Vector<T>>, чтобы не копировать вложенные массивы)
+    Vector(Vector&& other) : data_(other.data_), size_(other.size_), capacity_(other.capacity_) {
+        other.data_ = nullptr;
+        other.size_ = 0;
+        other.capacity_ = 0;
+    }
+    
+    Vector& operator=(Vector&& other) {
+        if (this != &other) {
+            delete[] data_;
+            data_ = other.data_;
+            size_ = other.size_;
+            capacity_ = other.capacity_;
+            other.data_ = nullptr;
+            other.size_ = 0;
+            other.capacity_ = 0;
+        }
+        return *this;
+    }
+    
     Vector& operator=(const Vector& other) {
         if (this != &other) {
             delete[] data_;
@@ -68,6 +89,13 @@ public:
         data_[size_++] = value;
     }
     
+    void push_back(T&& value) {
+        if (size_ >= capacity_) {
+            expand();
+        }
+        data_[size_++] = std::move(value);
+    }
+    
     void pop_back() {
         if (size_ > 0) {
             --size_;
@@ -95,6 +123,10 @@ public:
         return size_;
     }
     
+    size_t capacity() const {
+        return capacity_;
+    }
+    
     bool empty() const {
         return size_ == 0;
     }
@@ -107,7 +139,7 @@ public:
         if (new_capacity > capacity_) {
             T* new_data = new T[new_capacity];
             for (size_t i = 0; i < size_; ++i) {
-                new_data[i] = data_[i];
+                new_data[i] = std::move(data_[i]);
             }
             delete[] data_;
             data_ = new_data;
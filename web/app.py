@@ -11,6 +11,7 @@ import subprocess
 import json
 from pathlib import Path
 from flask import Flask, request, render_template, jsonify
+from markupsafe import Markup
 
 app = Flask(__name__)
 
@@ -21,15 +22,28 @@ CLI_BINARY = os.environ.get('CLI_BINARY', '../core/build/search_cli')
 RESULTS_PER_PAGE = 20
 
 
-def search_documents(query: str) -> dict:
+def find_corpus():
+    """Директория или пакет корпуса (None, если не найден)"""
+    corpus_path = Path(CORPUS_DIR)
+    if not corpus_path.exists():
+        corpus_path = Path(__file__).parent.parent / 'corpus'
+    return corpus_path if corpus_path.exists() else None
+
+
+def search_documents(query: str, offset: int = 0, limit: int = RESULTS_PER_PAGE) -> dict:
     """
     Выполнение поиска через CLI
     
+    Сниппеты с подсветкой для страницы [offset, offset + limit)
+    строит CLI за тот же вызов.
+    
     Args:
         query: поисковый запрос
+        offset: первый результат страницы
+        limit: результатов на странице
         
     Returns:
-        словарь с результатами поиска
+        словарь с результатами поиска и сниппетами страницы
     """
     if not query or not query.strip():
         return {
@@ -65,9 +79,18 @@ def search_documents(query: str) -> dict:
                 'doc_ids': []
             }
     
+    command = [str(cli_path), '--json', '--snippets',
+               '--offset', str(offset), '--limit', str(limit)]
+    # Хранилище документов рядом с индексом (build_index) CLI находит сам,
+    # корпус нужен только для индексов без него
+    corpus_path = find_corpus()
+    if corpus_path is not None and not Path(str(index_path) + '.docs').exists():
+        command += ['--corpus', str(corpus_path)]
+    command += [str(index_path), query]
+    
     try:
         result = subprocess.run(
-            [str(cli_path), str(index_path), query],
+            command,
             capture_output=True,
             text=True,
             encoding='utf-8',
@@ -82,53 +105,23 @@ def search_documents(query: str) -> dict:
                 'doc_ids': []
             }
         
-        # Парсинг вывода CLI
-        output = result.stdout
-        doc_ids = []
-        
-        lines = output.split('\n')
-        in_results = False
-        
-        for line in lines:
-            line = line.strip()
-            
-            if 'Найдено документов:' in line:
-                # Извлечь количество
-                try:
-                    count_str = line.split(':')[1].strip()
-                    count = int(count_str)
-                except:
-                    count = 0
-            
-            if 'Первые' in line and 'результатов:' in line:
-                in_results = True
-                continue
-            
-            if in_results and line:
-                # Разделить по запятым
-                parts = line.replace('...', '').split(',')
-                for part in parts:
-                    part = part.strip()
-                    if part and part.isdigit():
-                        doc_ids.append(int(part))
-                # Если есть многоточие, значит показаны не все
-                if '...' in line:
-                    break
-        
-        # Если не нашли через парсинг, попробуем другой способ
-        if not doc_ids:
-            for line in lines:
-                # Ищем строки с ID документами
-                parts = line.split(',')
-                for part in parts:
-                    part = part.strip()
-                    if part.isdigit() and len(part) <= 6:  # ID документов обычно небольшие
-                        doc_ids.append(int(part))
+        # Ответ CLI - одна строка JSON (сообщения загрузки - в stderr)
+        lines = [line for line in result.stdout.split('\n') if line.strip()]
+        if not lines:
+            return {
+                'error': 'Пустой ответ поиска',
+                'message': result.stderr,
+                'count': 0,
+                'doc_ids': []
+            }
+        response = json.loads(lines[-1])
         
         return {
             'query': query,
-            'count': len(doc_ids),
-            'doc_ids': doc_ids
+            'count': response.get('count', 0),
+            'doc_ids': response.get('doc_ids', []),
+            'offset': response.get('offset', offset),
+            'snippets': response.get('snippets', [])
         }
         
     except subprocess.TimeoutExpired:
@@ -156,9 +149,7 @@ def get_document_info(doc_id: int) -> dict:
     Returns:
         словарь с информацией о документе
     """
-    corpus_path = Path(CORPUS_DIR)
-    if not corpus_path.exists():
-        corpus_path = Path(__file__).parent.parent / 'corpus'
+    corpus_path = find_corpus() or Path(CORPUS_DIR)
     
     # Поиск файла по ID
     pattern = f"doc_{doc_id:05d}.txt"
@@ -222,36 +213,6 @@ def get_document_info(doc_id: int) -> dict:
         }
 
 
-def highlight_terms(text: str, query: str) -> str:
-    """
-    Подсветка найденных терминов в тексте
-    
-    Args:
-        text: текст для подсветки
-        query: поисковый запрос
-        
-    Returns:
-        текст с HTML подсветкой
-    """
-    if not query or not text:
-        return text
-    
-    # Разбить запрос на слова (игнорируя операторы)
-    import re
-    words = re.findall(r'\b\w+\b', query.lower())
-    
-    highlighted = text
-    for word in words:
-        if len(word) > 2:  # Игнорировать слишком короткие слова
-            pattern = re.compile(re.escape(word), re.IGNORECASE)
-            highlighted = pattern.sub(
-                lambda m: f'<mark>{m.group()}</mark>',
-                highlighted
-            )
-    
-    return highlighted
-
-
 @app.route('/')
 def index():
     """Главная страница с формой поиска"""
@@ -271,29 +232,29 @@ def search():
     if not query:
         return render_template('index.html', error='Введите поисковый запрос')
     
-    # Выполнить поиск
-    results = search_documents(query)
+    # Выполнить поиск: результаты и сниппеты текущей страницы за один вызов
+    page = max(page, 1)
+    results = search_documents(query, (page - 1) * RESULTS_PER_PAGE, RESULTS_PER_PAGE)
     
     if 'error' in results and results.get('count', 0) == 0:
         return render_template('index.html', error=results.get('error', 'Ошибка поиска'), query=query)
     
-    # Получить информацию о документах с пагинацией
-    all_doc_ids = results.get('doc_ids', [])
-    total_results = len(all_doc_ids)
-    
-    # Пагинация
-    start_idx = (page - 1) * RESULTS_PER_PAGE
-    end_idx = start_idx + RESULTS_PER_PAGE
-    page_doc_ids = all_doc_ids[start_idx:end_idx]
+    total_results = results.get('count', 0)
     
-    # Получить информацию о документах на текущей странице
+    # Сниппеты уже экранированы для HTML и содержат <mark>
     documents = []
-    for doc_id in page_doc_ids:
-        doc_info = get_document_info(doc_id)
-        if 'error' not in doc_info:
-            # Подсветить термины в превью
-            doc_info['preview'] = highlight_terms(doc_info.get('preview', ''), query)
-        documents.append(doc_info)
+    for snippet in results.get('snippets', []):
+        if not snippet.get('found'):
+            documents.append({'id': snippet['id'], 'title': f"Документ {snippet['id']}",
+                              'error': 'Документ не найден'})
+            continue
+        documents.append({
+            'id': snippet['id'],
+            'title': Markup(snippet['title'] or f"Документ {snippet['id']}"),
+            'url': snippet['url'],
+            'word_count': snippet['word_count'],
+            'preview': snippet['snippet']
+        })
     
     # Вычислить количество страниц
     total_pages = (total_results + RESULTS_PER_PAGE - 1) // RESULTS_PER_PAGE if total_results > 0 else 1